@@ -1,16 +1,31 @@
 #pragma once
 
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+
 #include <mc_filter/LowPass.h>
 #include <mc_rtc/gui/StateBuilder.h>
 #include <mc_rtc/log/Logger.h>
 
 #include <MultiContactController/CommandTypes.h>
+#include <MultiContactController/ContactSchedule.h>
+#include <MultiContactController/LimbManager.h>
 #include <MultiContactController/LimbTypes.h>
+#include <MultiContactController/WrenchDistributionCache.h>
 
 namespace mc_rbdyn
 {
 class Robot;
-}
+struct RobotFrame;
+} // namespace mc_rbdyn
 
 namespace ForceColl
 {
@@ -40,11 +55,48 @@ public:
     //! Nominal centroidal pose
     sva::PTransformd nominalCentroidalPose = sva::PTransformd(Eigen::Vector3d(0.0, 0.0, 1.0));
 
-    //! Base frame of nominal centroidal pose ("LimbAveragePose" or "World")
-    std::string nominalCentroidalPoseBaseFrame = "LimbAveragePose";
+    /** \brief Base frame of nominal centroidal pose. */
+    enum class NominalCentroidalPoseBaseFrame
+    {
+      //! Weighted average pose of the limbs in contact
+      LimbAveragePose = 0,
+
+      //! World frame
+      World
+    };
+
+    static inline const std::unordered_map<std::string, NominalCentroidalPoseBaseFrame>
+        strToNominalCentroidalPoseBaseFrame = {{"LimbAveragePose", NominalCentroidalPoseBaseFrame::LimbAveragePose},
+                                               {"World", NominalCentroidalPoseBaseFrame::World}};
+
+    /** \brief Policy for determining the reference CoM Z position. */
+    enum class RefComZPolicy
+    {
+      //! Z position of the weighted average pose of the limbs
+      Average = 0,
+
+      //! Zero (i.e., the Z position of the nominal centroidal pose)
+      Constant,
 
-    //! Policy for determining the reference CoM Z position ("Average", "Constant", "Min", or "Max")
-    std::string refComZPolicy = "Average";
+      //! Minimum Z position of the limbs
+      Min,
+
+      //! Maximum Z position of the limbs
+      Max
+    };
+
+    static inline const std::unordered_map<std::string, RefComZPolicy> strToRefComZPolicy = {
+        {"Average", RefComZPolicy::Average},
+        {"Constant", RefComZPolicy::Constant},
+        {"Min", RefComZPolicy::Min},
+        {"Max", RefComZPolicy::Max}};
+
+    //! Base frame of nominal centroidal pose ("LimbAveragePose" or "World" in the configuration)
+    NominalCentroidalPoseBaseFrame nominalCentroidalPoseBaseFrame = NominalCentroidalPoseBaseFrame::LimbAveragePose;
+
+    //! Policy for determining the reference CoM Z position ("Average", "Constant", "Min", or "Max" in the
+    //! configuration)
+    RefComZPolicy refComZPolicy = RefComZPolicy::Average;
 
     //! Limb weight list to calculate reference data
     std::unordered_map<Limb, double> limbWeightListForRefData = {{Limb("LeftFoot"), 1.0}, {Limb("RightFoot"), 1.0}};
@@ -67,6 +119,20 @@ public:
     //! Whether to enable centroidal feedback
     bool enableCentroidalFeedback = true;
 
+    //! Whether to solve MPC asynchronously in a worker thread
+    bool enableAsyncMpc = false;
+
+    //! Whether to speculatively solve MPC in another worker thread for the contact schedule in which the limbs about
+    //! to touch down touch down now (requires enableAsyncMpc)
+    bool enableSpeculativeMpc = false;
+
+    //! Period of solving MPC [control cycles] (the MPC result is interpolated between solves)
+    int mpcPeriod = 1;
+
+    //! Maximum number of invalidated elements of the reference data buffer recalculated per control cycle (all
+    //! invalidated elements are recalculated at once if zero or negative)
+    int refDataRecalcNumPerCycle = 50;
+
     //! Whether to use target limb pose for anchor frame of control robot
     bool useTargetPoseForControlRobotAnchorFrame = true;
 
@@ -79,6 +145,9 @@ public:
     //! Configuration for wrench distribution
     mc_rtc::Configuration wrenchDistConfig;
 
+    //! Maximum number of wrench distributions cached for recurring contact sets (caching is disabled if zero)
+    int wrenchDistCacheSize = 8;
+
     /** \brief Load mc_rtc configuration. */
     virtual void load(const mc_rtc::Configuration & mcRtcConfig);
 
@@ -182,6 +251,168 @@ public:
     virtual void removeFromLogger(mc_rtc::Logger & logger);
   };
 
+  /** \brief Degradation of MPC to reduce its computation time (e.g., when control cycles overrun).
+
+      Each parameter changes the corresponding configuration only in the direction that reduces the computation time,
+     and does not change it if not positive.
+   */
+  struct MpcDegradation
+  {
+    //! Maximum number of DDP iterations (used only by DDP-based MPC)
+    int ddpMaxIter = 0;
+
+    //! Horizon dt [sec]
+    double horizonDt = 0;
+
+    //! Horizon duration [sec]
+    double horizonDuration = 0;
+
+    //! Whether to skip solving MPC and keep following the previous plan
+    bool reusePreviousPlan = false;
+
+    /** \brief Load mc_rtc configuration. */
+    void load(const mc_rtc::Configuration & mcRtcConfig);
+
+    /** \brief Merge other degradation by taking the stronger degradation of each parameter.
+        \param other other degradation
+     */
+    void merge(const MpcDegradation & other);
+
+    /** \brief Get description (e.g., "ddpMaxIter: 1, horizonDt: 0.1"). */
+    std::string description() const;
+
+    /** \brief Degrade maximum number of DDP iterations.
+        \param nominal nominal value
+     */
+    inline int degradeDdpMaxIter(int nominal) const noexcept
+    {
+      return ddpMaxIter > 0 ? std::min(ddpMaxIter, nominal) : nominal;
+    }
+
+    /** \brief Degrade horizon dt.
+        \param nominal nominal value
+     */
+    inline double degradeHorizonDt(double nominal) const noexcept
+    {
+      return horizonDt > 0 ? std::max(horizonDt, nominal) : nominal;
+    }
+
+    /** \brief Degrade horizon duration.
+        \param nominal nominal value
+     */
+    inline double degradeHorizonDuration(double nominal) const noexcept
+    {
+      return horizonDuration > 0 ? std::min(horizonDuration, nominal) : nominal;
+    }
+
+    /** \brief Get whether the horizon is the same as that of other degradation.
+        \param other other degradation
+     */
+    inline bool hasSameHorizon(const MpcDegradation & other) const noexcept
+    {
+      return horizonDt == other.horizonDt && horizonDuration == other.horizonDuration;
+    }
+  };
+
+  /** \brief MPC data.
+
+      All data read and written by MPC. The input is captured from the managers on the control thread, so MPC can be
+     solved without accessing the managers (e.g., in a worker thread).
+   */
+  struct MpcData
+  {
+    //! Time at the start of MPC [sec]
+    double t = 0;
+
+    //! Horizon dt [sec]
+    double horizonDt = 0;
+
+    //! Control data (input: mpcCentroidal*, output: plannedCentroidal(Accel|Momentum|Wrench))
+    ControlData controlData;
+
+    //! Reference data at the start of MPC
+    RefData refData;
+
+    //! Contact schedule from the start of MPC (the segments are shared with the schedule of LimbManagerSet)
+    ContactSchedule contactSchedule;
+
+    //! Reference data at each horizon node
+    std::vector<RefData> refDataSeq;
+
+    //! Computation duration of MPC solver [ms]
+    double computationDuration = 0;
+
+    //! Number of iterations of MPC solver
+    int iter = 0;
+
+    //! Termination reason of MPC solver iterations ("Solver", "MaxIter", "TimeBudget", or "Converged")
+    std::string terminationReason = "Solver";
+
+    //! Planned centroidal wrench at each horizon node (empty if not provided by MPC)
+    std::vector<sva::ForceVecd> plannedWrenchSeq;
+
+    //! Planned centroidal momentum at each horizon node (empty if not provided by MPC)
+    std::vector<sva::ForceVecd> plannedMomentumSeq;
+
+    //! Planned state of MPC at each horizon node (empty if not provided by MPC)
+    std::vector<Eigen::VectorXd> plannedStateSeq;
+
+    //! Planned input of MPC at each horizon node (empty if not provided by MPC)
+    std::vector<Eigen::VectorXd> plannedInputSeq;
+
+    //! Feedback gain of MPC input with respect to state at each horizon node (empty if not provided by MPC)
+    std::vector<Eigen::MatrixXd> feedbackGainSeq;
+
+    //! Whether MPC needs to provide the feedback gain (latched from the configuration at the start of MPC, so that
+    //! MPC does not read the configuration modified by the control thread)
+    bool requireFeedbackGain = false;
+
+    //! Whether MPC is solved speculatively for the touch-down contact schedule (with the speculative solver instance)
+    bool speculative = false;
+
+    //! Degradation of MPC at the start of MPC
+    MpcDegradation degradation;
+
+    /** \brief Get the index of the horizon node closest to the specified time.
+        \param _t time
+     */
+    int nodeIdx(double _t) const;
+  };
+
+  /** \brief Worker solving MPC in a separate thread. */
+  struct MpcWorker
+  {
+    //! Thread
+    std::thread thread;
+
+    //! Mutex for the variables shared with the thread
+    std::mutex mutex;
+
+    //! Condition variable to notify MPC request and result
+    std::condition_variable cond;
+
+    //! MPC data requested to the thread (written by control thread only while requested is false)
+    MpcData requestData;
+
+    //! MPC data solved in the thread (accessed only from the thread)
+    MpcData threadData;
+
+    //! MPC data of the latest result of the thread
+    MpcData resultData;
+
+    //! Whether MPC is requested to the thread and not yet solved
+    bool requested = false;
+
+    //! Whether resultData is updated and not yet received
+    bool resultUpdated = false;
+
+    //! Whether to stop the thread
+    bool stopRequested = false;
+
+    //! Exception thrown in the thread
+    std::exception_ptr exception = nullptr;
+  };
+
 public:
   /** \brief Constructor.
       \param ctlPtr pointer to controller
@@ -189,6 +420,14 @@ public:
    */
   CentroidalManager(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
 
+  /** \brief Destructor.
+
+      The derived class must stop the MPC worker threads (i.e., call stopMpcWorkers) in its destructor, because the
+     members of the derived class accessed by runMpc are destroyed before this destructor is called. Stopping here is
+     only a fallback.
+   */
+  virtual ~CentroidalManager();
+
   /** \brief Reset.
       \param constraintSetConfig mc_rtc configuration that has nominalCentroidalPose
 
@@ -211,10 +450,24 @@ public:
 
   /** \brief Update.
 
-      This method should be called once every control cycle.
+      This method should be called once every control cycle. This is equivalent to calling updateActualState and then
+     updateControl.
    */
   virtual void update();
 
+  /** \brief Update the actual centroidal state (i.e., pose, velocity, momentum, and wrench) from the real robot.
+
+      This reads only the real robot and the measured wrenches of the limb tasks, so it can be run concurrently with
+     the updates of LimbManagerSet and PostureManager.
+   */
+  void updateActualState();
+
+  /** \brief Update the reference and control data (i.e., MPC, centroidal feedback, and wrench distribution).
+
+      This must be called after updateActualState and LimbManagerSet::update in each control cycle.
+   */
+  void updateControl();
+
   /** \brief Stop.
 
       This method should be called once when stopping the controller.
@@ -224,6 +477,32 @@ public:
   /** \brief Const accessor to the configuration. */
   virtual const Configuration & config() const = 0;
 
+  /** \brief Set degradation of MPC.
+      \param mpcDegradation degradation of MPC
+
+      This is applied from the next MPC. If the horizon is changed, runMpc switches to the solver instance built for
+     the horizon at reset, and the previous solution is used for the warm start of the switched solver. After reset,
+     the horizon must be that of the degradation passed to setMpcDegradationCandidates or set at reset.
+   */
+  void setMpcDegradation(const MpcDegradation & mpcDegradation);
+
+  /** \brief Set the candidates of degradation of MPC.
+      \param mpcDegradationCandidates degradations of MPC that may be set by setMpcDegradation
+
+      The solver instance for each distinct horizon of the candidates is built at reset, so that the solver is not
+     built while the control is running. This should be called before reset.
+   */
+  inline void setMpcDegradationCandidates(const std::vector<MpcDegradation> & mpcDegradationCandidates)
+  {
+    mpcDegradationCandidates_ = mpcDegradationCandidates;
+  }
+
+  /** \brief Const accessor to the degradation of MPC. */
+  inline const MpcDegradation & mpcDegradation() const noexcept
+  {
+    return mpcDegradation_;
+  }
+
   /** \brief Add entries to the GUI. */
   virtual void addToGUI(mc_rtc::gui::StateBuilder & gui);
 
@@ -268,22 +547,180 @@ protected:
   virtual Configuration & config() = 0;
 
   /** \brief Run MPC to plan centroidal trajectory.
+      \param mpcData MPC data
+
+      This method calculates mpcData.controlData.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
+     mpcData.controlData.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum). This method may be called from
+     the MPC worker thread, so it must not access anything other than mpcData and the MPC solver. If
+     mpcData.speculative is true, this method may be called in parallel with the normal MPC, so the separate solver
+     instance must be used.
+   */
+  virtual void runMpc(MpcData & mpcData) = 0;
+
+  /** \brief Get horizon dt of MPC [sec] (degraded by mpcDegradation_). */
+  virtual double mpcHorizonDt() const = 0;
+
+  /** \brief Get number of horizon steps of MPC (degraded by mpcDegradation_). */
+  virtual int mpcHorizonSteps() const = 0;
+
+  /** \brief Set the input of MPC from the current state of the managers.
+      \param mpcData MPC data
+   */
+  void setMpcData(MpcData & mpcData) const;
+
+  /** \brief Apply the result of MPC to controlData_.
+      \param mpcData MPC data
+
+      If MPC was solved at a past time (i.e., in asynchronous mode or between solves with mpcPeriod), the planned
+     centroidal wrench and momentum are interpolated at the current time from the planned trajectory over the horizon.
+     If the planned trajectory is not provided by MPC, the planned centroidal wrench is held and the planned centroidal
+     momentum is integrated with it. In either case, the planned centroidal acceleration is recalculated from them.
+   */
+  virtual void applyMpcData(const MpcData & mpcData);
+
+  /** \brief Calculate the planned centroidal angular acceleration.
+      \param controlData control data with the planned centroidal wrench and momentum and the centroidal state for MPC
+      \param refData reference data
+
+      This is called both from runMpc (with the data of MPC) and from applyMpcData (with the data of the current control
+     cycle), so it must not access anything other than the arguments and the constant members. By default, the planned
+     centroidal moment is divided by the diagonal of the robot inertia matrix.
+   */
+  virtual Eigen::Vector3d calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                            const RefData & refData) const;
+
+  /** \brief Get whether MPC needs to provide the feedback gain in MpcData.
+
+      This is called from setMpcData on the control thread, and the result is latched in MpcData::requireFeedbackGain.
+   */
+  inline virtual bool requireFeedbackGain() const
+  {
+    return false;
+  }
+
+  /** \brief Get whether MPC needs to provide the planned trajectory over the horizon in MpcData. */
+  inline bool requirePlannedTrajectory() const
+  {
+    return config().enableAsyncMpc || config().mpcPeriod > 1;
+  }
+
+  /** \brief Get the index of the solver instance used for MPC (0 for normal MPC, 1 for speculative MPC).
+      \param mpcData MPC data
 
-      This method calculates controlData_.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
-     controlData_.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
+      The data owned by each solver instance (e.g., warm start data) is indexed by this, so that the normal and
+     speculative MPC can be solved in parallel.
    */
-  virtual void runMpc() = 0;
+  static inline int solverIdx(const MpcData & mpcData) noexcept
+  {
+    return mpcData.speculative ? 1 : 0;
+  }
+
+  /** \brief Get the index of the horizon in solverHorizonList_.
+      \param mpcDegradation degradation of MPC that determines the horizon
+
+      The solver instances built for each horizon at reset are indexed by this.
+   */
+  size_t solverHorizonIdx(const MpcDegradation & mpcDegradation) const;
+
+  /** \brief Request MPC to the worker thread and receive the latest result into mpcData_.
+      \param requestMpc whether to request MPC if the worker thread is idle
+      \return whether MPC is requested
+
+      If config().enableSpeculativeMpc is true, the speculative MPC for the touch-down contact schedule is requested
+     together with the normal MPC, and its result is used instead when touch down is detected.
+   */
+  bool runMpcAsync(bool requestMpc);
+
+  /** \brief Replace mpcData_ with the result of the speculative MPC if the contact set has been switched by touch
+     down and the result of the speculative MPC is consistent with the switched contact set.
+      \return whether mpcData_ is replaced
+   */
+  bool adoptSpeculativeMpcData();
+
+  /** \brief Request MPC to the worker if it is idle.
+      \param worker MPC worker
+      \param setRequestData function to set the MPC data to request (MPC is not requested if it returns false)
+      \return whether MPC is requested
+   */
+  bool requestMpcToWorker(MpcWorker & worker, const std::function<bool(MpcData &)> & setRequestData);
+
+  /** \brief Receive the latest result of the worker.
+      \param worker MPC worker
+      \param mpcData MPC data to which the result is swapped
+      \param wait whether to wait for the result
+      \return whether the result is received
+   */
+  bool receiveMpcFromWorker(MpcWorker & worker, MpcData & mpcData, bool wait);
+
+  /** \brief Start the MPC worker threads. */
+  void startMpcWorkers();
+
+  /** \brief Stop the MPC worker threads. */
+  void stopMpcWorkers();
+
+  /** \brief Get the native handles of the running MPC worker threads (e.g., to set the scheduling policy). */
+  std::vector<pthread_t> mpcWorkerNativeHandles();
+
+  /** \brief Stop the MPC worker thread.
+      \param worker MPC worker
+   */
+  void stopMpcWorker(MpcWorker & worker);
+
+  /** \brief Loop of the MPC worker thread.
+      \param worker MPC worker
+   */
+  void mpcWorkerLoop(MpcWorker & worker);
+
+  /** \brief Cursors of the limb command timelines for the reference data at increasing times (indexed by limb ID). */
+  using RefDataCursor = std::vector<LimbManager::QueryCursor>;
 
   /** \brief Calculate reference data.
       \param t time
+      \param cursor cursors of the limb command timelines (the size must be Limb::idNum())
+
+      The reference data is calculated at increasing times (e.g., at the current time in each control cycle and at
+     each node over the MPC horizon), so passing the same cursor to the sequential calls makes the command queries
+     amortized O(1).
+   */
+  RefData calcRefData(double t, RefDataCursor & cursor) const;
+
+  /** \brief Update the buffer of reference data over the MPC horizon.
+
+      The buffer holds the reference data on the control time grid. In each control cycle, the buffer is shifted by
+     the elapsed control steps, and the newly exposed tail elements are calculated. The elements invalidated by the
+     change of the commands are marked as stale and recalculated from the front over several control cycles (up to
+     config().refDataRecalcNumPerCycle elements per cycle); setMpcData calculates the stale elements used by MPC
+     directly, so that MPC never uses the stale reference data.
+   */
+  void updateRefDataBuffer();
+
+  /** \brief Get the time of the element of the buffer of reference data.
+      \param tick control tick of the element
+   */
+  double calcRefDataBufferTime(long long tick) const;
+
+  /** \brief Get whether the element of the buffer of reference data is stale.
+      \param tick control tick of the element
+   */
+  inline bool isRefDataBufferStale(long long tick) const noexcept
+  {
+    return refDataBufferStaleStartTick_ <= tick && tick < refDataBufferStaleEndTick_;
+  }
+
+  /** \brief Invalidate the buffer of reference data from the specified time.
+      \param t time
    */
-  RefData calcRefData(double t) const;
+  inline void invalidateRefDataBuffer(double t) noexcept
+  {
+    refDataBufferInvalidTime_ = std::min(refDataBufferInvalidTime_, t);
+  }
 
   /** \brief Calculate limb average pose for reference data.
       \param t time
       \param recursive whether it is called recursively
+      \param cursor cursors of the limb command timelines
    */
-  sva::PTransformd calcLimbAveragePoseForRefData(double t, bool recursive) const;
+  sva::PTransformd calcLimbAveragePoseForRefData(double t, bool recursive, RefDataCursor & cursor) const;
 
   /** \brief Get nominal centroidal pose.
       \param t time
@@ -323,10 +760,99 @@ protected:
   //! Wrench distribution
   std::shared_ptr<ForceColl::WrenchDistribution> wrenchDist_;
 
-  //! Contact list
-  std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> contactList_;
+  //! Cache of wrench distribution
+  WrenchDistributionCache wrenchDistCache_;
+
+  //! Limb vector of wrench distribution (the i-th element is the limb of the i-th contact of wrenchDist_)
+  std::vector<Limb> wrenchDistLimbVec_;
+
+  //! Contact constraint vector of wrench distribution
+  std::vector<std::shared_ptr<ContactConstraint>> wrenchDistContactVec_;
+
+  //! Contact schedule segment at the current time
+  std::shared_ptr<const ContactSchedule::Segment> contactSegment_;
+
+  //! Frame of each limb in the control robot indexed by limb ID (nullptr for the IDs without limb task)
+  std::vector<const mc_rbdyn::RobotFrame *> controlLimbFrameVec_;
+
+  //! Frame of each limb in the real robot indexed by limb ID (nullptr for the IDs without limb task)
+  std::vector<const mc_rbdyn::RobotFrame *> realLimbFrameVec_;
+
+  //! Index of the body of the base orientation task in the real robot
+  unsigned int realBaseOriBodyIdx_ = 0;
+
+  //! Target wrench of each limb indexed by limb ID
+  std::vector<sva::ForceVecd> limbTargetWrenchVec_;
 
   //! Nominal centroidal pose list
   std::map<double, sva::PTransformd> nominalCentroidalPoseList_;
+
+  //! Ring buffer of reference data on the control time grid over the MPC horizon
+  std::vector<RefData> refDataBuffer_;
+
+  //! Cursors for the reference data at the current time
+  RefDataCursor refDataCursor_;
+
+  //! Cursors for the newly exposed tail elements of the buffer of reference data
+  RefDataCursor refDataBufferCursor_;
+
+  //! Index of the first valid element in refDataBuffer_
+  int refDataBufferHead_ = 0;
+
+  //! Number of calculated elements in refDataBuffer_ (including the stale elements)
+  int refDataBufferValidNum_ = 0;
+
+  //! Control tick of the first valid element in refDataBuffer_
+  long long refDataBufferStartTick_ = 0;
+
+  //! Number of control ticks per MPC horizon dt (zero if MPC horizon dt is not a multiple of control dt)
+  int refDataBufferTicksPerNode_ = 0;
+
+  //! Earliest time from which refDataBuffer_ needs to be recalculated (infinity if refDataBuffer_ is valid)
+  double refDataBufferInvalidTime_ = std::numeric_limits<double>::infinity();
+
+  //! Control tick of the first stale element in refDataBuffer_
+  long long refDataBufferStaleStartTick_ = 0;
+
+  //! Control tick next to the last stale element in refDataBuffer_ (there is no stale element if not larger than
+  //! refDataBufferStaleStartTick_)
+  long long refDataBufferStaleEndTick_ = 0;
+
+  //! MPC data applied in the current control cycle
+  MpcData mpcData_;
+
+  //! Number of control cycles elapsed since MPC was last solved or requested
+  int mpcElapsedCycles_ = 0;
+
+  //! Whether the planned centroidal wrench is corrected with the actual state by the feedback policy of MPC in the
+  //! current control cycle (the centroidal feedback is skipped not to apply the feedback twice)
+  bool mpcFeedbackApplied_ = false;
+
+  //! Degradation of MPC
+  MpcDegradation mpcDegradation_;
+
+  //! Candidates of degradation of MPC
+  std::vector<MpcDegradation> mpcDegradationCandidates_;
+
+  //! Degradations of MPC with distinct horizons for which the solver instances are built (not changed after reset)
+  std::vector<MpcDegradation> solverHorizonList_;
+
+  //! MPC worker
+  MpcWorker mpcWorker_;
+
+  //! MPC worker for speculative MPC
+  MpcWorker speculativeMpcWorker_;
+
+  //! MPC data received from mpcWorker_ (swapped with mpcData_ if it is newer)
+  MpcData mpcReceivedData_;
+
+  //! Whether the result of mpcWorker_ has been received at least once
+  bool mpcResultReceived_ = false;
+
+  //! MPC data of the latest result of speculative MPC
+  MpcData speculativeMpcData_;
+
+  //! Whether speculativeMpcData_ has been received and not yet adopted
+  bool speculativeMpcDataValid_ = false;
 };
 } // namespace MCC
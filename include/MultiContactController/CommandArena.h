@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace MCC
+{
+/** \brief Arena of command objects released in bulk.
+
+    The command objects (i.e., swing, contact, and gripper commands and contact constraints) of one motion (e.g., a
+    sequence of step commands sent at once) are allocated from a monotonic buffer, together with their shared_ptr
+    control blocks. Deallocating an object does nothing, and the whole buffer is released at once when the last object
+    allocated from the arena is destructed, because each control block holds the arena through its allocator. This
+    replaces a heap allocation and deallocation per command with a few allocations of large blocks per motion.
+
+    Objects must be allocated from one thread at a time (e.g., the thread constructing the step commands), while they
+    can be used and destructed from any thread.
+ */
+class CommandArena
+{
+public:
+  /** \brief Allocator holding the arena.
+      \tparam T value type
+   */
+  template<class T>
+  struct Allocator
+  {
+    //! Value type
+    using value_type = T;
+
+    /** \brief Constructor.
+        \param _arena arena
+     */
+    Allocator(const std::shared_ptr<CommandArena> & _arena) noexcept : arena(_arena) {}
+
+    /** \brief Copy constructor from the allocator of another value type (required for rebinding). */
+    template<class U>
+    Allocator(const Allocator<U> & other) noexcept : arena(other.arena)
+    {
+    }
+
+    /** \brief Allocate memory from the arena.
+        \param n number of objects
+     */
+    inline T * allocate(size_t n)
+    {
+      return static_cast<T *>(arena->resource_.allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /** \brief Deallocate memory (do nothing because the memory is released in bulk). */
+    inline void deallocate(T *, size_t) noexcept {}
+
+    /** \brief Equal operator. */
+    template<class U>
+    inline bool operator==(const Allocator<U> & other) const noexcept
+    {
+      return arena == other.arena;
+    }
+
+    /** \brief Not-equal operator. */
+    template<class U>
+    inline bool operator!=(const Allocator<U> & other) const noexcept
+    {
+      return arena != other.arena;
+    }
+
+    //! Arena
+    std::shared_ptr<CommandArena> arena;
+  };
+
+public:
+  /** \brief Make a shared object allocated from the arena.
+      \tparam T object type
+      \param arena arena (the object is allocated from the heap if nullptr)
+      \param args arguments passed to the constructor of the object
+   */
+  template<class T, class... Args>
+  static std::shared_ptr<T> makeShared(const std::shared_ptr<CommandArena> & arena, Args &&... args)
+  {
+    if(!arena)
+    {
+      return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(Allocator<T>(arena), std::forward<Args>(args)...);
+  }
+
+public:
+  /** \brief Constructor.
+      \param initialSize size of the first block allocated from the heap [byte]
+   */
+  CommandArena(size_t initialSize = 4096) : resource_(initialSize) {}
+
+  // Non-copyable because the objects refer to the buffer
+  CommandArena(const CommandArena &) = delete;
+  CommandArena & operator=(const CommandArena &) = delete;
+
+protected:
+  //! Monotonic buffer resource
+  std::pmr::monotonic_buffer_resource resource_;
+};
+} // namespace MCC
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <mc_rtc/logging.h>
+
+namespace MCC
+{
+/** \brief Bounded lock-free multi-producer single-consumer queue of commands.
+
+    \tparam CommandType command type
+
+    The queue is a ring buffer whose slots have a sequence number indicating whether the slot is ready to be written
+    or read. Producers reserve a slot by incrementing the write position with compare-and-swap, and the consumer reads
+    the slots in order, so neither push nor pop takes a lock. Any number of threads (e.g., GUI callbacks and socket
+    threads) can push commands concurrently, while only one thread (i.e., the control thread) must pop them.
+
+    The capacity is fixed at construction and the slots are allocated only once, so pop does not allocate memory.
+    Since the command is moved into and out of the slot, the memory owned by the command is allocated by the producer.
+ */
+template<class CommandType>
+class CommandQueue
+{
+public:
+  /** \brief Constructor.
+      \param capacity maximum number of commands in the queue (rounded up to a power of two)
+   */
+  CommandQueue(size_t capacity)
+  {
+    if(capacity == 0)
+    {
+      mc_rtc::log::error_and_throw("[CommandQueue] Capacity must be positive.");
+    }
+    size_t size = 1;
+    while(size < capacity)
+    {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new Slot[size]);
+    for(size_t i = 0; i < size; i++)
+    {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Non-copyable because the queue is shared among threads
+  CommandQueue(const CommandQueue &) = delete;
+  CommandQueue & operator=(const CommandQueue &) = delete;
+
+  /** \brief Get the capacity. */
+  inline size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  /** \brief Push the command (thread-safe for multiple producers).
+      \param command command
+      \return whether the command is pushed (false if the queue is full)
+   */
+  bool push(CommandType && command)
+  {
+    size_t pos = writePos_.load(std::memory_order_relaxed);
+    Slot * slot;
+    while(true)
+    {
+      slot = &slots_[pos & mask_];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if(diff == 0)
+      {
+        // The slot is free; reserve it unless another producer has reserved it
+        if(writePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if(diff < 0)
+      {
+        // The slot has not been read by the consumer yet
+        return false;
+      }
+      else
+      {
+        pos = writePos_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->command = std::move(command);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** \brief Pop the command (must be called only from the single consumer).
+      \param command command to set
+      \return whether the command is popped (false if the queue is empty)
+   */
+  bool pop(CommandType & command)
+  {
+    Slot & slot = slots_[readPos_ & mask_];
+    if(slot.seq.load(std::memory_order_acquire) != readPos_ + 1)
+    {
+      return false;
+    }
+    command = std::move(slot.command);
+    slot.seq.store(readPos_ + mask_ + 1, std::memory_order_release);
+    readPos_++;
+    return true;
+  }
+
+protected:
+  /** \brief Slot of ring buffer. */
+  struct Slot
+  {
+    //! Sequence number (equal to the position if writable, and to the position plus one if readable)
+    std::atomic<size_t> seq;
+
+    //! Command
+    CommandType command;
+  };
+
+protected:
+  //! Slots
+  std::unique_ptr<Slot[]> slots_;
+
+  //! Mask to convert the position to the slot index
+  size_t mask_ = 0;
+
+  //! Write position shared by producers (separated from the read position to avoid false sharing)
+  alignas(64) std::atomic<size_t> writePos_{0};
+
+  //! Read position owned by the consumer
+  alignas(64) size_t readPos_ = 0;
+};
+} // namespace MCC
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <mc_rtc/logging.h>
+
+namespace MCC
+{
+/** \brief Timeline of commands keyed by integer control ticks.
+
+    \tparam CommandType command type
+
+    Commands are stored contiguously in ascending order of time, and each time is converted to the integer control
+    tick (i.e., the time divided by the tick duration, rounded to the nearest integer), so that the comparison of times
+    is exact even if the time is accumulated by floating-point additions. The interface follows std::map<double,
+    std::shared_ptr<CommandType>> (the element is a pair of time and command), so that the timeline can replace it.
+
+    Unlike std::map, two commands whose times are converted to the same tick (i.e., closer than half the tick duration)
+    cannot coexist, and adding such a command throws an exception instead of being silently ignored. Use
+    hasCommandAtTick to check it in advance.
+
+    The query is a binary search over the contiguous ticks and does not modify the timeline, so the const queries can
+    be called concurrently from multiple threads. Since the commands are queried mostly at monotonically increasing
+    times (e.g., at each node over the MPC horizon), the queries optionally take a cursor owned by the caller, which
+    keeps the index of the last query result. The query starting from the cursor at a time slightly after the previous
+    query is O(1).
+ */
+template<class CommandType>
+class CommandTimeline
+{
+public:
+  /** \brief Element type (pair of time and command). */
+  using value_type = std::pair<double, std::shared_ptr<CommandType>>;
+
+  /** \brief Const iterator. */
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  /** \brief Const reverse iterator. */
+  using const_reverse_iterator = typename std::vector<value_type>::const_reverse_iterator;
+
+  /** \brief Cursor of query.
+
+      The cursor may be used across the modifications of the timeline; the stale cursor only makes the next query fall
+      back to the binary search.
+   */
+  struct Cursor
+  {
+    //! Index of the result of the last query
+    size_t idx = 0;
+  };
+
+public:
+  /** \brief Constructor.
+      \param tickDuration duration of one control tick [sec]
+   */
+  explicit CommandTimeline(double tickDuration = 1e-3) : tickDuration_(tickDuration)
+  {
+    if(tickDuration_ <= 0)
+    {
+      mc_rtc::log::error_and_throw("[CommandTimeline] tickDuration must be positive: {}", tickDuration_);
+    }
+  }
+
+  /** \brief Convert time to control tick.
+      \param t time
+   */
+  inline long long timeToTick(double t) const
+  {
+    return std::llround(t / tickDuration_);
+  }
+
+  /** \brief Get duration of one control tick [sec]. */
+  inline double tickDuration() const noexcept
+  {
+    return tickDuration_;
+  }
+
+  /** \brief Get whether the timeline is empty. */
+  inline bool empty() const noexcept
+  {
+    return elements_.empty();
+  }
+
+  /** \brief Get number of commands. */
+  inline size_t size() const noexcept
+  {
+    return elements_.size();
+  }
+
+  /** \brief Clear commands. */
+  inline void clear() noexcept
+  {
+    elements_.clear();
+    ticks_.clear();
+  }
+
+  /** \brief Get iterator to the first command. */
+  inline const_iterator begin() const noexcept
+  {
+    return elements_.cbegin();
+  }
+
+  /** \brief Get iterator past the last command. */
+  inline const_iterator end() const noexcept
+  {
+    return elements_.cend();
+  }
+
+  /** \brief Get reverse iterator to the last command. */
+  inline const_reverse_iterator rbegin() const noexcept
+  {
+    return elements_.crbegin();
+  }
+
+  /** \brief Get reverse iterator before the first command. */
+  inline const_reverse_iterator rend() const noexcept
+  {
+    return elements_.crend();
+  }
+
+  /** \brief Get whether a command exists at the same tick as the specified time.
+      \param t time
+   */
+  inline bool hasCommandAtTick(double t) const
+  {
+    return std::binary_search(ticks_.begin(), ticks_.end(), timeToTick(t));
+  }
+
+  /** \brief Add a command.
+      \param t time
+      \param command command
+
+      Adding at the end of the timeline, which is the usual case, is amortized O(1). An exception is thrown if a
+      command already exists at the same tick (see hasCommandAtTick).
+   */
+  void emplace(double t, const std::shared_ptr<CommandType> & command)
+  {
+    long long tick = timeToTick(t);
+    auto tickIt = std::lower_bound(ticks_.begin(), ticks_.end(), tick);
+    auto idx = std::distance(ticks_.begin(), tickIt);
+    if(tickIt != ticks_.end() && *tickIt == tick)
+    {
+      mc_rtc::log::error_and_throw("[CommandTimeline] Command at {} is at the same tick ({}) as the existing command "
+                                   "at {}. The commands must be separated by at least the tick duration ({}).",
+                                   t, tick, elements_[idx].first, tickDuration_);
+    }
+    ticks_.insert(tickIt, tick);
+    elements_.insert(elements_.begin() + idx, value_type(t, command));
+  }
+
+  /** \brief Add commands.
+      \param first iterator to the first element (pair of time and command) to add
+      \param last iterator past the last element to add
+
+      The commands to add are merged into the timeline in O(size() + n log n) for n commands to add, instead of being
+      added one by one. An exception is thrown if two of the commands to add or a command to add and an existing command
+      are at the same tick (see hasCommandAtTick). In that case, none of the commands is added.
+   */
+  template<class InputIterator>
+  void insert(InputIterator first, InputIterator last)
+  {
+    // Sort the commands to add by tick
+    std::vector<std::pair<long long, value_type>> newElements;
+    for(auto it = first; it != last; it++)
+    {
+      newElements.emplace_back(timeToTick(it->first), value_type(it->first, it->second));
+    }
+    if(newElements.empty())
+    {
+      return;
+    }
+    if(!std::is_sorted(newElements.begin(), newElements.end(),
+                       [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; }))
+    {
+      std::stable_sort(newElements.begin(), newElements.end(),
+                       [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+    }
+
+    // Check the tick collision before modifying the timeline
+    size_t oldIdx = static_cast<size_t>(
+        std::distance(ticks_.begin(), std::lower_bound(ticks_.begin(), ticks_.end(), newElements.front().first)));
+    for(size_t newIdx = 0; newIdx < newElements.size(); newIdx++)
+    {
+      long long tick = newElements[newIdx].first;
+      while(oldIdx < ticks_.size() && ticks_[oldIdx] < tick)
+      {
+        oldIdx++;
+      }
+      bool collided = (newIdx > 0 && newElements[newIdx - 1].first == tick);
+      if(collided || (oldIdx < ticks_.size() && ticks_[oldIdx] == tick))
+      {
+        mc_rtc::log::error_and_throw("[CommandTimeline] Command at {} is at the same tick ({}) as the {} command at "
+                                     "{}. The commands must be separated by at least the tick duration ({}).",
+                                     newElements[newIdx].second.first, tick, collided ? "added" : "existing",
+                                     collided ? newElements[newIdx - 1].second.first : elements_[oldIdx].first,
+                                     tickDuration_);
+      }
+    }
+
+    // Merge from the back so that each element is moved only once
+    size_t oldNum = ticks_.size();
+    ticks_.resize(oldNum + newElements.size());
+    elements_.resize(oldNum + newElements.size());
+    size_t oldEnd = oldNum;
+    size_t newEnd = newElements.size();
+    for(size_t mergedIdx = ticks_.size(); newEnd > 0; mergedIdx--)
+    {
+      if(oldEnd > 0 && ticks_[oldEnd - 1] > newElements[newEnd - 1].first)
+      {
+        oldEnd--;
+        ticks_[mergedIdx - 1] = ticks_[oldEnd];
+        elements_[mergedIdx - 1] = std::move(elements_[oldEnd]);
+      }
+      else
+      {
+        newEnd--;
+        ticks_[mergedIdx - 1] = newElements[newEnd].first;
+        elements_[mergedIdx - 1] = std::move(newElements[newEnd].second);
+      }
+    }
+  }
+
+  /** \brief Remove a command.
+      \param it iterator to the command to remove
+   */
+  void erase(const_iterator it)
+  {
+    erase(it, std::next(it));
+  }
+
+  /** \brief Remove commands in the range.
+      \param first iterator to the first command to remove
+      \param last iterator past the last command to remove
+   */
+  void erase(const_iterator first, const_iterator last)
+  {
+    auto firstIdx = std::distance(begin(), first);
+    auto lastIdx = std::distance(begin(), last);
+    ticks_.erase(ticks_.begin() + firstIdx, ticks_.begin() + lastIdx);
+    elements_.erase(first, last);
+  }
+
+  /** \brief Get iterator to the first command later than the specified time.
+      \param t time
+   */
+  const_iterator upper_bound(double t) const
+  {
+    return begin() + std::distance(ticks_.begin(), std::upper_bound(ticks_.begin(), ticks_.end(), timeToTick(t)));
+  }
+
+  /** \brief Get iterator to the first command later than the specified time starting from the cursor.
+      \param t time
+      \param cursor cursor (updated to the result)
+
+      The neighborhood of the cursor is checked first, so the query at monotonically increasing times is amortized
+      O(1).
+   */
+  const_iterator upper_bound(double t, Cursor & cursor) const
+  {
+    cursor.idx = upperBoundIdx(timeToTick(t), cursor.idx);
+    return begin() + cursor.idx;
+  }
+
+  /** \brief Get iterators to the first commands later than each of the equally spaced times in one sweep.
+      \param startTime first time
+      \param interval interval of times (must not be negative)
+      \param num number of times
+      \param itList iterator list to set (the i-th element is upper_bound(startTime + i * interval))
+      \param cursor cursor (updated to the result of the last time)
+
+      The timeline is swept only once from the start time, so querying the whole MPC horizon is O(num + size()).
+   */
+  void upperBoundSeq(double startTime,
+                     double interval,
+                     int num,
+                     std::vector<const_iterator> & itList,
+                     Cursor & cursor) const
+  {
+    itList.resize(num);
+    size_t idx = upperBoundIdx(timeToTick(startTime), cursor.idx);
+    for(int i = 0; i < num; i++)
+    {
+      long long tick = timeToTick(startTime + i * interval);
+      while(idx < ticks_.size() && ticks_[idx] <= tick)
+      {
+        idx++;
+      }
+      itList[i] = begin() + idx;
+    }
+    cursor.idx = idx;
+  }
+
+protected:
+  /** \brief Get index of the first command later than the specified tick.
+      \param tick control tick
+      \param hintIdx index from which the neighborhood is checked first
+   */
+  size_t upperBoundIdx(long long tick, size_t hintIdx) const
+  {
+    size_t num = ticks_.size();
+    if(hintIdx <= num)
+    {
+      if((hintIdx == 0 || ticks_[hintIdx - 1] <= tick) && (hintIdx == num || tick < ticks_[hintIdx]))
+      {
+        return hintIdx;
+      }
+      if(hintIdx < num && ticks_[hintIdx] <= tick && (hintIdx + 1 == num || tick < ticks_[hintIdx + 1]))
+      {
+        return hintIdx + 1;
+      }
+    }
+
+    // Binary search otherwise
+    return static_cast<size_t>(std::distance(ticks_.begin(), std::upper_bound(ticks_.begin(), ticks_.end(), tick)));
+  }
+
+protected:
+  //! Duration of one control tick [sec]
+  double tickDuration_;
+
+  //! Elements (pairs of time and command) sorted by time
+  std::vector<value_type> elements_;
+
+  //! Control ticks of elements
+  std::vector<long long> ticks_;
+};
+} // namespace MCC
@@ -2,6 +2,8 @@
 
 #include <mc_rtc/Configuration.h>
 
+#include <MultiContactController/CommandArena.h>
+
 namespace ForceColl
 {
 class Contact;
@@ -185,6 +187,7 @@ struct StepCommand
 
   /** \brief Constructor.
       \param mcRtcConfig mc_rtc configuration
+      \param arena arena from which the command objects are allocated (the heap is used if nullptr)
 
       Two types of formats, simple description and full description, are available for \p mcRtcConfig.
 
@@ -232,7 +235,7 @@ struct StepCommand
             opening: 0.0
       @endcode
    */
-  StepCommand(const mc_rtc::Configuration & mcRtcConfig);
+  StepCommand(const mc_rtc::Configuration & mcRtcConfig, const std::shared_ptr<CommandArena> & arena = nullptr);
 
   /** \brief Set base time.
       \param baseTime base time
@@ -250,4 +253,127 @@ struct StepCommand
   //! Gripper command list
   std::map<double, std::shared_ptr<GripperCommand>> gripperCommandList;
 };
+
+/** \brief Builder of step command.
+
+    The step command is constructed directly from typed arguments without composing an intermediate mc_rtc
+    configuration. The configuration of the contact constraint is complemented in the same manner as the full
+    description format of StepCommand (i.e., "name", "verticesName", and "pose" entries are set automatically), and
+    the contact constraint is made by ContactConstraintPool. If the arena is set, the command objects are allocated
+    from it.
+
+    An example equivalent to the simple description format of StepCommand is as follows.
+    @code
+    StepCommand stepCommand = StepCommandBuilder("LeftFoot", pose).simple(SwingCommand::Type::Add, 2.0, 3.0,
+    constraintConfig).build();
+    @endcode
+ */
+class StepCommandBuilder
+{
+public:
+  /** \brief Constructor.
+      \param limbName limb name (used as the default name and vertices name of contact constraint)
+   */
+  StepCommandBuilder(const std::string & limbName) : limbName_(limbName) {}
+
+  /** \brief Constructor.
+      \param limbName limb name (used as the default name and vertices name of contact constraint)
+      \param pose limb pose (used for adding swing command and as the default pose of contact constraint)
+   */
+  StepCommandBuilder(const std::string & limbName, const sva::PTransformd & pose)
+  : limbName_(limbName), pose_(pose), hasPose_(true)
+  {
+  }
+
+  /** \brief Set arena from which the command objects are allocated.
+      \param arena arena (the heap is used if nullptr)
+
+      This must be called before adding the commands.
+   */
+  inline StepCommandBuilder & arena(const std::shared_ptr<CommandArena> & arena)
+  {
+    arena_ = arena;
+    return *this;
+  }
+
+  /** \brief Set swing command.
+      \param type type of swing command
+      \param startTime time to start swinging the limb
+      \param endTime time to end swinging the limb
+      \param swingConfig configuration for swing trajectory
+
+      The pose passed to the constructor is used for the adding swing command.
+   */
+  StepCommandBuilder & swing(const SwingCommand::Type & type,
+                             double startTime,
+                             double endTime,
+                             const mc_rtc::Configuration & swingConfig = {});
+
+  /** \brief Set swing command.
+      \param swingCommand swing command
+   */
+  StepCommandBuilder & swing(const std::shared_ptr<SwingCommand> & swingCommand);
+
+  /** \brief Add contact command.
+      \param time time
+      \param constraint contact constraint (nullptr for removing contact)
+   */
+  StepCommandBuilder & contact(double time, const std::shared_ptr<ContactConstraint> & constraint);
+
+  /** \brief Add contact command from the configuration of contact constraint.
+      \param time time
+      \param constraintConfig configuration of contact constraint (empty for removing contact)
+   */
+  StepCommandBuilder & contactFromConfig(double time, const mc_rtc::Configuration & constraintConfig);
+
+  /** \brief Add gripper command.
+      \param time time
+      \param name gripper name
+      \param config configuration for gripper command
+   */
+  StepCommandBuilder & gripper(double time, const std::string & name, const mc_rtc::Configuration & config);
+
+  /** \brief Set commands in the same manner as the simple description format of StepCommand.
+      \param type type of swing command
+      \param startTime time to start swinging the limb
+      \param endTime time to end swinging the limb
+      \param constraintConfig configuration of contact constraint added at the end time (only used for Type::Add)
+      \param swingConfig configuration for swing trajectory
+
+      The contact is removed at the start time, and is added at the end time for Type::Add.
+   */
+  StepCommandBuilder & simple(const SwingCommand::Type & type,
+                              double startTime,
+                              double endTime,
+                              const mc_rtc::Configuration & constraintConfig = {},
+                              const mc_rtc::Configuration & swingConfig = {});
+
+  /** \brief Build step command. */
+  inline StepCommand build() const
+  {
+    return StepCommand(swingCommand_, contactCommandList_, gripperCommandList_);
+  }
+
+protected:
+  //! Limb name
+  std::string limbName_;
+
+  //! Limb pose
+  sva::PTransformd pose_ = sva::PTransformd::Identity();
+
+  //! Whether the limb pose is specified
+  bool hasPose_ = false;
+
+  //! Arena from which the command objects are allocated
+  std::shared_ptr<CommandArena> arena_;
+
+  //! Swing command
+  std::shared_ptr<SwingCommand> swingCommand_;
+
+  //! Contact command list
+  std::map<double, std::shared_ptr<ContactCommand>> contactCommandList_;
+
+  //! Gripper command list
+  std::map<double, std::shared_ptr<GripperCommand>> gripperCommandList_;
+};
 } // namespace MCC
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+
+#include <MultiContactController/CommandArena.h>
+#include <MultiContactController/CommandTypes.h>
+
+namespace MCC
+{
+/** \brief Pool of interned contact constraint templates.
+
+    Constructing the contact constraint from the configuration looks up the local vertices and builds the friction
+    pyramid and the ridges of each vertex, although walking reuses the same constraint with a different pose thousands
+    of times. This pool interns a template constraint for each combination of type, name, vertices name, and friction
+    coefficient, and makes a new constraint by copying the template and only transforming its vertices and ridges to
+    the pose.
+
+    Since each constraint with vertices has its own pose, it is a separate copy. The empty constraint has no vertices,
+    so its template is shared. A constraint made by this pool may be referred to from other threads (e.g., by the
+    contact schedule passed to MPC), so it must not be updated in place; use copy to change its pose.
+
+    The pool is shared by all threads and is thread-safe.
+ */
+class ContactConstraintPool
+{
+public:
+  /** \brief Make a contact constraint from the configuration.
+      \param constraintConfig configuration of contact constraint
+      \param arena arena from which the constraint is allocated (the heap is used if nullptr)
+
+      The configuration with entries other than "type", "name", "verticesName", "fricCoeff", and "pose" is not
+      interned, and the constraint is constructed by ContactConstraint::makeSharedFromConfig.
+   */
+  static std::shared_ptr<ContactConstraint> make(const mc_rtc::Configuration & constraintConfig,
+                                                 const std::shared_ptr<CommandArena> & arena = nullptr);
+
+  /** \brief Make a copy of the contact constraint transformed to the pose.
+      \param constraint contact constraint to copy (surface or grasp contact)
+      \param pose pose
+
+      This is used to update the global vertices (e.g., by touch down) without modifying the constraint referred to
+      from other threads.
+   */
+  static std::shared_ptr<ContactConstraint> copy(const ContactConstraint & constraint, const sva::PTransformd & pose);
+
+  /** \brief Get the number of interned templates. */
+  static size_t size();
+
+  /** \brief Clear the interned templates (e.g., after the vertices map is reloaded). */
+  static void clear();
+};
+} // namespace MCC
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <MultiContactController/CommandTypes.h>
+#include <MultiContactController/LimbTypes.h>
+
+namespace MCC
+{
+/** \brief Contact schedule.
+
+    Contact schedule represents the piecewise-constant contact set over time as a sorted list of segments. The contact
+    vector passed to the MPC is precomputed for each segment, so querying the contact set at an arbitrary time only
+    requires a binary search over the segments.
+
+    The segments are immutable and shared by pointer, so copying the schedule (e.g., to pass it to the MPC thread) does
+    not copy the contact lists of the segments.
+ */
+class ContactSchedule
+{
+public:
+  /** \brief Segment in which the contact set is constant. */
+  struct Segment
+  {
+    /** \brief Constructor.
+        \param _startTime start time of segment
+        \param _contactList contact constraint list of segment
+     */
+    Segment(double _startTime, const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & _contactList);
+
+    //! Start time of segment [sec] (the segment lasts until the start time of the next segment)
+    double startTime;
+
+    //! Contact constraint list
+    std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> contactList;
+
+    //! Contact constraint vector
+    std::vector<std::shared_ptr<ContactConstraint>> contactVec;
+
+    //! Limb vector (the i-th element is the limb of contactVec[i])
+    std::vector<Limb> limbVec;
+  };
+
+public:
+  /** \brief Get whether two contact constraint lists are the same.
+      \param contactList1 contact constraint list
+      \param contactList2 contact constraint list
+
+      Two lists are the same if they have the same limbs and each limb has the same contact constraint object.
+   */
+  static bool isSameContactList(const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList1,
+                                const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList2);
+
+public:
+  /** \brief Clear segments. */
+  inline void clear()
+  {
+    segments_.clear();
+  }
+
+  /** \brief Append a segment.
+      \param startTime start time of segment
+      \param contactList contact constraint list of segment
+
+      The start time must be later than that of the last segment. If the contact list is the same as that of the last
+      segment, the last segment is extended instead of appending a new segment.
+   */
+  void appendSegment(double startTime,
+                     const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList);
+
+  /** \brief Get whether the schedule is empty. */
+  inline bool empty() const noexcept
+  {
+    return segments_.empty();
+  }
+
+  /** \brief Get segment list. */
+  inline const std::vector<std::shared_ptr<const Segment>> & segments() const noexcept
+  {
+    return segments_;
+  }
+
+  /** \brief Get the index of the segment containing the specified time.
+      \param t time
+   */
+  int segmentIdx(double t) const;
+
+  /** \brief Get the segment containing the specified time.
+      \param t time
+   */
+  inline const Segment & segment(double t) const
+  {
+    return *segments_[segmentIdx(t)];
+  }
+
+  /** \brief Get the pointer to the segment containing the specified time.
+      \param t time
+
+      The returned segment remains valid after the schedule is rebuilt as long as the pointer is held.
+   */
+  inline const std::shared_ptr<const Segment> & segmentPtr(double t) const
+  {
+    return segments_[segmentIdx(t)];
+  }
+
+protected:
+  //! Segment list sorted by start time
+  std::vector<std::shared_ptr<const Segment>> segments_;
+};
+} // namespace MCC
@@ -1,16 +1,21 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <future>
+#include <limits>
 #include <unordered_map>
+#include <vector>
 
 #include <mc_rtc/constants.h>
 #include <mc_rtc/gui/StateBuilder.h>
 #include <mc_rtc/log/Logger.h>
 #include <mc_tasks/ImpedanceGains.h>
 
+#include <MultiContactController/CommandTimeline.h>
 #include <MultiContactController/CommandTypes.h>
 #include <MultiContactController/LimbTypes.h>
 #include <MultiContactController/RobotUtils.h>
+#include <MultiContactController/SwingTraj.h>
 
 namespace mc_tasks
 {
@@ -23,7 +28,6 @@ struct FirstOrderImpedanceTask;
 namespace MCC
 {
 class MultiContactController;
-class SwingTraj;
 
 /** \brief Limb manager.
 
@@ -35,6 +39,37 @@ class LimbManager
   friend class LimbManagerSet;
 
 public:
+  /** \brief Last times of the appended commands, which are used to check the order and tick collision of new
+      commands. */
+  struct LastCommandTimes
+  {
+    //! End time of the last swing command
+    double swing = -1 * std::numeric_limits<double>::infinity();
+
+    //! Start time of the last swing command
+    double swingStart = -1 * std::numeric_limits<double>::infinity();
+
+    //! Time of the last contact command
+    double contact = -1 * std::numeric_limits<double>::infinity();
+
+    //! Time of the last gripper command
+    double gripper = -1 * std::numeric_limits<double>::infinity();
+  };
+
+  /** \brief Cursors of the command timelines for the queries at monotonically increasing times (e.g., over the MPC
+      horizon).
+
+      The cursor is owned by the caller, so the const queries with separate cursors can be called concurrently.
+   */
+  struct QueryCursor
+  {
+    //! Cursor of swing command timeline
+    CommandTimeline<SwingCommand>::Cursor swing;
+
+    //! Cursor of contact command timeline
+    CommandTimeline<ContactCommand>::Cursor contact;
+  };
+
   /** \brief Configuration. */
   struct Configuration
   {
@@ -44,11 +79,30 @@ public:
     //! Limb task gains
     TaskGain taskGain = TaskGain(sva::MotionVecd(Eigen::Vector6d::Constant(1000)));
 
-    //! Default swing trajectory type
+    //! Default swing trajectory type ("CubicSplineSimple" or "QuinticSimple")
     std::string defaultSwingTrajType = "CubicSplineSimple";
 
-    //! Policy for determining the start pose of the swing trajectory ("ControlRobot", "Target", or "Compliance")
-    std::string swingStartPolicy = "ControlRobot";
+    /** \brief Policy for determining the start pose of the swing trajectory. */
+    enum class SwingStartPolicy
+    {
+      //! Pose of the control robot (i.e., IK result)
+      ControlRobot = 0,
+
+      //! Target pose
+      Target,
+
+      //! Compliance pose, which is modified by impedance
+      Compliance
+    };
+
+    static inline const std::unordered_map<std::string, SwingStartPolicy> strToSwingStartPolicy = {
+        {"ControlRobot", SwingStartPolicy::ControlRobot},
+        {"Target", SwingStartPolicy::Target},
+        {"Compliance", SwingStartPolicy::Compliance}};
+
+    //! Policy for determining the start pose of the swing trajectory ("ControlRobot", "Target", or "Compliance" in
+    //! the configuration)
+    SwingStartPolicy swingStartPolicy = SwingStartPolicy::ControlRobot;
 
     //! Whether to overwrite landing pose so that the relative pose from swing start to end is retained
     bool overwriteLandingPose = false;
@@ -101,10 +155,32 @@ public:
 
   /** \brief Update.
 
-      This method should be called once every control cycle.
+      This method should be called once every control cycle. The result is the same as calling updateLocal and then
+     updateShared.
   */
   void update();
 
+  /** \brief Update the data local to the limb.
+
+      The actions on the resources shared among limbs (i.e., adding and removing the limb task to and from the QP
+     solver, sending gripper commands, and updating the GUI) are deferred to updateShared, so this method can be called
+     concurrently for different limbs.
+  */
+  void updateLocal();
+
+  /** \brief Execute the actions deferred by updateLocal.
+
+      This method should be called after updateLocal in the control thread, in the same order of limbs as the serial
+     update, so that the QP solver receives the same sequence of tasks.
+  */
+  void updateShared();
+
+  /** \brief Update impedance gains.
+
+      This method should be called once every control cycle after LimbManagerSet::contactSnapshot is updated.
+  */
+  void updateImpGains();
+
   /** \brief Stop.
 
       This method should be called once when stopping the controller.
@@ -135,20 +211,34 @@ public:
   */
   bool appendStepCommand(const StepCommand & stepCommand);
 
+  /** \brief Get the last times of the appended commands. */
+  LastCommandTimes lastCommandTimes() const;
+
+  /** \brief Check whether a step command can be appended after the commands with the specified last times.
+      \param stepCommand step command to check
+      \param lastCommandTimes last times of the preceding commands (updated to include stepCommand if it is valid)
+      \return whether stepCommand can be appended
+
+      Passing the result of lastCommandTimes() and calling this for each command in order validates a sequence of
+      step commands without appending them. The commands at the same control tick as an existing command or a
+      preceding command in the sequence are rejected here, because they cannot be inserted to CommandTimeline.
+  */
+  bool checkStepCommand(const StepCommand & stepCommand, LastCommandTimes & lastCommandTimes) const;
+
   /** \brief Access swing command list. */
-  inline const std::map<double, std::shared_ptr<SwingCommand>> & swingCommandList() const noexcept
+  inline const CommandTimeline<SwingCommand> & swingCommandList() const noexcept
   {
     return swingCommandList_;
   }
 
   /** \brief Access contact command list. */
-  inline const std::map<double, std::shared_ptr<ContactCommand>> & contactCommandList() const noexcept
+  inline const CommandTimeline<ContactCommand> & contactCommandList() const noexcept
   {
     return contactCommandList_;
   }
 
   /** \brief Access gripper command list. */
-  inline const std::map<double, std::shared_ptr<GripperCommand>> & gripperCommandList() const noexcept
+  inline const CommandTimeline<GripperCommand> & gripperCommandList() const noexcept
   {
     return gripperCommandList_;
   }
@@ -158,7 +248,19 @@ public:
 
       \note Returns the swing end pose even while the limb is swinging.
    */
-  sva::PTransformd getLimbPose(double t) const;
+  inline sva::PTransformd getLimbPose(double t) const
+  {
+    QueryCursor cursor;
+    return getLimbPose(t, cursor);
+  }
+
+  /** \brief Get target limb pose at the specified time starting from the cursor.
+      \param t time
+      \param cursor query cursor
+
+      See getLimbPose(double) for details.
+   */
+  sva::PTransformd getLimbPose(double t, QueryCursor & cursor) const;
 
   /** \brief Get contact command at the specified time.
       \param t time
@@ -167,7 +269,27 @@ public:
       If config_.enableWrenchDistForTouchDownLimb is true and touch down is detected during swing, return the next
      contact.
    */
-  std::shared_ptr<ContactCommand> getContactCommand(double t) const;
+  inline std::shared_ptr<ContactCommand> getContactCommand(double t) const
+  {
+    QueryCursor cursor;
+    return getContactCommand(t, cursor);
+  }
+
+  /** \brief Get contact command at the specified time starting from the cursor.
+      \param t time
+      \param cursor query cursor
+
+      See getContactCommand(double) for details.
+   */
+  std::shared_ptr<ContactCommand> getContactCommand(double t, QueryCursor & cursor) const;
+
+  /** \brief Get the contact command that becomes effective from the current time if touch down is detected now.
+
+      nullptr is returned if the limb is not about to touch down, i.e., the limb is not swinging to add contact, touch
+     down has already been detected, config_.enableWrenchDistForTouchDownLimb is false, or the remaining swing duration
+     exceeds config_.touchDownRemainingDuration.
+   */
+  std::shared_ptr<ContactCommand> getTouchDownContactCommand() const;
 
   /** \brief Get contact weight at the specified time.
       \param t time
@@ -175,7 +297,19 @@ public:
       Contact weight is 0 for non-contact, 1 for contact. It is linearly interpolated over the duration of
      config_.weightTransitDuration at the beginning and end of the contact.
    */
-  double getContactWeight(double t) const;
+  inline double getContactWeight(double t) const
+  {
+    QueryCursor cursor;
+    return getContactWeight(t, cursor);
+  }
+
+  /** \brief Get contact weight at the specified time starting from the cursor.
+      \param t time
+      \param cursor query cursor
+
+      See getContactWeight(double) for details.
+   */
+  double getContactWeight(double t, QueryCursor & cursor) const;
 
   /** \brief Get the closest contact times to the specified time.
       \param t time
@@ -183,6 +317,28 @@ public:
    */
   std::array<double, 2> getClosestContactTimes(double t) const;
 
+  /** \brief Get the earliest time from which the results of getLimbPose, getContactWeight, and
+     getClosestContactTimes may have been changed since the last call of clearCommandChangedTime.
+
+      Infinity is returned if they have not been changed.
+   */
+  inline double commandChangedTime() const noexcept
+  {
+    return commandChangedTime_;
+  }
+
+  /** \brief Accessor to the limb task. */
+  inline const std::shared_ptr<mc_tasks::force::FirstOrderImpedanceTask> & limbTask() const noexcept
+  {
+    return limbTask_;
+  }
+
+  /** \brief Clear the time returned by commandChangedTime. */
+  inline void clearCommandChangedTime() noexcept
+  {
+    commandChangedTime_ = std::numeric_limits<double>::infinity();
+  }
+
 protected:
   /** \brief Const accessor to the controller. */
   inline const MultiContactController & ctl() const
@@ -196,14 +352,99 @@ protected:
     return *ctlPtr_;
   }
 
-  /** \brief Accessor to the limb task. */
-  const std::shared_ptr<mc_tasks::force::FirstOrderImpedanceTask> & limbTask() const;
+  /** \brief Action on the resources shared among limbs. */
+  struct SharedAction
+  {
+    /** \brief Type of action. */
+    enum class Type
+    {
+      //! Add the limb task to the QP solver
+      AddTask = 0,
+
+      //! Remove the limb task from the QP solver
+      RemoveTask,
+
+      //! Send the gripper command
+      SendGripperCommand
+    };
+
+    //! Type of action
+    Type type;
+
+    //! Gripper command (only for Type::SendGripperCommand)
+    std::shared_ptr<GripperCommand> gripperCommand;
+  };
+
+  /** \brief Update the limb.
+      \param deferSharedActions whether to defer the actions on the shared resources to updateShared
+   */
+  void updateLimb(bool deferSharedActions);
+
+  /** \brief Execute or defer the action on the shared resources.
+      \param action action
+      \param defer whether to defer the action to updateShared
+   */
+  void requestSharedAction(SharedAction && action, bool defer);
+
+  /** \brief Execute the action on the shared resources.
+      \param action action
+   */
+  void executeSharedAction(const SharedAction & action);
+
+  /** \brief Update the visualization of the future contacts. */
+  void updateContactMarker();
 
   /** \brief Detect touch down.
       \return true if touch down is detected during swing
   */
   bool detectTouchDown() const;
 
+  /** \brief Notify that the commands have been changed.
+      \param t earliest time from which the commanded limb pose and contact may have been changed
+   */
+  inline void notifyCommandChanged(double t) noexcept
+  {
+    commandChangedTime_ = std::min(commandChangedTime_, t);
+  }
+
+  /** \brief Insert a step command to the command list without checking it.
+      \param stepCommand step command to insert (must be checked by checkStepCommand)
+  */
+  void insertStepCommand(const StepCommand & stepCommand);
+
+  /** \brief Start preparing the swing trajectory of the swing command in the background.
+      \param swingCommand swing command
+
+      The trajectory type is parsed and the default configuration is copied in the calling thread, and the rest of the
+      preparation (i.e., parsing the configuration and constructing the part independent of the start pose) is queued
+      to the task queue of LimbManagerSet so that it is not done in the control cycle at the swing start. The swing
+      start does not wait for the preparation; if it is not finished yet, the swing trajectory is constructed in the
+      control thread.
+   */
+  void prepareSwingTraj(const std::shared_ptr<SwingCommand> & swingCommand);
+
+  /** \brief Make the swing trajectory.
+      \param limb limb (used only for the error message)
+      \param swingTrajType type of swing trajectory
+      \param swingCommand swing command
+      \param isContact whether the limb is contacting
+      \param swingStartPose start pose
+      \param swingEndPose end pose
+      \param taskGain IK task gain
+      \param swingTrajPreparation data prepared by prepareSwingTraj (nullptr if not prepared)
+
+      This is static so that an identical trajectory can be made in a worker thread to calculate the lookup table.
+   */
+  static std::shared_ptr<SwingTraj> makeSwingTraj(
+      const Limb & limb,
+      const std::string & swingTrajType,
+      const SwingCommand & swingCommand,
+      bool isContact,
+      const sva::PTransformd & swingStartPose,
+      const sva::PTransformd & swingEndPose,
+      const TaskGain & taskGain,
+      const std::shared_ptr<const SwingTraj::Preparation> & swingTrajPreparation);
+
 protected:
   //! Configuration
   Configuration config_;
@@ -214,8 +455,11 @@ protected:
   //! Limb
   Limb limb_;
 
-  //! Swing command list (map of start time and swing command)
-  std::map<double, std::shared_ptr<SwingCommand>> swingCommandList_;
+  //! Limb task (resolved once in the constructor)
+  std::shared_ptr<mc_tasks::force::FirstOrderImpedanceTask> limbTask_;
+
+  //! Swing command list (timeline of start time and swing command)
+  CommandTimeline<SwingCommand> swingCommandList_;
 
   //! Current swing command
   std::shared_ptr<SwingCommand> currentSwingCommand_ = nullptr;
@@ -223,14 +467,27 @@ protected:
   //! Previous swing command pose
   std::shared_ptr<SwingCommand> prevSwingCommand_ = nullptr;
 
-  //! Contact command list (map of start time and contact command)
-  std::map<double, std::shared_ptr<ContactCommand>> contactCommandList_;
+  /** \brief Swing trajectory preparation. */
+  struct SwingTrajPreparation
+  {
+    //! Type of swing trajectory
+    std::string type;
+
+    //! Prepared data (set by the worker thread of the task queue)
+    std::future<std::shared_ptr<const SwingTraj::Preparation>> data;
+  };
+
+  //! Swing trajectory preparation of each swing command not yet started
+  std::unordered_map<std::shared_ptr<SwingCommand>, SwingTrajPreparation> swingTrajPreparationList_;
+
+  //! Contact command list (timeline of start time and contact command)
+  CommandTimeline<ContactCommand> contactCommandList_;
 
   //! Current contact command
   std::shared_ptr<ContactCommand> currentContactCommand_ = nullptr;
 
-  //! Gripper command list (map of start time and gripper command)
-  std::map<double, std::shared_ptr<GripperCommand>> gripperCommandList_;
+  //! Gripper command list (timeline of start time and gripper command)
+  CommandTimeline<GripperCommand> gripperCommandList_;
 
   //! Target limb pose represented in world frame
   sva::PTransformd targetPose_;
@@ -247,12 +504,24 @@ protected:
   //! Limb swing trajectory
   std::shared_ptr<SwingTraj> swingTraj_ = nullptr;
 
+  //! Lookup table of swingTraj_ being calculated by the worker thread of the task queue (invalid if not requested)
+  std::future<SwingTraj::LookupTable> swingTrajLookupTable_;
+
   //! Whether touch down is detected during swing
   bool touchDown_ = false;
 
   //! Phase
   std::string phase_ = "Uninitialized";
 
+  //! Swing trajectory or contact constraint from which phase_ is built (nullptr if free)
+  const void * phaseSource_ = nullptr;
+
+  //! Whether touch down is detected when phase_ is built
+  bool phaseTouchDown_ = false;
+
+  //! Whether to require updating phase_
+  bool requirePhaseUpdate_ = true;
+
   //! Type of impedance gains
   std::string impGainType_ = "Uninitialized";
 
@@ -261,5 +530,11 @@ protected:
 
   //! Whether to require updating target pose for contact constraint
   bool requireTouchDownPoseUpdate_ = false;
+
+  //! Earliest time from which the commanded limb pose and contact may have been changed (infinity if unchanged)
+  double commandChangedTime_ = std::numeric_limits<double>::infinity();
+
+  //! Actions on the shared resources deferred by updateLocal
+  std::vector<SharedAction> deferredSharedActions_;
 };
 } // namespace MCC
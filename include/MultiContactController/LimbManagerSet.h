@@ -1,11 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
+#include <MultiContactController/CommandQueue.h>
+#include <MultiContactController/ContactSchedule.h>
 #include <MultiContactController/LimbManager.h>
+#include <MultiContactController/TaskQueue.h>
+#include <MultiContactController/ThreadPool.h>
 
 namespace MCC
 {
+class StepCommandSocket;
+
 /** \brief Set of LimbManager. */
 class LimbManagerSet : public std::unordered_map<Limb, std::shared_ptr<LimbManager>>
 {
@@ -15,19 +28,75 @@ class LimbManagerSet : public std::unordered_map<Limb, std::shared_ptr<LimbManag
     //! Name
     std::string name = "LimbManagerSet";
 
+    //! Capacity of the step command queue (i.e., maximum number of step command sequences pushed in a control cycle)
+    size_t stepCommandQueueCapacity = 256;
+
+    //! Path of the Unix domain socket file to stream step commands (the socket is disabled if empty)
+    std::string stepCommandSocketPath = "";
+
+    //! Duration by which the contact schedule is built beyond the horizon so that it is not rebuilt every cycle [sec]
+    double contactScheduleMargin = 1.0;
+
     /** \brief Load mc_rtc configuration.
         \param mcRtcConfig mc_rtc configuration
     */
     void load(const mc_rtc::Configuration & mcRtcConfig);
   };
 
+public:
+  /** \brief Snapshot of the contacts at the current time.
+
+      The snapshot is built once every control cycle in the update method, after all LimbManagers update their
+     commands, and is shared by the managers and states instead of rebuilding the contact list.
+   */
+  struct ContactSnapshot
+  {
+    //! Time of snapshot [sec]
+    double t = 0;
+
+    //! Limbs in contact
+    std::vector<Limb> limbVec;
+
+    //! Contact constraint vector (the i-th element is the constraint of limbVec[i])
+    std::vector<std::shared_ptr<ContactConstraint>> contactVec;
+
+    //! Contact weight vector (the i-th element is the contact weight of limbVec[i])
+    std::vector<double> weightVec;
+
+    /** \brief Get the number of limbs in contact. */
+    inline size_t size() const noexcept
+    {
+      return limbVec.size();
+    }
+
+    /** \brief Get the index of the limb in limbVec (-1 if the limb is not in contact).
+        \param limb limb
+     */
+    inline int limbIdx(const Limb & limb) const
+    {
+      auto it = std::find_if(limbVec.begin(), limbVec.end(),
+                             [&](const Limb & contactLimb) { return std::equal_to<Limb>()(contactLimb, limb); });
+      return (it == limbVec.end() ? -1 : static_cast<int>(std::distance(limbVec.begin(), it)));
+    }
+  };
+
+  /** \brief Function to make a sequence of step commands on the control thread.
+
+      The function is called with the controller and the list of pairs of limb and step command to set, and returns
+     whether the step commands are made. This is intended for the step commands relative to the control state (e.g.,
+     the current time and the limb poses), which must not be accessed by the threads other than the control thread.
+   */
+  using StepCommandGenerator = std::function<bool(const MultiContactController & ctl,
+                                                  std::vector<std::pair<Limb, StepCommand>> & stepCommandList)>;
+
 public:
   /** \brief Constructor.
       \param ctlPtr pointer to controller
       \param mcRtcConfig mc_rtc configuration
 
       mcRtcConfig has the configuration of LimbManagerSet in the root entry and the configuration of each LimbManager
-     under the "LimbManager" entry. Each LimbManager configuration is overwritten in the order of default, limb group,
+     under the "LimbManager" entry. If the number of worker threads in the "ThreadPool" entry is positive, the limbs
+     are updated concurrently. Each LimbManager configuration is overwritten in the order of default, limb group,
      limb name.
 
       An example of \p mcRtcConfig is as follows.
@@ -45,6 +114,12 @@ public:
   */
   LimbManagerSet(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
 
+  /** \brief Destructor.
+
+      This is defined in the source file because StepCommandSocket is incomplete in this header.
+   */
+  ~LimbManagerSet();
+
   /** \brief Reset.
       \param constraintSetConfig mc_rtc configuration for contact constraint set
 
@@ -65,7 +140,13 @@ public:
 
   /** \brief Update.
 
-      This method should be called once every control cycle.
+      This method should be called once every control cycle. The step commands pushed by pushStepCommands are appended
+     at the beginning of this method.
+
+      If the thread pool has worker threads, the limbs are partitioned into contiguous chunks and
+     LimbManager::updateLocal is called concurrently for each chunk. Then LimbManager::updateShared is called for each
+     limb in the same order as the serial update, and the data across limbs (e.g., the contact snapshot) is built after
+     that as in the serial update, so the result is identical to the serial update.
   */
   void update();
 
@@ -81,6 +162,18 @@ public:
     return config_;
   }
 
+  /** \brief Accessor to the thread pool to update limbs concurrently. */
+  inline ThreadPool & threadPool() const noexcept
+  {
+    return *threadPool_;
+  }
+
+  /** \brief Accessor to the task queue to prepare swing trajectories in the background. */
+  inline TaskQueue & swingTrajPreparationQueue() const noexcept
+  {
+    return *swingTrajPreparationQueue_;
+  }
+
   /** \brief Add entries to the GUI. */
   void addToGUI(mc_rtc::gui::StateBuilder & gui);
 
@@ -98,6 +191,80 @@ public:
    */
   std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> contactList(double t) const;
 
+  /** \brief Get the snapshot of the contacts at the current time. */
+  inline const ContactSnapshot & contactSnapshot() const noexcept
+  {
+    return contactSnapshot_;
+  }
+
+  /** \brief Get contact schedule from the current time to the horizon set by setContactScheduleHorizon.
+
+      The contact schedule covers the window from the current time to the horizon plus config_.contactScheduleMargin,
+     and the last segment is assumed to continue beyond the window. It is rebuilt in the update method only when the
+     commands in the window are changed, the window does not cover the horizon, or the current time crosses the
+     segment boundary. Use this instead of contactList when the contact set is queried many times in a control cycle
+     (e.g., for each MPC horizon node).
+   */
+  inline const ContactSchedule & contactSchedule() const noexcept
+  {
+    return contactSchedule_;
+  }
+
+  /** \brief Set the horizon of the contact schedule.
+      \param horizon duration from the current time for which the contact schedule is required [sec]
+
+      The contact schedule is rebuilt immediately if it does not cover the horizon.
+   */
+  void setContactScheduleHorizon(double horizon);
+
+  /** \brief Calculate the contact schedule assuming that the limbs about to touch down touch down now.
+      \param contactSchedule contact schedule to set
+      \return whether any limb is about to touch down (contactSchedule is not set if false)
+
+      See LimbManager::getTouchDownContactCommand for the limbs about to touch down. The returned schedule is used to
+     speculatively solve MPC for the contact transition before touch down is detected.
+   */
+  bool calcTouchDownContactSchedule(ContactSchedule & contactSchedule) const;
+
+  /** \brief Append a sequence of step commands of multiple limbs.
+      \param stepCommandList list of pairs of limb and step command (the commands of each limb must be in time order)
+      \return whether the step commands are appended
+
+      The whole sequence is validated in one pass before appending (including the collision of the commands at the
+      same control tick), so either all the step commands are appended or none of them is appended.
+   */
+  bool appendStepCommands(const std::vector<std::pair<Limb, StepCommand>> & stepCommandList);
+
+  /** \brief Push a sequence of step commands of multiple limbs to the queue.
+      \param stepCommandList list of pairs of limb and step command (the commands of each limb must be in time order)
+      \return whether the step commands are pushed (false if the queue is full)
+
+      This method is lock-free and can be called from any thread (e.g., GUI callbacks and socket threads). The pushed
+      sequences are appended by appendStepCommands in the order of pushing at the beginning of the next update, so
+      that the commands are never changed in the middle of a control cycle.
+   */
+  bool pushStepCommands(std::vector<std::pair<Limb, StepCommand>> && stepCommandList);
+
+  /** \brief Push a function to make a sequence of step commands to the queue.
+      \param generator function called on the control thread to make the step commands
+      \return whether the function is pushed (false if the queue is full)
+
+      This method is lock-free and can be called from any thread like the other overload. The function is called at the
+     beginning of the next update in the order of pushing, and the step commands made by it are appended by
+     appendStepCommands. The function must not capture any object that may be destructed before it is called.
+   */
+  bool pushStepCommands(StepCommandGenerator && generator);
+
+  /** \brief Get the time of the last update (thread-safe).
+
+      This is intended to be used as the base time of relative step commands by the threads other than the control
+     thread, which must not access the controller time directly.
+   */
+  inline double lastUpdateTime() const noexcept
+  {
+    return lastUpdateTime_.load(std::memory_order_relaxed);
+  }
+
   /** \brief Get whether future contact command is stacked. */
   bool contactCommandStacked() const;
 
@@ -119,6 +286,27 @@ public:
    */
   std::array<double, 2> getClosestContactTimes(double t, const std::unordered_set<Limb> & limbs) const;
 
+  /** \brief Get the earliest time from which the commands of any limb may have been changed since the last call of
+     clearCommandChangedTime.
+
+      Infinity is returned if the commands have not been changed. See LimbManager::commandChangedTime for details.
+   */
+  double commandChangedTime() const;
+
+  /** \brief Clear the time returned by commandChangedTime. */
+  void clearCommandChangedTime();
+
+protected:
+  /** \brief Request of step commands pushed to the queue. */
+  struct StepCommandRequest
+  {
+    //! List of pairs of limb and step command
+    std::vector<std::pair<Limb, StepCommand>> stepCommandList;
+
+    //! Function to make the step commands on the control thread (stepCommandList is used as is if empty)
+    StepCommandGenerator generator;
+  };
+
 protected:
   /** \brief Const accessor to the controller. */
   inline const MultiContactController & ctl() const
@@ -132,6 +320,29 @@ protected:
     return *ctlPtr_;
   }
 
+  /** \brief Append the step commands pushed to the queue. */
+  void appendQueuedStepCommands();
+
+  /** \brief Update contact snapshot. */
+  void updateContactSnapshot();
+
+  /** \brief Update contact schedule.
+      \param forceRebuild whether to rebuild the contact schedule even if the previous one can be reused
+
+      This should be called after updateContactSnapshot and before the time returned by commandChangedTime is cleared.
+   */
+  void updateContactSchedule(bool forceRebuild);
+
+  /** \brief Calculate contact schedule from the current time to the specified end time.
+      \param contactSchedule contact schedule to set
+      \param touchDownContactCommandList contact commands of the limbs assumed to touch down now
+      \param endTime end time of contact schedule
+   */
+  void calcContactSchedule(
+      ContactSchedule & contactSchedule,
+      const std::unordered_map<Limb, std::shared_ptr<ContactCommand>> & touchDownContactCommandList,
+      double endTime) const;
+
 protected:
   //! Configuration
   Configuration config_;
@@ -141,5 +352,41 @@ protected:
 
   //! Map from limb group to limbs
   std::unordered_map<std::string, std::unordered_set<Limb>> groupLimbsMap_;
+
+  //! Contact snapshot
+  ContactSnapshot contactSnapshot_;
+
+  //! Contact schedule
+  ContactSchedule contactSchedule_;
+
+  //! Horizon of contact schedule [sec]
+  double contactScheduleHorizon_ = 0.0;
+
+  //! End time of contact schedule [sec]
+  double contactScheduleEndTime_ = -1 * std::numeric_limits<double>::infinity();
+
+  //! Queue of step command requests pushed from any thread
+  std::unique_ptr<CommandQueue<StepCommandRequest>> stepCommandQueue_;
+
+  //! Time of the last update
+  std::atomic<double> lastUpdateTime_{0.0};
+
+  //! Socket to stream step commands
+  std::unique_ptr<StepCommandSocket> stepCommandSocket_;
+
+  //! Thread pool to update limbs concurrently
+  std::unique_ptr<ThreadPool> threadPool_;
+
+  //! Limb managers in the order of the serial update
+  std::vector<std::shared_ptr<LimbManager>> limbManagerVec_;
+
+  //! Tasks to update the data local to each chunk of limbs
+  std::vector<std::function<void()>> limbUpdateTasks_;
+
+  //! Exceptions thrown by the tasks (the i-th element is that of limbUpdateTasks_[i])
+  std::vector<std::exception_ptr> limbUpdateExceptions_;
+
+  //! Task queue to prepare swing trajectories in the background (shared by all the limb managers)
+  std::unique_ptr<TaskQueue> swingTrajPreparationQueue_;
 };
 } // namespace MCC
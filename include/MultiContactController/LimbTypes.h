@@ -29,14 +29,30 @@ struct Limb
 
       Limb group is automatically set if _group is empty and _name contains "Hand" or "Foot" (case-sensitive). Different
       limbs must have different names; limbs with the same name but different groups are not allowed.
+
+      The limb name is interned to the integer ID, so that comparing and hashing limbs in the control loop do not
+      access the string.
   */
   Limb(const std::string & _name, const std::string & _group = "");
 
+  /** \brief Get the ID of the limb name (a new ID is assigned if the name is not interned yet).
+      \param _name limb name
+
+      IDs are assigned sequentially from zero, so they can be used as the index of dense per-limb arrays.
+  */
+  static int nameToId(const std::string & _name);
+
+  /** \brief Get the number of interned limb names (i.e., the upper bound of limb IDs). */
+  static int idNum();
+
   //! Limb name
   std::string name;
 
   //! Limb group
   std::string group;
+
+  //! Limb ID interned from the limb name
+  int id;
 };
 } // namespace MCC
 
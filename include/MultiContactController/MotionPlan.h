@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <mc_rtc/Configuration.h>
+
+namespace MCC
+{
+/** \brief Precompiled motion plan memory-mapped from a binary file.
+
+    The motion plan is compiled from the configuration of ConfigMotionState (i.e., stepCommandList,
+    nominalCentroidalPoseList, nominalPostureList, collisionConfigList, and taskConfigList) into a binary file that
+    consists of a header, a record table sorted by time, and a payload area. Each record holds the earliest time at
+    which the entry takes effect, and its payload is the MessagePack serialization of the original configuration
+    entry. The file is memory-mapped read-only and each payload is decoded only when the entry is requested, so
+    opening the plan takes constant time and the resident memory is bounded by the window of entries being read
+    regardless of the plan length.
+ */
+class MotionPlan
+{
+public:
+  /** \brief Type of record. */
+  enum class RecordType : uint32_t
+  {
+    //! Step command
+    StepCommand = 0,
+
+    //! Nominal centroidal pose
+    NominalCentroidalPose,
+
+    //! Nominal posture
+    NominalPosture,
+
+    //! Collision configuration
+    CollisionConfig,
+
+    //! Task configuration
+    TaskConfig
+  };
+
+  /** \brief File header. */
+  struct Header
+  {
+    //! Magic string to identify the file format
+    char magic[8];
+
+    //! Format version
+    uint32_t version;
+
+    //! Number of records
+    uint32_t recordNum;
+
+    //! Offset of the payload area from the beginning of the file [byte]
+    uint64_t payloadAreaOffset;
+
+    //! Size of the payload area [byte]
+    uint64_t payloadAreaSize;
+  };
+
+  /** \brief Record. */
+  struct Record
+  {
+    //! Earliest time at which the entry takes effect (before applying base time) [sec]
+    double time;
+
+    //! Type of record
+    RecordType type;
+
+    //! Size of payload [byte]
+    uint32_t payloadSize;
+
+    //! Offset of payload from the beginning of the payload area [byte]
+    uint64_t payloadOffset;
+  };
+
+  //! Magic string of the file format
+  static constexpr char magic[8] = {'M', 'C', 'C', 'P', 'L', 'A', 'N', '\0'};
+
+  //! Format version
+  static constexpr uint32_t version = 1;
+
+public:
+  /** \brief Compile the configuration of ConfigMotionState into a motion plan file.
+      \param mcRtcConfig configuration with the same entries as the "configs" entry of ConfigMotionState
+      \param path path of the file to write
+      \return number of compiled records
+
+      The entries are not validated except for their times, so that the plan can be compiled without the robot model
+      (e.g., the contact vertices).
+   */
+  static size_t compile(const mc_rtc::Configuration & mcRtcConfig, const std::string & path);
+
+  /** \brief Calculate the earliest time at which the step command takes effect.
+      \param stepCommandConfig configuration of step command in simple or full description format
+   */
+  static double calcStepCommandTime(const mc_rtc::Configuration & stepCommandConfig);
+
+public:
+  /** \brief Constructor.
+      \param path path of the motion plan file
+   */
+  MotionPlan(const std::string & path);
+
+  /** \brief Destructor. */
+  ~MotionPlan();
+
+  // Non-copyable because the object owns the memory mapping
+  MotionPlan(const MotionPlan &) = delete;
+  MotionPlan & operator=(const MotionPlan &) = delete;
+
+  /** \brief Get the number of records. */
+  inline size_t size() const noexcept
+  {
+    return header_->recordNum;
+  }
+
+  /** \brief Get the record.
+      \param idx record index
+   */
+  inline const Record & record(size_t idx) const
+  {
+    return records_[idx];
+  }
+
+  /** \brief Decode the payload of the record.
+      \param idx record index
+   */
+  mc_rtc::Configuration payload(size_t idx) const;
+
+protected:
+  //! Path of the motion plan file
+  std::string path_;
+
+  //! Address of the memory mapping
+  void * data_ = nullptr;
+
+  //! Size of the memory mapping [byte]
+  size_t dataSize_ = 0;
+
+  //! Header in the memory mapping
+  const Header * header_ = nullptr;
+
+  //! Records in the memory mapping
+  const Record * records_ = nullptr;
+
+  //! Payload area in the memory mapping
+  const char * payloadArea_ = nullptr;
+};
+} // namespace MCC
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <exception>
+#include <functional>
+#include <vector>
+
 #include <mc_control/fsm/Controller.h>
 
 #include <MultiContactController/LimbTypes.h>
@@ -21,6 +25,10 @@ namespace MCC
 class LimbManagerSet;
 class CentroidalManager;
 class PostureManager;
+class ThreadPool;
+class RealTimeProfile;
+class OverrunWatchdog;
+class StageTimer;
 
 /** \brief Humanoid multi-contact motion controller. */
 struct MultiContactController : public mc_control::fsm::Controller
@@ -40,12 +48,18 @@ public:
 
       If the pose is registered in the "MCC::ResetBasePose" key of the datastore, the pose will be applied to the
      baselink poses of the control and real robots in the reset function.
+
+      If the real-time profile is enabled in the "RealTimeProfile" key of the controller configuration, the profile
+     is applied to the calling thread (i.e., the control thread) and the worker threads of the controller.
    */
   void reset(const mc_control::ControllerResetData & resetData) override;
 
   /** \brief Run a controller.
 
       This method is called every control period.
+
+      If the overrun watchdog is enabled in the "OverrunWatchdog" key of the controller configuration, the wall-clock
+     duration of this method is measured, and MPC is degraded while the control cycles overrun.
    */
   bool run() override;
 
@@ -102,6 +116,18 @@ public:
   //! Posture manager
   std::shared_ptr<PostureManager> postureManager_;
 
+  //! Thread pool to run the manager update stages concurrently
+  std::shared_ptr<ThreadPool> threadPool_;
+
+  //! Real-time execution profile applied at reset
+  std::shared_ptr<RealTimeProfile> realTimeProfile_;
+
+  //! Watchdog of control cycle overrun
+  std::shared_ptr<OverrunWatchdog> overrunWatchdog_;
+
+  //! Timer of the stages of the control cycle
+  std::shared_ptr<StageTimer> stageTimer_;
+
   //! Whether to enable manager update
   bool enableManagerUpdate_ = false;
 
@@ -114,5 +140,16 @@ protected:
 
   //! Current time [sec]
   double t_ = 0;
+
+  /** \brief Stages of manager update.
+
+      The stages are run in order, and the tasks in each stage are run concurrently by the thread pool. The updates of
+     LimbManagerSet, PostureManager, and the actual state of CentroidalManager are independent of each other, and the
+     control of CentroidalManager (i.e., MPC and wrench distribution) depends on all of them.
+   */
+  std::vector<std::vector<std::function<void()>>> managerUpdateStages_;
+
+  //! Exceptions thrown by the tasks of manager update (the (i, j)-th element is that of managerUpdateStages_[i][j])
+  std::vector<std::vector<std::exception_ptr>> managerUpdateExceptions_;
 };
 } // namespace MCC
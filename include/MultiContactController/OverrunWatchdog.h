@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <MultiContactController/CentroidalManager.h>
+
+namespace MCC
+{
+/** \brief Watchdog of control cycle overrun that degrades MPC step by step.
+
+    The wall-clock duration of each control cycle is compared with the control period. When the number of overrun
+    cycles in the sliding window reaches the threshold, the degradation level is raised by one step of the configured
+    ladder (e.g., reducing DDP iterations, lengthening horizon dt, shortening horizon duration, and finally reusing the
+    previous plan). When the cycles keep the headroom for the specified number of consecutive cycles, the level is
+    lowered by one step. The degradations of the levels up to the current level are merged, so each step of the ladder
+    only needs to specify what is added at that step.
+ */
+class OverrunWatchdog
+{
+public:
+  /** \brief Configuration. */
+  struct Configuration
+  {
+    //! Whether to enable the watchdog
+    bool enabled = false;
+
+    //! Ratio of cycle duration to control period above which the cycle is regarded as overrun
+    double overrunRatio = 1.0;
+
+    //! Number of cycles in the sliding window to count overruns
+    int windowSize = 50;
+
+    //! Number of overrun cycles in the sliding window to raise the degradation level
+    int overrunNumToDegrade = 5;
+
+    //! Ratio of cycle duration to control period below which the cycle is regarded as having headroom
+    double headroomRatio = 0.6;
+
+    //! Number of consecutive cycles with headroom to lower the degradation level
+    int headroomCycleNumToRecover = 2000;
+
+    //! Ladder of MPC degradation (the i-th element is added at level i + 1)
+    //! Note that ddpMaxIter has no effect with the centroidal manager not based on DDP (e.g., PC)
+    std::vector<CentroidalManager::MpcDegradation> degradationLadder;
+
+    /** \brief Load mc_rtc configuration.
+        \param mcRtcConfig mc_rtc configuration
+    */
+    void load(const mc_rtc::Configuration & mcRtcConfig);
+  };
+
+public:
+  /** \brief Constructor.
+      \param mcRtcConfig mc_rtc configuration
+   */
+  OverrunWatchdog(const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Const accessor to the configuration. */
+  inline const Configuration & config() const noexcept
+  {
+    return config_;
+  }
+
+  /** \brief Reset the degradation level and the statistics. */
+  void reset();
+
+  /** \brief Update with the duration of the control cycle.
+      \param cycleDuration wall-clock duration of the control cycle [sec]
+      \param dt control period [sec]
+      \returns whether the degradation level is changed
+   */
+  bool update(double cycleDuration, double dt);
+
+  /** \brief Get the degradation level (zero if not degraded). */
+  inline int level() const noexcept
+  {
+    return level_;
+  }
+
+  /** \brief Get the degradation of MPC at the current level. */
+  inline const CentroidalManager::MpcDegradation & mpcDegradation() const noexcept
+  {
+    return levelDegradationList_[level_];
+  }
+
+  /** \brief Get the degradation of MPC at each level. */
+  inline const std::vector<CentroidalManager::MpcDegradation> & levelDegradationList() const noexcept
+  {
+    return levelDegradationList_;
+  }
+
+  /** \brief Add entries to the GUI.
+      \param gui GUI
+      \param category category of the entries
+   */
+  void addToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
+
+  /** \brief Remove entries from the GUI. */
+  void removeFromGUI(mc_rtc::gui::StateBuilder & gui);
+
+  /** \brief Add entries to the logger.
+      \param logger logger
+      \param name prefix of the entries
+   */
+  void addToLogger(mc_rtc::Logger & logger, const std::string & name);
+
+  /** \brief Remove entries from the logger. */
+  void removeFromLogger(mc_rtc::Logger & logger);
+
+protected:
+  /** \brief Change the degradation level and clear the statistics. */
+  void setLevel(int level);
+
+protected:
+  //! Configuration
+  Configuration config_;
+
+  //! Degradation of MPC at each level (merged from the ladder up to the level)
+  std::vector<CentroidalManager::MpcDegradation> levelDegradationList_;
+
+  //! Degradation level
+  int level_ = 0;
+
+  //! Whether each cycle in the sliding window is overrun (ring buffer)
+  std::vector<char> overrunWindow_;
+
+  //! Index of the next element in overrunWindow_
+  int overrunWindowIdx_ = 0;
+
+  //! Number of overrun cycles in overrunWindow_
+  int overrunNum_ = 0;
+
+  //! Number of consecutive cycles with headroom
+  int headroomCycleNum_ = 0;
+
+  //! Duration of the last control cycle [sec]
+  double cycleDuration_ = 0;
+
+  //! Total number of overrun cycles since reset
+  int totalOverrunNum_ = 0;
+
+  //! GUI category
+  std::vector<std::string> guiCategory_;
+};
+} // namespace MCC
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+namespace MCC
+{
+class ThreadPool;
+
+/** \brief Real-time execution profile of the controller.
+
+    The profile sets the CPU affinity and the real-time scheduling policy of the control thread and the worker threads
+    owned by the controller, locks the memory of the process, and prefaults the heap so that the control cycle does not
+    cause page faults. Each setting that fails (e.g., due to missing privileges) is reported with the way to grant the
+    privilege, and the remaining settings are still applied.
+
+    Only the main malloc arena is prefaulted. The stacks of the threads and the malloc arenas created for the worker
+    threads are not touched in advance; when the memory is locked, their pages are faulted in once when they are mapped
+    (including the threads created after the profile is applied), and are not paged out afterwards.
+ */
+class RealTimeProfile
+{
+public:
+  /** \brief Configuration. */
+  struct Configuration
+  {
+    //! Whether to apply the profile
+    bool enabled = false;
+
+    //! List of CPUs to which the control thread is pinned (not pinned if empty)
+    std::vector<int> cpuList;
+
+    //! List of CPUs to which the worker threads not pinned by their thread pool are pinned (not pinned if empty)
+    std::vector<int> workerCpuList;
+
+    //! Scheduling policy ("FIFO", "RR", or "Other" to keep the default policy)
+    std::string schedPolicy = "FIFO";
+
+    //! Scheduling priority of the control thread
+    int priority = 80;
+
+    //! Scheduling priority of the worker threads (including the MPC and swing trajectory preparation threads)
+    int workerPriority = 79;
+
+    //! Whether to lock the current and future memory of the process
+    bool lockMemory = true;
+
+    //! Size of the heap to prefault [byte]
+    size_t prefaultHeapSize = 64 * 1024 * 1024;
+
+    /** \brief Load mc_rtc configuration.
+        \param mcRtcConfig mc_rtc configuration
+    */
+    void load(const mc_rtc::Configuration & mcRtcConfig);
+  };
+
+public:
+  /** \brief Constructor.
+      \param mcRtcConfig mc_rtc configuration
+   */
+  RealTimeProfile(const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Const accessor to the configuration. */
+  inline const Configuration & config() const noexcept
+  {
+    return config_;
+  }
+
+  /** \brief Apply the profile.
+      \param threadPoolList thread pools whose worker threads are configured (nullptr elements are ignored)
+      \param workerThreadList other worker threads to be configured
+      \returns whether all the settings are applied successfully
+
+      This method should be called from the control thread. The memory is locked and the heap is prefaulted before the
+     scheduling policy is changed, so that the prefaulting does not block the other real-time threads.
+   */
+  bool apply(const std::vector<ThreadPool *> & threadPoolList,
+             const std::vector<pthread_t> & workerThreadList = {}) const;
+
+  /** \brief Apply the CPU affinity and the scheduling policy of the worker threads.
+      \param workerThreadList worker threads to be configured
+      \param threadDesc description of threads for messages
+      \returns whether all the settings are applied successfully
+
+      This method is used to configure the worker threads created after the profile is applied (e.g., MPC worker
+      threads started at the reset of the centroidal manager).
+   */
+  bool applyToWorkerThreads(const std::vector<pthread_t> & workerThreadList, const std::string & threadDesc) const;
+
+protected:
+  /** \brief Set the CPU affinity of the thread.
+      \param thread thread
+      \param cpuList list of CPUs
+      \param threadDesc description of thread for messages
+   */
+  bool setAffinity(pthread_t thread, const std::vector<int> & cpuList, const std::string & threadDesc) const;
+
+  /** \brief Set the scheduling policy of the thread.
+      \param thread thread
+      \param priority scheduling priority
+      \param threadDesc description of thread for messages
+   */
+  bool setScheduling(pthread_t thread, int priority, const std::string & threadDesc) const;
+
+  /** \brief Lock the current and future memory of the process. */
+  bool lockMemory() const;
+
+  /** \brief Prefault the heap. */
+  void prefaultHeap() const;
+
+protected:
+  //! Configuration
+  Configuration config_;
+
+  //! Scheduling policy
+  int schedPolicy_ = SCHED_OTHER;
+};
+} // namespace MCC
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+#include <mc_rtc/gui/StateBuilder.h>
+#include <mc_rtc/log/Logger.h>
+
+/** \brief Measure the duration of the enclosing scope as the specified stage of the timer.
+    \param TIMER StageTimer instance
+    \param STAGE enumerator of StageTimer::Stage (e.g., Mpc)
+
+    This expands to nothing unless MCC_ENABLE_STAGE_TIMER is defined (i.e., the ENABLE_STAGE_TIMER CMake option is
+   ON), so the timers are removed at compile time in production builds. This can be used at most once in each scope.
+ */
+#ifdef MCC_ENABLE_STAGE_TIMER
+#  define MCC_STAGE_TIMER_SCOPE(TIMER, STAGE) \
+    MCC::StageTimer::Scope mccStageTimerScope((TIMER), MCC::StageTimer::Stage::STAGE)
+#else
+#  define MCC_STAGE_TIMER_SCOPE(TIMER, STAGE)
+#endif
+
+namespace MCC
+{
+/** \brief Rolling histogram of latency.
+
+    In the manner of HDR histogram, the buckets are logarithmic with linear sub-buckets in each power of two, so that
+    the relative error of the percentiles is bounded (about 6%) over the range from 1 us to 16 s. The histogram holds
+    the samples of the latest window, and the bucket of the oldest sample is decremented when a new sample is added,
+    so adding a sample takes constant time without memory allocation.
+ */
+class LatencyHistogram
+{
+public:
+  //! Number of sub-buckets in each power of two
+  static constexpr int subBucketNum = 16;
+
+  //! Number of powers of two covered by the buckets
+  static constexpr int octaveNum = 24;
+
+  //! Number of buckets (the first bucket is for the values less than 1 us)
+  static constexpr int bucketNum = 1 + octaveNum * subBucketNum;
+
+public:
+  /** \brief Constructor.
+      \param windowSize number of the latest samples held in the histogram
+   */
+  LatencyHistogram(int windowSize = 10000);
+
+  /** \brief Add a sample.
+      \param latency latency [ms]
+   */
+  void add(double latency);
+
+  /** \brief Clear the samples. */
+  void clear();
+
+  /** \brief Get the number of samples in the window. */
+  inline int sampleNum() const noexcept
+  {
+    return sampleNum_;
+  }
+
+  /** \brief Get the percentile [ms].
+      \param ratio ratio in [0, 1] (e.g., 0.99 for p99)
+
+      The upper bound of the bucket containing the percentile is returned. Zero is returned if there is no sample.
+   */
+  double percentile(double ratio) const;
+
+  /** \brief Get the maximum in the window [ms] (upper bound of the highest non-empty bucket). */
+  inline double max() const
+  {
+    return percentile(1.0);
+  }
+
+protected:
+  /** \brief Get the index of the bucket containing the latency.
+      \param latency latency [ms]
+   */
+  static int bucketIdx(double latency);
+
+  /** \brief Get the upper bound of the bucket [ms].
+      \param bucketIdx index of bucket
+   */
+  static double bucketUpperBound(int bucketIdx);
+
+protected:
+  //! Number of samples in each bucket
+  std::array<int, bucketNum> bucketCounts_ = {};
+
+  //! Bucket index of each sample in the window (ring buffer)
+  std::vector<uint16_t> windowBucketIdxList_;
+
+  //! Index of the next element in windowBucketIdxList_
+  int windowIdx_ = 0;
+
+  //! Number of samples in the window
+  int sampleNum_ = 0;
+};
+
+/** \brief Timer of the stages of the control cycle.
+
+    The duration of each stage is accumulated by MCC_STAGE_TIMER_SCOPE within a control cycle, and is logged and added
+    to the rolling histogram by finishCycle at the end of the control cycle. Each stage must be measured only from one
+    thread in a control cycle, and the stages may be nested (e.g., GuiMarker in LimbManager).
+ */
+class StageTimer
+{
+public:
+  /** \brief Stage of the control cycle. */
+  enum class Stage
+  {
+    //! Update of LimbManagerSet
+    LimbManager = 0,
+
+    //! Reference data generation of CentroidalManager
+    RefData,
+
+    //! MPC of CentroidalManager
+    Mpc,
+
+    //! Wrench distribution of CentroidalManager
+    WrenchDist,
+
+    //! Refresh of the GUI markers (contact markers and force markers)
+    GuiMarker,
+
+    //! Update of PostureManager
+    PostureManager,
+
+    //! Run of the base FSM controller (including the QP)
+    Fsm,
+
+    //! Whole control cycle
+    Cycle
+  };
+
+  //! Number of stages
+  static constexpr int stageNum = static_cast<int>(Stage::Cycle) + 1;
+
+  /** \brief Get the name of the stage.
+      \param stage stage
+   */
+  static const char * stageName(Stage stage);
+
+  /** \brief Scope to measure the duration of a stage (use MCC_STAGE_TIMER_SCOPE instead of this directly). */
+  class Scope
+  {
+  public:
+    /** \brief Constructor.
+        \param timer timer
+        \param stage stage
+     */
+    inline Scope(StageTimer & timer, Stage stage)
+    : duration_(timer.stageDataList_[static_cast<int>(stage)].duration), startTime_(Clock::now())
+    {
+    }
+
+    /** \brief Destructor. */
+    inline ~Scope()
+    {
+      duration_ += std::chrono::duration<double, std::milli>(Clock::now() - startTime_).count();
+    }
+
+    // Non-copyable
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+  protected:
+    //! Clock type
+    using Clock = std::chrono::steady_clock;
+
+    //! Duration of the stage accumulated in the current control cycle [ms]
+    double & duration_;
+
+    //! Start time
+    Clock::time_point startTime_;
+  };
+
+  /** \brief Configuration. */
+  struct Configuration
+  {
+    //! Number of the latest control cycles held in the histogram
+    int histogramWindowSize = 10000;
+
+    /** \brief Load mc_rtc configuration.
+        \param mcRtcConfig mc_rtc configuration
+    */
+    void load(const mc_rtc::Configuration & mcRtcConfig);
+  };
+
+public:
+  /** \brief Constructor.
+      \param mcRtcConfig mc_rtc configuration
+   */
+  StageTimer(const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Const accessor to the configuration. */
+  inline const Configuration & config() const noexcept
+  {
+    return config_;
+  }
+
+  /** \brief Finish the control cycle.
+
+      This method should be called once at the end of every control cycle after all the stages are finished.
+   */
+  void finishCycle();
+
+  /** \brief Get the duration of the stage in the last finished control cycle [ms].
+      \param stage stage
+   */
+  inline double lastDuration(Stage stage) const noexcept
+  {
+    return stageDataList_[static_cast<int>(stage)].lastDuration;
+  }
+
+  /** \brief Const accessor to the histogram of the stage.
+      \param stage stage
+   */
+  inline const LatencyHistogram & histogram(Stage stage) const noexcept
+  {
+    return stageDataList_[static_cast<int>(stage)].histogram;
+  }
+
+  /** \brief Add entries to the GUI (nothing is added if the timers are disabled at compile time).
+      \param gui GUI
+      \param category category of the entries
+   */
+  void addToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
+
+  /** \brief Remove entries from the GUI. */
+  void removeFromGUI(mc_rtc::gui::StateBuilder & gui);
+
+  /** \brief Add entries to the logger (nothing is added if the timers are disabled at compile time).
+      \param logger logger
+      \param name prefix of the entries
+   */
+  void addToLogger(mc_rtc::Logger & logger, const std::string & name);
+
+  /** \brief Remove entries from the logger. */
+  void removeFromLogger(mc_rtc::Logger & logger);
+
+protected:
+  /** \brief Data of each stage (aligned to avoid false sharing between the stages measured in different threads). */
+  struct alignas(64) StageData
+  {
+    //! Duration accumulated in the current control cycle [ms]
+    double duration = 0;
+
+    //! Duration in the last finished control cycle [ms]
+    double lastDuration = 0;
+
+    //! Rolling histogram of the duration
+    LatencyHistogram histogram;
+  };
+
+protected:
+  //! Configuration
+  Configuration config_;
+
+  //! Data of each stage
+  std::array<StageData, stageNum> stageDataList_;
+
+  //! GUI category
+  std::vector<std::string> guiCategory_;
+};
+} // namespace MCC
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+namespace MCC
+{
+class LimbManagerSet;
+
+/** \brief Unix domain socket endpoint streaming step commands into the command queue of LimbManagerSet.
+
+    The socket is served by a dedicated thread, which accepts any number of clients (e.g., an external planner). Each
+    message consists of the payload size as a 32-bit unsigned integer in the host byte order, followed by the payload
+    in the MessagePack format. The payload is a map with the same entries as the "configs" entry of ConfigMotionState
+    for step commands, as follows (the times are absolute if "relativeTime" is false, and relative to the time of the
+    last control cycle otherwise).
+    @code
+    relativeTime: true
+    stepCommandList:
+      - limb: LeftFoot
+        type: Add
+        startTime: 1.0
+        endTime: 2.0
+        pose:
+          translation: [0.2, 0.1, 0]
+        constraint:
+          type: Surface
+          fricCoeff: 0.5
+    @endcode
+
+    The step commands of a message are decoded and constructed in the socket thread and pushed into the queue as one
+    sequence, so the control thread only appends them without parsing or allocating them.
+ */
+class StepCommandSocket
+{
+public:
+  //! Maximum payload size of a message [byte]
+  static constexpr uint32_t maxPayloadSize = 16 * 1024 * 1024;
+
+public:
+  /** \brief Constructor.
+      \param limbManagerSet limb manager set to which the step commands are pushed
+      \param path path of the socket file (the existing file is replaced)
+   */
+  StepCommandSocket(LimbManagerSet * limbManagerSet, const std::string & path);
+
+  /** \brief Destructor. */
+  ~StepCommandSocket();
+
+  // Non-copyable because the object owns the socket and thread
+  StepCommandSocket(const StepCommandSocket &) = delete;
+  StepCommandSocket & operator=(const StepCommandSocket &) = delete;
+
+  /** \brief Get the path of the socket file. */
+  inline const std::string & path() const noexcept
+  {
+    return path_;
+  }
+
+protected:
+  /** \brief Client connection. */
+  struct Client
+  {
+    //! File descriptor
+    int fd = -1;
+
+    //! Received bytes that are not processed yet
+    std::vector<char> buffer;
+  };
+
+protected:
+  /** \brief Serve the socket until stopped (called in the socket thread). */
+  void serve();
+
+  /** \brief Receive bytes from the client and process the complete messages.
+      \param client client
+      \return whether the connection should be kept
+   */
+  bool receive(Client & client);
+
+  /** \brief Process the message.
+      \param payload payload of the message
+   */
+  void processMessage(const mc_rtc::Configuration & payload);
+
+protected:
+  //! Limb manager set
+  LimbManagerSet * limbManagerSet_ = nullptr;
+
+  //! Path of the socket file
+  std::string path_;
+
+  //! File descriptor of the listening socket
+  int listenFd_ = -1;
+
+  //! Whether to stop the socket thread
+  std::atomic<bool> stopRequested_{false};
+
+  //! Socket thread
+  std::thread thread_;
+};
+} // namespace MCC
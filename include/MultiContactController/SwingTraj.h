@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <mc_rtc/Configuration.h>
 #include <SpaceVecAlg/SpaceVecAlg>
 
@@ -15,15 +17,60 @@ public:
   /** \brief Configuration. */
   struct Configuration
   {
+    //! Time step of the lookup table made in the background after the swing start [sec] (the table is not made if
+    //! non-positive)
+    double lookupTableStep = 0.0;
+
     /** \brief Load mc_rtc configuration.
         \param mcRtcConfig mc_rtc configuration
     */
-    virtual void load(const mc_rtc::Configuration & // mcRtcConfig
-    )
+    virtual void load(const mc_rtc::Configuration & mcRtcConfig)
     {
+      mcRtcConfig("lookupTableStep", lookupTableStep);
     }
   };
 
+  /** \brief Sample of the swing trajectory at a time. */
+  struct Sample
+  {
+    //! Time [sec]
+    double t = 0;
+
+    //! Pose
+    sva::PTransformd pose = sva::PTransformd::Identity();
+
+    //! Velocity
+    sva::MotionVecd vel = sva::MotionVecd::Zero();
+
+    //! Acceleration
+    sva::MotionVecd accel = sva::MotionVecd::Zero();
+
+    //! IK task gain
+    TaskGain taskGain;
+  };
+
+  /** \brief Data prepared before the swing starts.
+
+      The part of the swing trajectory independent of the start pose (e.g., the configuration parsed from mc_rtc
+      configuration) is prepared when the swing command is appended, so that only the part depending on the start pose
+      is constructed at the swing start.
+   */
+  struct Preparation
+  {
+    /** \brief Destructor. */
+    virtual ~Preparation() = default;
+  };
+
+  /** \brief Lookup table of the samples over the whole swing. */
+  struct LookupTable
+  {
+    //! Time step [sec]
+    double step = 0;
+
+    //! Samples (the i-th element is the sample at startTime_ + i * step)
+    std::vector<Sample> sampleList;
+  };
+
 public:
   /** \brief Constructor.
       \param commandType type of swing command
@@ -82,6 +129,36 @@ public:
   inline virtual void touchDown(double t)
   {
     touchDownTime_ = t;
+    lastSampleValid_ = false;
+  }
+
+  /** \brief Evaluate the pose, velocity, acceleration, and IK task gain of the swing trajectory at a specified time in
+      one pass.
+      \param t time
+
+      The last sample is cached, so the evaluation at the same time (e.g., by update and touch down detection in the
+      same control cycle) is not repeated. If the lookup table is made and the time matches a sample time of the table,
+      the sample in the table is returned. The returned reference is valid until the next call. Note that the cache is
+      updated even by this const method, so it must not be called concurrently from multiple threads.
+  */
+  const Sample & evaluate(double t) const;
+
+  /** \brief Calculate the lookup table over the whole swing.
+      \param step time step of the table [sec]
+
+      Since the table depends on the start pose, it cannot be made before the swing starts. Instead, it is intended
+      to be calculated in a worker thread from a separate instance constructed with the same arguments and passed to
+      setLookupTable, because calculating it takes much longer than a control cycle. This must not be called on an
+      instance used by another thread because calcSample may update the mutable members.
+  */
+  LookupTable calcLookupTable(double step) const;
+
+  /** \brief Set the lookup table.
+      \param lookupTable lookup table calculated by calcLookupTable of an instance constructed with the same arguments
+  */
+  inline void setLookupTable(LookupTable && lookupTable)
+  {
+    lookupTable_ = std::move(lookupTable);
   }
 
   /** \brief Const accessor to the configuration. */
@@ -91,6 +168,14 @@ protected:
   /** \brief Accessor to the configuration. */
   virtual Configuration & config() = 0;
 
+  /** \brief Calculate the sample of the swing trajectory at a specified time.
+      \param t time
+      \param sample sample to set
+
+      The derived class can override this to share the segment search among the quantities.
+  */
+  virtual void calcSample(double t, Sample & sample) const;
+
 public:
   //! Type of swing command
   SwingCommand::Type commandType_;
@@ -116,5 +201,14 @@ public:
 protected:
   //! Time when touch down is detected (-1 if not detected)
   double touchDownTime_ = -1;
+
+  //! Lookup table (empty until set by setLookupTable)
+  LookupTable lookupTable_;
+
+  //! Last sample returned by evaluate
+  mutable Sample lastSample_;
+
+  //! Whether lastSample_ is valid
+  mutable bool lastSampleValid_ = false;
 };
 } // namespace MCC
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace MCC
+{
+/** \brief Worker thread to run queued tasks in the background.
+
+    The worker thread is created once at construction and runs the submitted tasks one by one in the order of
+    submission, so that no thread is created for each task. The result of each task (or the exception thrown by it) is
+    returned through the future returned by the submit method, which the caller can poll without blocking.
+ */
+class TaskQueue
+{
+public:
+  /** \brief Constructor. */
+  TaskQueue();
+
+  /** \brief Destructor.
+
+      The tasks not yet started are discarded (i.e., their futures throw std::future_error with broken_promise), and the
+      task being run is waited for.
+   */
+  ~TaskQueue();
+
+  // Non-copyable because the object owns the thread
+  TaskQueue(const TaskQueue &) = delete;
+  TaskQueue & operator=(const TaskQueue &) = delete;
+
+  /** \brief Get the native handle of the worker thread (e.g., to set the scheduling policy). */
+  inline std::thread::native_handle_type nativeHandle()
+  {
+    return thread_.native_handle();
+  }
+
+  /** \brief Submit a task to run in the worker thread.
+      \param func function of the task
+      \return future of the return value of the function
+   */
+  template<class FuncType>
+  std::future<std::invoke_result_t<FuncType>> submit(FuncType && func)
+  {
+    auto task = std::make_shared<std::packaged_task<std::invoke_result_t<FuncType>()>>(std::forward<FuncType>(func));
+    std::future<std::invoke_result_t<FuncType>> future = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.emplace_back([task]() { (*task)(); });
+    }
+    cond_.notify_one();
+    return future;
+  }
+
+protected:
+  /** \brief Work in the worker thread. */
+  void work();
+
+protected:
+  //! Mutex to access the tasks
+  std::mutex mutex_;
+
+  //! Condition variable to wake up the worker
+  std::condition_variable cond_;
+
+  //! Tasks not yet started
+  std::deque<std::function<void()>> tasks_;
+
+  //! Whether to stop the worker
+  bool stopRequested_ = false;
+
+  //! Worker thread (declared last so that it is started after the other members are initialized)
+  std::thread thread_;
+};
+} // namespace MCC
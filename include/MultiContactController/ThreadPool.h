@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+namespace MCC
+{
+/** \brief Fixed-size pool of worker threads to run tasks concurrently within a control cycle.
+
+    The worker threads are created once at construction and optionally pinned to the specified CPUs. The run method
+    distributes the given tasks to the workers and the calling thread, and returns after all the tasks are finished, so
+    that the tasks can access the data of the control cycle without further synchronization. The task list is passed by
+    reference and is not copied, so running the preallocated tasks does not allocate memory.
+ */
+class ThreadPool
+{
+public:
+  /** \brief Configuration. */
+  struct Configuration
+  {
+    //! Number of worker threads (the calling thread also runs the tasks, so zero means sequential execution)
+    int threadNum = 0;
+
+    //! List of CPUs to which the worker threads are pinned (the i-th worker is pinned to the (i % size)-th CPU)
+    std::vector<int> cpuList;
+
+    /** \brief Load mc_rtc configuration.
+        \param mcRtcConfig mc_rtc configuration
+    */
+    void load(const mc_rtc::Configuration & mcRtcConfig);
+  };
+
+public:
+  /** \brief Constructor.
+      \param mcRtcConfig mc_rtc configuration
+   */
+  ThreadPool(const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Destructor. */
+  ~ThreadPool();
+
+  // Non-copyable because the object owns the threads
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /** \brief Const accessor to the configuration. */
+  inline const Configuration & config() const noexcept
+  {
+    return config_;
+  }
+
+  /** \brief Get the number of worker threads. */
+  inline int threadNum() const noexcept
+  {
+    return static_cast<int>(threads_.size());
+  }
+
+  /** \brief Get the native handles of the worker threads (e.g., to set the scheduling policy). */
+  std::vector<std::thread::native_handle_type> nativeHandles();
+
+  /** \brief Run the tasks concurrently and wait until all of them are finished.
+      \param tasks tasks (must not throw exceptions)
+
+      This method must not be called concurrently from multiple threads, nor from the tasks.
+   */
+  void run(const std::vector<std::function<void()>> & tasks);
+
+protected:
+  /** \brief Work in the worker thread. */
+  void work();
+
+  /** \brief Run the tasks until no task is left.
+      \param tasks tasks
+   */
+  void runTasks(const std::vector<std::function<void()>> & tasks);
+
+protected:
+  //! Configuration
+  Configuration config_;
+
+  //! Worker threads
+  std::vector<std::thread> threads_;
+
+  //! Mutex to publish the tasks and wait for them to finish
+  std::mutex mutex_;
+
+  //! Condition variable to wake up the workers
+  std::condition_variable cond_;
+
+  //! Condition variable to wake up the calling thread waiting for the tasks to finish
+  std::condition_variable doneCond_;
+
+  //! Tasks being run (nullptr if not running)
+  const std::vector<std::function<void()>> * tasks_ = nullptr;
+
+  //! Generation incremented each time the tasks are published
+  size_t generation_ = 0;
+
+  //! Whether to stop the workers
+  bool stopRequested_ = false;
+
+  //! Index of the next task to run
+  std::atomic<size_t> nextTaskIdx_{0};
+
+  //! Number of finished tasks
+  std::atomic<size_t> finishedTaskNum_{0};
+
+  //! Number of workers running the published tasks (accessed with mutex_ locked)
+  int busyThreadNum_ = 0;
+};
+} // namespace MCC
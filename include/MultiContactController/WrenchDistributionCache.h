@@ -0,0 +1,113 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mc_rtc/Configuration.h>
+
+#include <MultiContactController/ContactSchedule.h>
+
+namespace ForceColl
+{
+class WrenchDistribution;
+} // namespace ForceColl
+
+namespace MCC
+{
+/** \brief LRU cache of wrench distribution keyed by contact set.
+
+    Constructing ForceColl::WrenchDistribution builds the friction cone matrices and the QP structure. This cache
+    reuses the wrench distribution as long as the contact set (limb, type of contact constraint, and global vertices
+    and ridges of the constraint) is unchanged, so that the recurring contact sets (e.g., in a cyclic gait) are built
+    only once.
+
+    The key consists only of the content of the contact constraints, not their addresses, so that a constraint
+    allocated at the address of a freed one is not mistaken for it. The ridges are determined by the contact normal and
+    the friction coefficient, so the change of either of them is also detected. Since calculating the key allocates
+    and compares the vertices, it is skipped while the contact constraints are the same objects as those of the last
+    call, which is the case in most control cycles.
+ */
+class WrenchDistributionCache
+{
+public:
+  /** \brief Cache entry. */
+  struct Entry
+  {
+    /** \brief Key element of contact set. */
+    struct KeyElement
+    {
+      //! Limb name
+      std::string limbName;
+
+      //! Type of contact constraint
+      std::string constraintType;
+
+      //! Global vertices and ridges of the constraint (the elements are concatenated)
+      std::vector<double> geometry;
+
+      /** \brief Equal operator. */
+      bool operator==(const KeyElement & other) const;
+    };
+
+    //! Key of contact set (sorted by limb name)
+    std::vector<KeyElement> key;
+
+    //! Limb vector (the i-th element is the limb of contactVec[i])
+    std::vector<Limb> limbVec;
+
+    //! Contact constraint vector passed to the wrench distribution
+    std::vector<std::shared_ptr<ContactConstraint>> contactVec;
+
+    //! Wrench distribution
+    std::shared_ptr<ForceColl::WrenchDistribution> wrenchDist;
+  };
+
+public:
+  /** \brief Get the wrench distribution for the contact set of the segment.
+      \param segment contact schedule segment
+      \param wrenchDistConfig configuration for wrench distribution
+      \param capacity maximum number of cached entries (the cache is disabled if zero)
+
+      If the cache has no entry for the contact set, a new wrench distribution is constructed and the least recently
+      used entry is evicted if the cache is full.
+   */
+  const Entry & get(const ContactSchedule::Segment & segment,
+                    const mc_rtc::Configuration & wrenchDistConfig,
+                    int capacity);
+
+  /** \brief Clear the cache. */
+  inline void clear()
+  {
+    entryList_.clear();
+    lastLimbVec_.clear();
+    lastContactVec_.clear();
+  }
+
+  /** \brief Get whether the last call of get hit the cache. */
+  inline bool lastHit() const noexcept
+  {
+    return lastHit_;
+  }
+
+protected:
+  /** \brief Calculate the key of contact set.
+      \param segment contact schedule segment
+   */
+  static std::vector<Entry::KeyElement> calcKey(const ContactSchedule::Segment & segment);
+
+protected:
+  //! Entry list ordered from the most recently used
+  std::list<Entry> entryList_;
+
+  //! Whether the last call of get hit the cache
+  bool lastHit_ = false;
+
+  //! Limb vector of the segment of the last call
+  std::vector<Limb> lastLimbVec_;
+
+  //! Contact constraint vector of the segment of the last call (held so that their addresses are not reused)
+  std::vector<std::shared_ptr<ContactConstraint>> lastContactVec_;
+};
+} // namespace MCC
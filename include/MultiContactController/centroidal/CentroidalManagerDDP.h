@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cmath>
+
 #include <CCC/DdpCentroidal.h>
 
-#include <MultiContactController/CentroidalManager.h>
+#include <MultiContactController/centroidal/CentroidalManagerDdpBase.h>
 
 namespace MCC
 {
@@ -10,7 +12,7 @@ namespace MCC
 
     Centroidal manager calculates the target of robot centroidal state through trajectory planning and feedback control.
  */
-class CentroidalManagerDDP : public CentroidalManager
+class CentroidalManagerDDP : public CentroidalManagerDdpBase
 {
 public:
   /** \brief Configuration. */
@@ -25,6 +27,19 @@ public:
     //! DDP maximum iteration
     int ddpMaxIter = 1;
 
+    //! Time budget of DDP iterations per control cycle [ms] (the budget is not used if zero or negative)
+    double ddpTimeBudget = 0;
+
+    //! Threshold of relative cost improvement to stop DDP iterations (used only if ddpTimeBudget is positive)
+    double ddpCostImprovementThreshold = 1e-3;
+
+    //! Whether to use the previous solution shifted in time as the initial guess (otherwise reuse it index-for-index)
+    bool useTimeShiftedWarmStart = true;
+
+    //! Whether to apply the feedback gain of DDP to correct the planned wrench with the actual state in each control
+    //! cycle (centroidalGainP, centroidalGainD, angularGainP, and angularGainD are not used while it is applied)
+    bool useDdpFeedbackGain = false;
+
     //! Feedback gain of orientation
     Eigen::Vector3d angularGainP = Eigen::Vector3d(1.0, 1.0, 4.0);
 
@@ -48,6 +63,12 @@ public:
    */
   CentroidalManagerDDP(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
 
+  /** \brief Destructor.
+
+      The MPC worker threads are stopped here, because they call runMpc, which accesses the members of this class.
+   */
+  virtual ~CentroidalManagerDDP();
+
   /** \brief Reset.
 
       This method should be called once when controller is reset.
@@ -74,21 +95,79 @@ protected:
   }
 
   /** \brief Run MPC to plan centroidal trajectory.
+      \param mpcData MPC data
 
-      This method calculates controlData_.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
-     controlData_.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
+      This method calculates mpcData.controlData.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
+     mpcData.controlData.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
    */
-  virtual void runMpc() override;
+  virtual void runMpc(MpcData & mpcData) override;
+
+  /** \brief Apply the result of MPC to controlData_.
+      \param mpcData MPC data
+
+      If config_.useDdpFeedbackGain is true, the planned centroidal wrench is corrected by the local feedback policy of
+     DDP, i.e., u = u* + K (x - x*), where x is the actual centroidal state. Since this feedback already corrects the
+     position and momentum with the actual state, the PD feedback terms are switched off: the centroidal feedback with
+     config_.centroidalGainP and config_.centroidalGainD is skipped, and the planned angular acceleration is calculated
+     from the corrected wrench instead of the PD feedback of orientation with config_.angularGainP and
+     config_.angularGainD.
+   */
+  virtual void applyMpcData(const MpcData & mpcData) override;
+
+  /** \brief Calculate the planned centroidal angular acceleration.
+      \param controlData control data with the planned centroidal wrench and momentum and the centroidal state for MPC
+      \param refData reference data
+
+      The PD feedback of the orientation to the reference orientation is applied because DdpCentroidal does not handle
+     orientation.
+   */
+  virtual Eigen::Vector3d calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                            const RefData & refData) const override;
+
+  /** \brief Get whether MPC needs to provide the feedback gain in MpcData. */
+  inline virtual bool requireFeedbackGain() const override
+  {
+    return config_.useDdpFeedbackGain;
+  }
+
+  /** \brief Get horizon dt of MPC [sec] (degraded by mpcDegradation_). */
+  inline virtual double mpcHorizonDt() const override
+  {
+    return mpcDegradation_.degradeHorizonDt(config_.horizonDt);
+  }
+
+  /** \brief Get number of horizon steps of MPC (degraded by mpcDegradation_). */
+  inline virtual int mpcHorizonSteps() const override
+  {
+    return calcHorizonSteps(mpcDegradation_);
+  }
+
+  /** \brief Calculate number of horizon steps of MPC.
+      \param mpcDegradation degradation of MPC
+   */
+  inline int calcHorizonSteps(const MpcDegradation & mpcDegradation) const
+  {
+    return std::max(static_cast<int>(std::floor(mpcDegradation.degradeHorizonDuration(config_.horizonDuration)
+                                                / mpcDegradation.degradeHorizonDt(config_.horizonDt))),
+                    1);
+  }
+
+  /** \brief Make DDP.
+      \param mpcDegradation degradation of MPC that determines the horizon
+   */
+  std::shared_ptr<CCC::DdpCentroidal> makeDdp(const MpcDegradation & mpcDegradation) const;
 
   /** \brief Calculate motion parameter of MPC.
+      \param mpcData MPC data
       \param t time
    */
-  CCC::DdpCentroidal::MotionParam calcMpcMotionParam(double t) const;
+  CCC::DdpCentroidal::MotionParam calcMpcMotionParam(const MpcData & mpcData, double t) const;
 
   /** \brief Calculate reference data of MPC.
+      \param mpcData MPC data
       \param t time
    */
-  CCC::DdpCentroidal::RefData calcMpcRefData(double t) const;
+  CCC::DdpCentroidal::RefData calcMpcRefData(const MpcData & mpcData, double t) const;
 
 protected:
   //! Configuration
@@ -96,5 +175,12 @@ protected:
 
   //! DDP
   std::shared_ptr<CCC::DdpCentroidal> ddp_;
+
+  //! DDP for speculative MPC (nullptr if config().enableSpeculativeMpc is false)
+  std::shared_ptr<CCC::DdpCentroidal> speculativeDdp_;
+
+  //! DDP built for each horizon in solverHorizonList_ for each solver instance (empty for speculative MPC if
+  //! config().enableSpeculativeMpc is false)
+  std::array<std::vector<std::shared_ptr<CCC::DdpCentroidal>>, 2> ddpList_;
 };
 } // namespace MCC
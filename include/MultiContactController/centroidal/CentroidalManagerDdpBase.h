@@ -0,0 +1,86 @@
+#pragma once
+
+#include <MultiContactController/CentroidalManager.h>
+
+namespace MCC
+{
+/** \brief Base of centroidal managers with DDP-based MPC.
+
+    This provides the functions common to the DDP-based MPC (i.e., CentroidalManagerDDP and CentroidalManagerSRB), which
+    are not used by the other MPC.
+ */
+class CentroidalManagerDdpBase : public CentroidalManager
+{
+public:
+  /** \brief Data of the previous MPC used for warm start. */
+  struct WarmStartData
+  {
+    //! Whether the data is set
+    bool valid = false;
+
+    //! Time at the start of MPC [sec]
+    double t = 0;
+
+    //! Horizon dt [sec]
+    double horizonDt = 0;
+
+    //! Contact schedule from the start of MPC
+    ContactSchedule contactSchedule;
+  };
+
+public:
+  /** \brief Constructor.
+      \param ctlPtr pointer to controller
+      \param mcRtcConfig mc_rtc configuration
+   */
+  CentroidalManagerDdpBase(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Reset.
+
+      This method should be called once when controller is reset.
+   */
+  virtual void reset() override;
+
+protected:
+  /** \brief Calculate the initial guess of the input sequence of DDP-based MPC from the previous solution.
+      \param mpcData MPC data
+      \param prevInputList input sequence of the previous MPC (force scales of the contact ridges at each node)
+      \return input sequence (empty if there is no previous solution)
+
+      The previous input is linearly interpolated at the node times of the current MPC (i.e., shifted in time). The
+     input of each contact is remapped by limb, so that the input is retained across contact switches; the mean of the
+     previous input is used for the contact added newly.
+   */
+  std::vector<Eigen::VectorXd> calcWarmStartInputList(const MpcData & mpcData,
+                                                      const std::vector<Eigen::VectorXd> & prevInputList) const;
+
+  /** \brief Run iterations of DDP-based MPC within the time budget.
+      \param mpcData MPC data (iteration count, computation duration, and termination reason are set)
+      \param maxIter maximum number of iterations
+      \param timeBudget time budget [ms]
+      \param costImprovementThreshold threshold of relative cost improvement to stop iterating
+      \param runIter function to run one DDP iteration and return the cost
+
+      Iterations are continued while the remaining time budget is larger than the running estimate of the duration of
+     one iteration, and stopped early when the cost converges, i.e., the cost does not increase and its relative
+     improvement falls below the threshold.
+   */
+  void runDdpIterations(MpcData & mpcData,
+                        int maxIter,
+                        double timeBudget,
+                        double costImprovementThreshold,
+                        const std::function<double()> & runIter);
+
+  /** \brief Store the data of the solved MPC for the warm start of the next MPC.
+      \param mpcData MPC data
+   */
+  void setWarmStartData(const MpcData & mpcData);
+
+protected:
+  //! Data of the previous MPC for warm start for each solver instance (accessed only from runMpc)
+  std::array<WarmStartData, 2> warmStartData_;
+
+  //! Running estimate of the duration of one DDP iteration [ms] for each solver instance (accessed only from runMpc)
+  std::array<double, 2> ddpIterDurationEstimate_ = {0, 0};
+};
+} // namespace MCC
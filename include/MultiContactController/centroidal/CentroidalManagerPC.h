@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cmath>
+
 #include <CCC/PreviewControlCentroidal.h>
 
 #include <MultiContactController/CentroidalManager.h>
@@ -39,6 +42,12 @@ public:
    */
   CentroidalManagerPC(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
 
+  /** \brief Destructor.
+
+      The MPC worker threads are stopped here, because they call runMpc, which accesses the members of this class.
+   */
+  virtual ~CentroidalManagerPC();
+
   /** \brief Reset.
 
       This method should be called once when controller is reset.
@@ -62,21 +71,61 @@ protected:
   }
 
   /** \brief Run MPC to plan centroidal trajectory.
+      \param mpcData MPC data
 
-      This method calculates controlData_.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
-     controlData_.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
+      This method calculates mpcData.controlData.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
+     mpcData.controlData.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
    */
-  virtual void runMpc() override;
+  virtual void runMpc(MpcData & mpcData) override;
+
+  /** \brief Get horizon dt of MPC [sec] (degraded by mpcDegradation_). */
+  inline virtual double mpcHorizonDt() const override
+  {
+    return mpcDegradation_.degradeHorizonDt(config_.horizonDt);
+  }
+
+  /** \brief Get number of horizon steps of MPC (degraded by mpcDegradation_). */
+  inline virtual int mpcHorizonSteps() const override
+  {
+    return calcHorizonSteps(mpcDegradation_);
+  }
+
+  /** \brief Calculate number of horizon steps of MPC.
+      \param mpcDegradation degradation of MPC
+   */
+  inline int calcHorizonSteps(const MpcDegradation & mpcDegradation) const
+  {
+    return std::max(static_cast<int>(std::floor(mpcDegradation.degradeHorizonDuration(config_.horizonDuration)
+                                                / mpcDegradation.degradeHorizonDt(config_.horizonDt))),
+                    1);
+  }
+
+  /** \brief Make preview control.
+      \param mpcDegradation degradation of MPC that determines the horizon
+   */
+  std::shared_ptr<CCC::PreviewControlCentroidal> makePc(const MpcDegradation & mpcDegradation) const;
 
   /** \brief Calculate motion parameter of MPC.
+      \param mpcData MPC data
       \param t time
    */
-  CCC::PreviewControlCentroidal::MotionParam calcMpcMotionParam(double t) const;
+  CCC::PreviewControlCentroidal::MotionParam calcMpcMotionParam(const MpcData & mpcData, double t) const;
+
+  /** \brief Calculate reference position sequence of MPC.
+      \param mpcData MPC data
+
+      The reference position of each horizon node is converted once per MPC into the contiguous storage
+      mpcRefPosSeq_, so that the preview summation over the horizon reads it without conversion.
+   */
+  void calcMpcRefPosSeq(const MpcData & mpcData);
 
   /** \brief Calculate reference data of MPC.
+      \param mpcData MPC data
       \param t time
+
+      calcMpcRefPosSeq must be called beforehand.
    */
-  CCC::PreviewControlCentroidal::RefData calcMpcRefData(double t) const;
+  CCC::PreviewControlCentroidal::RefData calcMpcRefData(const MpcData & mpcData, double t) const;
 
 protected:
   //! Configuration
@@ -84,5 +133,15 @@ protected:
 
   //! Preview control
   std::shared_ptr<CCC::PreviewControlCentroidal> pc_;
+
+  //! Preview control for speculative MPC (nullptr if config().enableSpeculativeMpc is false)
+  std::shared_ptr<CCC::PreviewControlCentroidal> speculativePc_;
+
+  //! Preview control built for each horizon in solverHorizonList_ for each solver instance (empty for speculative MPC
+  //! if config().enableSpeculativeMpc is false)
+  std::array<std::vector<std::shared_ptr<CCC::PreviewControlCentroidal>>, 2> pcList_;
+
+  //! Reference position (angular in RPY, then linear) of each horizon node stored column-wise for each solver instance
+  std::array<Eigen::Matrix<double, 6, Eigen::Dynamic>, 2> mpcRefPosSeq_;
 };
 } // namespace MCC
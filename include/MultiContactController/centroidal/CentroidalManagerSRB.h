@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cmath>
+
 #include <CCC/DdpSingleRigidBody.h>
 
-#include <MultiContactController/CentroidalManager.h>
+#include <MultiContactController/centroidal/CentroidalManagerDdpBase.h>
 
 namespace MCC
 {
@@ -10,7 +12,7 @@ namespace MCC
 
     Centroidal manager calculates the target of robot centroidal state through trajectory planning and feedback control.
  */
-class CentroidalManagerSRB : public CentroidalManager
+class CentroidalManagerSRB : public CentroidalManagerDdpBase
 {
 public:
   /** \brief Configuration. */
@@ -25,6 +27,15 @@ public:
     //! DDP maximum iteration
     int ddpMaxIter = 1;
 
+    //! Time budget of DDP iterations per control cycle [ms] (the budget is not used if zero or negative)
+    double ddpTimeBudget = 0;
+
+    //! Threshold of relative cost improvement to stop DDP iterations (used only if ddpTimeBudget is positive)
+    double ddpCostImprovementThreshold = 1e-3;
+
+    //! Whether to use the previous solution shifted in time as the initial guess (otherwise reuse it index-for-index)
+    bool useTimeShiftedWarmStart = true;
+
     //! Weight parameter of MPC objective function
     CCC::DdpSingleRigidBody::WeightParam mpcWeightParam;
 
@@ -42,6 +53,12 @@ public:
    */
   CentroidalManagerSRB(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig = {});
 
+  /** \brief Destructor.
+
+      The MPC worker threads are stopped here, because they call runMpc, which accesses the members of this class.
+   */
+  virtual ~CentroidalManagerSRB();
+
   /** \brief Reset.
 
       This method should be called once when controller is reset.
@@ -65,21 +82,60 @@ protected:
   }
 
   /** \brief Run MPC to plan centroidal trajectory.
+      \param mpcData MPC data
+
+      This method calculates mpcData.controlData.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
+     mpcData.controlData.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
+   */
+  virtual void runMpc(MpcData & mpcData) override;
+
+  /** \brief Calculate the planned centroidal angular acceleration.
+      \param controlData control data with the planned centroidal wrench and momentum and the centroidal state for MPC
+      \param refData reference data
+
+      The angular acceleration is calculated by Euler's equation of the single rigid body.
+   */
+  virtual Eigen::Vector3d calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                            const RefData & refData) const override;
 
-      This method calculates controlData_.planned(CentroidalAccel|CentroidalMomentum|CentroidalWrench) from
-     controlData_.mpc(mpcCentroidalPose|mpcCentroidalVel|mpcCentroidalMomentum).
+  /** \brief Get horizon dt of MPC [sec] (degraded by mpcDegradation_). */
+  inline virtual double mpcHorizonDt() const override
+  {
+    return mpcDegradation_.degradeHorizonDt(config_.horizonDt);
+  }
+
+  /** \brief Get number of horizon steps of MPC (degraded by mpcDegradation_). */
+  inline virtual int mpcHorizonSteps() const override
+  {
+    return calcHorizonSteps(mpcDegradation_);
+  }
+
+  /** \brief Calculate number of horizon steps of MPC.
+      \param mpcDegradation degradation of MPC
    */
-  virtual void runMpc() override;
+  inline int calcHorizonSteps(const MpcDegradation & mpcDegradation) const
+  {
+    return std::max(static_cast<int>(std::floor(mpcDegradation.degradeHorizonDuration(config_.horizonDuration)
+                                                / mpcDegradation.degradeHorizonDt(config_.horizonDt))),
+                    1);
+  }
+
+  /** \brief Make DDP.
+      \param mpcDegradation degradation of MPC that determines the horizon
+   */
+  std::shared_ptr<CCC::DdpSingleRigidBody> makeDdp(const MpcDegradation & mpcDegradation) const;
 
   /** \brief Calculate motion parameter of MPC.
+      \param mpcData MPC data
       \param t time
    */
-  CCC::DdpSingleRigidBody::MotionParam calcMpcMotionParam(double t) const;
+  CCC::DdpSingleRigidBody::MotionParam calcMpcMotionParam(const MpcData & mpcData, double t) const;
 
   /** \brief Calculate reference data of MPC.
+      \param mpcData MPC data
       \param t time
    */
-  CCC::DdpSingleRigidBody::RefData calcMpcRefData(double t) const;
+  CCC::DdpSingleRigidBody::RefData calcMpcRefData(const MpcData & mpcData, double t) const;
 
 protected:
   //! Configuration
@@ -87,5 +143,12 @@ protected:
 
   //! DDP
   std::shared_ptr<CCC::DdpSingleRigidBody> ddp_;
+
+  //! DDP for speculative MPC (nullptr if config().enableSpeculativeMpc is false)
+  std::shared_ptr<CCC::DdpSingleRigidBody> speculativeDdp_;
+
+  //! DDP built for each horizon in solverHorizonList_ for each solver instance (empty for speculative MPC if
+  //! config().enableSpeculativeMpc is false)
+  std::array<std::vector<std::shared_ptr<CCC::DdpSingleRigidBody>>, 2> ddpList_;
 };
 } // namespace MCC
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <limits>
 #include <map>
+#include <memory>
 
+#include <MultiContactController/CommandTypes.h>
+#include <MultiContactController/MotionPlan.h>
 #include <MultiContactController/State.h>
 
 namespace MCC
 {
-/** \brief FSM state to send motion from configuration. */
+/** \brief FSM state to send motion from configuration.
+
+    If the "motionPlanFile" entry is specified, the motion plan compiled by CompileMotionPlan is memory-mapped in
+    addition to the entries in the configuration, and its entries are fed to the managers lazily when their times
+    come within the lookahead duration ("motionPlanLookaheadDuration" entry) from the current time.
+ */
 struct ConfigMotionState : State
 {
 public:
@@ -20,6 +29,38 @@ public:
   void teardown(mc_control::fsm::Controller & ctl) override;
 
 protected:
+  /** \brief Feed the entries of the motion plan within the lookahead duration. */
+  void feedMotionPlan();
+
+  /** \brief Make step command with base time.
+      \param stepCommandConfig configuration of step command
+   */
+  StepCommand makeStepCommand(const mc_rtc::Configuration & stepCommandConfig) const;
+
+  /** \brief Append nominal centroidal pose with base time.
+      \param nominalCentroidalPoseConfig configuration of nominal centroidal pose
+   */
+  void appendNominalCentroidalPose(const mc_rtc::Configuration & nominalCentroidalPoseConfig);
+
+  /** \brief Append nominal posture with base time.
+      \param nominalPostureConfig configuration of nominal posture
+   */
+  void appendNominalPosture(const mc_rtc::Configuration & nominalPostureConfig);
+
+  /** \brief Append collision configuration with base time.
+      \param collisionConfig collision configuration
+   */
+  void appendCollisionConfig(const mc_rtc::Configuration & collisionConfig);
+
+  /** \brief Append task configuration with base time.
+      \param taskConfig task configuration
+   */
+  void appendTaskConfig(const mc_rtc::Configuration & taskConfig);
+
+protected:
+  //! Base time (NaN if the times are absolute)
+  double baseTime_ = std::numeric_limits<double>::quiet_NaN();
+
   //! Collision configuration list
   std::multimap<double, mc_rtc::Configuration> collisionConfigList_;
 
@@ -34,5 +75,17 @@ protected:
 
   //! Option to select whether this state should wait for finishing reference postures or not
   bool exitWhenPostureManagerFinished_ = false;
+
+  //! Motion plan (nullptr if not specified)
+  std::unique_ptr<MotionPlan> motionPlan_;
+
+  //! Index of the next record of the motion plan to feed
+  size_t motionPlanIdx_ = 0;
+
+  //! Lookahead duration to feed the entries of the motion plan [sec] (should be longer than the MPC horizon)
+  double motionPlanLookaheadDuration_ = 5.0;
+
+  //! Arena of the step commands being made (a new arena is used for each batch of the motion plan)
+  std::shared_ptr<CommandArena> commandArena_;
 };
 } // namespace MCC
@@ -20,7 +20,9 @@ public:
 protected:
   /** \brief Send step command.
       \param config mc_rtc configuration from GUI form
-      \return whether command is successfully sent
+      \return whether command is successfully pushed to the queue
+
+      The start time and the base frame pose are resolved on the control thread when the step command is appended.
    */
   bool sendStepCommand(const mc_rtc::Configuration & config) const;
 
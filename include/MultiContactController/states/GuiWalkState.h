@@ -29,7 +29,10 @@ protected:
   /** \brief Send command to walk to the relative target pose.
       \param targetTrans relative target pose of foot midpose (x [m], y [m], theta [rad])
       \param lastFootstepNum number of last footstep
-      \return whether command is successfully sent
+      \return whether command is successfully pushed to the queue
+
+      The footsteps are planned relative to the current foot midpose and the current time, which are resolved on the
+     control thread when the step commands are appended.
    */
   bool sendWalkCommand(const Eigen::Vector3d & targetTrans, int lastFootstepNum) const;
 
@@ -41,10 +44,16 @@ protected:
 
   /** \brief Make a step command.
       \param foot foot
-      \param footMidpose middle pose of both feet
-      \param startTime time to start the command
+      \param footPose foot pose
+      \param startTime time to start swinging the foot
+      \param endTime time to end swinging the foot
+      \param arena arena from which the command objects are allocated
   */
-  StepCommand makeStepCommand(const Limb & foot, const sva::PTransformd & footMidpose, double startTime) const;
+  static StepCommand makeStepCommand(const Limb & foot,
+                                     const sva::PTransformd & footPose,
+                                     double startTime,
+                                     double endTime,
+                                     const std::shared_ptr<CommandArena> & arena = nullptr);
 
 protected:
   //! Entry keys of GUI form
@@ -3,6 +3,8 @@
 #include <mc_rtc/gui/StateBuilder.h>
 
 #include <TrajColl/CubicInterpolator.h>
+#include <TrajColl/CubicSpline.h>
+#include <TrajColl/Func.h>
 
 #include <MultiContactController/SwingTraj.h>
 
@@ -46,6 +48,32 @@ public:
     virtual void load(const mc_rtc::Configuration & mcRtcConfig) override;
   };
 
+  /** \brief Data prepared before the swing starts.
+
+      In addition to the configuration, the spline to approach the end pose is prepared because it does not depend on
+      the start pose.
+   */
+  struct Preparation : public SwingTraj::Preparation
+  {
+    //! Configuration
+    Configuration config;
+
+    //! End pose assumed in the preparation
+    sva::PTransformd endPose;
+
+    //! Start time [sec]
+    double startTime;
+
+    //! End time [sec]
+    double endTime;
+
+    //! Waypoints of spline to approach limb (only for adding swing command)
+    std::map<double, Eigen::Vector3d> approachPosWaypoints;
+
+    //! Spline to approach limb (only for adding swing command)
+    std::shared_ptr<TrajColl::CubicSpline<Eigen::Vector3d>> approachPosSpline;
+  };
+
 public:
   //! Default configuration
   static inline Configuration defaultConfig_;
@@ -67,6 +95,46 @@ public:
    */
   static void removeConfigFromGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
 
+  /** \brief Prepare the part of the swing trajectory independent of the start pose.
+      \param commandType type of swing command
+      \param endPose pose end pose
+      \param startTime start time
+      \param endTime end time
+      \param baseConfig configuration to which mc_rtc configuration is loaded
+      \param mcRtcConfig mc_rtc configuration
+
+      This function does not access the default configuration, so it can be called from a thread other than the
+      control thread by passing a copy of the default configuration as baseConfig.
+   */
+  static std::shared_ptr<const Preparation> prepare(const SwingCommand::Type & commandType,
+                                                    const sva::PTransformd & endPose,
+                                                    double startTime,
+                                                    double endTime,
+                                                    const Configuration & baseConfig,
+                                                    const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Constructor with prepared data.
+      \param commandType type of swing command
+      \param isContact whether the limb is contacting
+      \param startPose start pose
+      \param endPose pose end pose
+      \param startTime start time
+      \param endTime end time
+      \param taskGain IK task gain
+      \param preparation data prepared by prepare()
+
+      The prepared spline to approach limb is reused if the end pose and times are the same as those assumed in the
+      preparation (i.e., unless the end pose is overwritten at the swing start), and is reconstructed otherwise.
+  */
+  SwingTrajCubicSplineSimple(const SwingCommand::Type & commandType,
+                             bool isContact,
+                             const sva::PTransformd & startPose,
+                             const sva::PTransformd & endPose,
+                             double startTime,
+                             double endTime,
+                             const TaskGain & taskGain,
+                             const std::shared_ptr<const Preparation> & preparation);
+
 public:
   /** \brief Constructor.
       \param commandType type of swing command
@@ -126,12 +194,37 @@ protected:
     return config_;
   }
 
+  /** \brief Calculate the sample of the swing trajectory at a specified time.
+      \param t time
+      \param sample sample to set
+
+      The position segment is searched only once for the position, velocity, and acceleration.
+  */
+  virtual void calcSample(double t, Sample & sample) const override;
+
+  /** \brief Add a position function.
+      \param endTime end time of the function
+      \param func position function
+  */
+  void addPosFunc(double endTime, const std::shared_ptr<TrajColl::Func<Eigen::Vector3d>> & func);
+
+  /** \brief Get the position function at a specified time.
+      \param t time
+
+      The search starts from the function found in the previous call, so the search at monotonically increasing times
+      is amortized O(1).
+  */
+  const TrajColl::Func<Eigen::Vector3d> & posFunc(double t) const;
+
 protected:
   //! Configuration
   Configuration config_ = defaultConfig_;
 
-  //! Position function
-  std::shared_ptr<TrajColl::PiecewiseFunc<Eigen::Vector3d>> posFunc_;
+  //! Position function list (pairs of end time and function sorted by end time)
+  std::vector<std::pair<double, std::shared_ptr<TrajColl::Func<Eigen::Vector3d>>>> posFuncList_;
+
+  //! Index of the position function found in the last search
+  mutable size_t posFuncIdx_ = 0;
 
   //! Rotation function
   std::shared_ptr<TrajColl::CubicInterpolator<Eigen::Matrix3d, Eigen::Vector3d>> rotFunc_;
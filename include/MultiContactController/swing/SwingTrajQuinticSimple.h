@@ -0,0 +1,277 @@
+#pragma once
+
+#include <array>
+
+#include <mc_rtc/gui/StateBuilder.h>
+
+#include <MultiContactController/SwingTraj.h>
+
+namespace MCC
+{
+/** \brief Simple limb swing trajectory with closed-form quintic polynomials.
+
+    The position is interpolated by quintic polynomials through the same waypoints as SwingTrajCubicSplineSimple (i.e.,
+    the start, withdraw, swing, approach, and end positions). The velocity at each intermediate waypoint is given by
+    the central difference of the adjacent waypoints and the acceleration at each waypoint is zero, so each polynomial
+    is obtained in closed form without solving linear equations. The rotation is interpolated in the log space (i.e.,
+    along the geodesic) with the minimum-jerk time scaling. All the data is stored in fixed-size members, so
+    neither construction nor evaluation allocates heap memory.
+ */
+class SwingTrajQuinticSimple : public SwingTraj
+{
+public:
+  /** \brief Configuration. */
+  struct Configuration : public SwingTraj::Configuration
+  {
+    //! Duration ratio to withdraw limb
+    double withdrawDurationRatio = 0.2;
+
+    //! Position offset to withdraw limb [m]
+    Eigen::Vector3d withdrawOffset = Eigen::Vector3d(0, 0, 0.03);
+
+    //! Duration ratio to approach limb
+    double approachDurationRatio = 0.2;
+
+    //! Position offset to approach limb [m]
+    Eigen::Vector3d approachOffset = Eigen::Vector3d(0, 0, 0.03);
+
+    //! Position offset to swing limb [m]
+    Eigen::Vector3d swingOffset = Eigen::Vector3d(0, 0, 0.1);
+
+    /** \brief Constructor.
+
+        This is necessary for https://stackoverflow.com/q/53408962
+    */
+    Configuration() {}
+
+    /** \brief Load mc_rtc configuration.
+        \param mcRtcConfig mc_rtc configuration
+    */
+    virtual void load(const mc_rtc::Configuration & mcRtcConfig) override;
+  };
+
+  /** \brief Data prepared before the swing starts. */
+  struct Preparation : public SwingTraj::Preparation
+  {
+    //! Configuration
+    Configuration config;
+  };
+
+public:
+  //! Default configuration
+  static inline Configuration defaultConfig_;
+
+  /** \brief Load mc_rtc configuration to the default configuration.
+      \param mcRtcConfig mc_rtc configuration
+  */
+  static void loadDefaultConfig(const mc_rtc::Configuration & mcRtcConfig);
+
+  /** \brief Add entries of default configuration to the GUI.
+      \param gui GUI
+      \param category category of GUI entries
+   */
+  static void addConfigToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
+
+  /** \brief Remove entries of default configuration from the GUI.
+      \param gui GUI
+      \param category category of GUI entries
+   */
+  static void removeConfigFromGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category);
+
+  /** \brief Prepare the configuration.
+      \param baseConfig configuration to which mc_rtc configuration is loaded
+      \param mcRtcConfig mc_rtc configuration
+
+      This function does not access the default configuration, so it can be called from a thread other than the
+      control thread by passing a copy of the default configuration as baseConfig.
+   */
+  static std::shared_ptr<const Preparation> prepare(const Configuration & baseConfig,
+                                                    const mc_rtc::Configuration & mcRtcConfig = {});
+
+public:
+  /** \brief Constructor.
+      \param commandType type of swing command
+      \param isContact whether the limb is contacting
+      \param startPose start pose
+      \param endPose pose end pose
+      \param startTime start time
+      \param endTime end time
+      \param taskGain IK task gain
+      \param mcRtcConfig mc_rtc configuration
+  */
+  SwingTrajQuinticSimple(const SwingCommand::Type & commandType,
+                         bool isContact,
+                         const sva::PTransformd & startPose,
+                         const sva::PTransformd & endPose,
+                         double startTime,
+                         double endTime,
+                         const TaskGain & taskGain,
+                         const mc_rtc::Configuration & mcRtcConfig = {});
+
+  /** \brief Constructor with prepared data.
+      \param commandType type of swing command
+      \param isContact whether the limb is contacting
+      \param startPose start pose
+      \param endPose pose end pose
+      \param startTime start time
+      \param endTime end time
+      \param taskGain IK task gain
+      \param preparation data prepared by prepare()
+  */
+  SwingTrajQuinticSimple(const SwingCommand::Type & commandType,
+                         bool isContact,
+                         const sva::PTransformd & startPose,
+                         const sva::PTransformd & endPose,
+                         double startTime,
+                         double endTime,
+                         const TaskGain & taskGain,
+                         const std::shared_ptr<const Preparation> & preparation);
+
+  /** \brief Get type of limb swing trajectory. */
+  inline virtual std::string type() const override
+  {
+    return "QuinticSimple";
+  }
+
+  /** \brief Calculate the pose of the swing trajectory at a specified time.
+      \param t time
+  */
+  virtual sva::PTransformd pose(double t) const override;
+
+  /** \brief Calculate the velocity of the swing trajectory at a specified time.
+      \param t time
+  */
+  virtual sva::MotionVecd vel(double t) const override;
+
+  /** \brief Calculate the acceleration of the swing trajectory at a specified time.
+      \param t time
+  */
+  virtual sva::MotionVecd accel(double t) const override;
+
+  /** \brief Calculate the IK task gain of the swing trajectory at a specified time.
+      \param t time
+  */
+  virtual TaskGain taskGain(double t) const override;
+
+  /** \brief Const accessor to the configuration. */
+  inline virtual const Configuration & config() const override
+  {
+    return config_;
+  }
+
+protected:
+  /** \brief Quintic polynomial segment of position. */
+  struct QuinticSegment
+  {
+    /** \brief Set the polynomial from the boundary conditions.
+        \param _startTime start time
+        \param _endTime end time
+        \param startPos start position
+        \param startVel start velocity
+        \param startAccel start acceleration
+        \param endPos end position
+        \param endVel end velocity
+        \param endAccel end acceleration
+     */
+    void set(double _startTime,
+             double _endTime,
+             const Eigen::Vector3d & startPos,
+             const Eigen::Vector3d & startVel,
+             const Eigen::Vector3d & startAccel,
+             const Eigen::Vector3d & endPos,
+             const Eigen::Vector3d & endVel,
+             const Eigen::Vector3d & endAccel);
+
+    /** \brief Calculate the derivative of the position.
+        \param t time (clamped to the segment)
+        \param order derivative order (0 for the position, 1 for the velocity, and 2 for the acceleration)
+     */
+    Eigen::Vector3d derivative(double t, int order) const;
+
+    //! Start time [sec]
+    double startTime = 0;
+
+    //! End time [sec]
+    double endTime = 0;
+
+    //! Coefficients (the i-th column is the coefficient of the i-th power of the normalized time)
+    Eigen::Matrix<double, 3, 6> coeff = Eigen::Matrix<double, 3, 6>::Zero();
+  };
+
+  /** \brief Minimum-jerk time scaling and its derivatives. */
+  struct TimeScale
+  {
+    //! Scale from 0 to 1
+    double value;
+
+    //! First-order derivative of scale
+    double vel;
+
+    //! Second-order derivative of scale
+    double accel;
+  };
+
+protected:
+  /** \brief Accessor to the configuration. */
+  inline virtual Configuration & config() override
+  {
+    return config_;
+  }
+
+  /** \brief Calculate the sample of the swing trajectory at a specified time.
+      \param t time
+      \param sample sample to set
+  */
+  virtual void calcSample(double t, Sample & sample) const override;
+
+  /** \brief Calculate minimum-jerk time scaling.
+      \param t time
+      \param startTime start time of scaling
+      \param endTime end time of scaling
+
+      The scale is 0 before the start time and 1 after the end time.
+   */
+  static TimeScale calcTimeScale(double t, double startTime, double endTime);
+
+  /** \brief Get the position segment at a specified time.
+      \param t time
+   */
+  const QuinticSegment & posSegment(double t) const;
+
+  /** \brief Calculate the rotation (represented in world frame) at a specified time.
+      \param scale rotation time scale
+   */
+  Eigen::Matrix3d calcRot(const TimeScale & scale) const;
+
+protected:
+  //! Configuration
+  Configuration config_ = defaultConfig_;
+
+  //! Position segments
+  std::array<QuinticSegment, 4> posSegments_;
+
+  //! Number of valid position segments
+  int posSegmentNum_ = 0;
+
+  //! Rotation at the start of the rotation interpolation (represented in world frame)
+  Eigen::Matrix3d rotStart_ = Eigen::Matrix3d::Identity();
+
+  //! Rotation axis from the start rotation to the end rotation (represented in the start rotation frame)
+  Eigen::Vector3d rotAxis_ = Eigen::Vector3d::UnitZ();
+
+  //! Rotation angle from the start rotation to the end rotation [rad]
+  double rotAngle_ = 0;
+
+  //! Start time of rotation interpolation [sec]
+  double rotStartTime_ = 0;
+
+  //! End time of rotation interpolation [sec]
+  double rotEndTime_ = 0;
+
+  //! Start time of stiffness transition from one to zero [sec] (only for removing swing command)
+  double stiffnessStartTime_ = 0;
+
+  //! End time of stiffness transition from one to zero [sec] (only for removing swing command)
+  double stiffnessEndTime_ = 0;
+};
+} // namespace MCC
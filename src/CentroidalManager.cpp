@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cmath>
+#include <sstream>
 
+#include <mc_rbdyn/RobotFrame.h>
 #include <mc_rtc/gui/ArrayInput.h>
 #include <mc_rtc/gui/Button.h>
 #include <mc_rtc/gui/Checkbox.h>
@@ -11,22 +14,68 @@
 #include <mc_tasks/MomentumTask.h>
 #include <mc_tasks/OrientationTask.h>
 
+#include <CCC/Constants.h>
+
+#include <ForceColl/Contact.h>
 #include <ForceColl/WrenchDistribution.h>
 
 #include <MultiContactController/CentroidalManager.h>
 #include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MathUtils.h>
 #include <MultiContactController/MultiContactController.h>
+#include <MultiContactController/RealTimeProfile.h>
+#include <MultiContactController/StageTimer.h>
 
 using namespace MCC;
 
+namespace
+{
+/** \brief Convert string to enumerator.
+    \param strToEnumMap map from string to enumerator
+    \param str string
+    \param entryName name of configuration entry
+ */
+template<class EnumType>
+EnumType strToEnum(const std::unordered_map<std::string, EnumType> & strToEnumMap,
+                   const std::string & str,
+                   const std::string & entryName)
+{
+  auto it = strToEnumMap.find(str);
+  if(it == strToEnumMap.end())
+  {
+    mc_rtc::log::error_and_throw("[CentroidalManager] Invalid {}: {}", entryName, str);
+  }
+  return it->second;
+}
+
+/** \brief Convert enumerator to string.
+    \param strToEnumMap map from string to enumerator
+    \param value enumerator
+ */
+template<class EnumType>
+const std::string & enumToStr(const std::unordered_map<std::string, EnumType> & strToEnumMap, EnumType value)
+{
+  return std::find_if(strToEnumMap.begin(), strToEnumMap.end(), [&](const auto & kv) { return kv.second == value; })
+      ->first;
+}
+} // namespace
+
 void CentroidalManager::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
 {
   mcRtcConfig("name", name);
   mcRtcConfig("method", method);
   mcRtcConfig("nominalCentroidalPose", nominalCentroidalPose);
-  mcRtcConfig("nominalCentroidalPoseBaseFrame", nominalCentroidalPoseBaseFrame);
-  mcRtcConfig("refComZPolicy", refComZPolicy);
+  if(mcRtcConfig.has("nominalCentroidalPoseBaseFrame"))
+  {
+    nominalCentroidalPoseBaseFrame = strToEnum(strToNominalCentroidalPoseBaseFrame,
+                                               static_cast<std::string>(mcRtcConfig("nominalCentroidalPoseBaseFrame")),
+                                               "nominalCentroidalPoseBaseFrame");
+  }
+  if(mcRtcConfig.has("refComZPolicy"))
+  {
+    refComZPolicy =
+        strToEnum(strToRefComZPolicy, static_cast<std::string>(mcRtcConfig("refComZPolicy")), "refComZPolicy");
+  }
   if(mcRtcConfig.has("limbWeightListForRefData"))
   {
     limbWeightListForRefData.clear();
@@ -59,26 +108,47 @@ void CentroidalManager::Configuration::load(const mc_rtc::Configuration & mcRtcC
   mcRtcConfig("lowPassCutoffPeriod", lowPassCutoffPeriod);
   mcRtcConfig("useActualStateForMpc", useActualStateForMpc);
   mcRtcConfig("enableCentroidalFeedback", enableCentroidalFeedback);
+  mcRtcConfig("enableAsyncMpc", enableAsyncMpc);
+  mcRtcConfig("enableSpeculativeMpc", enableSpeculativeMpc);
+  if(enableSpeculativeMpc && !enableAsyncMpc)
+  {
+    mc_rtc::log::error_and_throw("[CentroidalManager] enableSpeculativeMpc requires enableAsyncMpc.");
+  }
+  mcRtcConfig("mpcPeriod", mpcPeriod);
+  if(mpcPeriod < 1)
+  {
+    mc_rtc::log::error_and_throw("[CentroidalManager] mpcPeriod must be positive: {}", mpcPeriod);
+  }
+  mcRtcConfig("refDataRecalcNumPerCycle", refDataRecalcNumPerCycle);
   mcRtcConfig("useTargetPoseForControlRobotAnchorFrame", useTargetPoseForControlRobotAnchorFrame);
   mcRtcConfig("useActualComForWrenchDist", useActualComForWrenchDist);
   mcRtcConfig("actualComOffset", actualComOffset);
   mcRtcConfig("wrenchDistConfig", wrenchDistConfig);
+  mcRtcConfig("wrenchDistCacheSize", wrenchDistCacheSize);
 }
 
 void CentroidalManager::Configuration::addToLogger(const std::string & baseEntry, mc_rtc::Logger & logger)
 {
   MC_RTC_LOG_HELPER(baseEntry + "_method", method);
   MC_RTC_LOG_HELPER(baseEntry + "_nominalCentroidalPose", nominalCentroidalPose);
-  MC_RTC_LOG_HELPER(baseEntry + "_nominalCentroidalPoseBaseFrame", nominalCentroidalPoseBaseFrame);
-  MC_RTC_LOG_HELPER(baseEntry + "_refComZPolicy", refComZPolicy);
+  logger.addLogEntry(baseEntry + "_nominalCentroidalPoseBaseFrame", this, [this]() -> const std::string & {
+    return enumToStr(strToNominalCentroidalPoseBaseFrame, nominalCentroidalPoseBaseFrame);
+  });
+  logger.addLogEntry(baseEntry + "_refComZPolicy", this,
+                     [this]() -> const std::string & { return enumToStr(strToRefComZPolicy, refComZPolicy); });
   MC_RTC_LOG_HELPER(baseEntry + "_centroidalGainP", centroidalGainP);
   MC_RTC_LOG_HELPER(baseEntry + "_centroidalGainD", centroidalGainD);
   MC_RTC_LOG_HELPER(baseEntry + "_lowPassCutoffPeriod", lowPassCutoffPeriod);
   MC_RTC_LOG_HELPER(baseEntry + "_useActualStateForMpc", useActualStateForMpc);
   MC_RTC_LOG_HELPER(baseEntry + "_enableCentroidalFeedback", enableCentroidalFeedback);
+  MC_RTC_LOG_HELPER(baseEntry + "_enableAsyncMpc", enableAsyncMpc);
+  MC_RTC_LOG_HELPER(baseEntry + "_enableSpeculativeMpc", enableSpeculativeMpc);
+  MC_RTC_LOG_HELPER(baseEntry + "_mpcPeriod", mpcPeriod);
+  MC_RTC_LOG_HELPER(baseEntry + "_refDataRecalcNumPerCycle", refDataRecalcNumPerCycle);
   MC_RTC_LOG_HELPER(baseEntry + "_useTargetPoseForControlRobotAnchorFrame", useTargetPoseForControlRobotAnchorFrame);
   MC_RTC_LOG_HELPER(baseEntry + "_useActualComForWrenchDist", useActualComForWrenchDist);
   MC_RTC_LOG_HELPER(baseEntry + "_actualComOffset", actualComOffset);
+  MC_RTC_LOG_HELPER(baseEntry + "_wrenchDistCacheSize", wrenchDistCacheSize);
 }
 
 void CentroidalManager::Configuration::removeFromLogger(mc_rtc::Logger & logger)
@@ -86,6 +156,55 @@ void CentroidalManager::Configuration::removeFromLogger(mc_rtc::Logger & logger)
   logger.removeLogEntries(this);
 }
 
+void CentroidalManager::MpcDegradation::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  mcRtcConfig("ddpMaxIter", ddpMaxIter);
+  mcRtcConfig("horizonDt", horizonDt);
+  mcRtcConfig("horizonDuration", horizonDuration);
+  mcRtcConfig("reusePreviousPlan", reusePreviousPlan);
+}
+
+void CentroidalManager::MpcDegradation::merge(const MpcDegradation & other)
+{
+  if(other.ddpMaxIter > 0)
+  {
+    ddpMaxIter = (ddpMaxIter > 0 ? std::min(ddpMaxIter, other.ddpMaxIter) : other.ddpMaxIter);
+  }
+  horizonDt = std::max(horizonDt, other.horizonDt);
+  if(other.horizonDuration > 0)
+  {
+    horizonDuration = (horizonDuration > 0 ? std::min(horizonDuration, other.horizonDuration) : other.horizonDuration);
+  }
+  reusePreviousPlan = reusePreviousPlan || other.reusePreviousPlan;
+}
+
+std::string CentroidalManager::MpcDegradation::description() const
+{
+  std::ostringstream ss;
+  std::string delim = "";
+  if(ddpMaxIter > 0)
+  {
+    ss << delim << "ddpMaxIter: " << ddpMaxIter;
+    delim = ", ";
+  }
+  if(horizonDt > 0)
+  {
+    ss << delim << "horizonDt: " << horizonDt;
+    delim = ", ";
+  }
+  if(horizonDuration > 0)
+  {
+    ss << delim << "horizonDuration: " << horizonDuration;
+    delim = ", ";
+  }
+  if(reusePreviousPlan)
+  {
+    ss << delim << "reusePreviousPlan";
+    delim = ", ";
+  }
+  return delim.empty() ? "None" : ss.str();
+}
+
 void CentroidalManager::ControlData::reset(const MultiContactController * const ctlPtr)
 {
   *this = ControlData();
@@ -143,12 +262,27 @@ void CentroidalManager::RefData::removeFromLogger(mc_rtc::Logger & logger)
   logger.removeLogEntries(this);
 }
 
+int CentroidalManager::MpcData::nodeIdx(double _t) const
+{
+  int nodeNum = static_cast<int>(refDataSeq.size());
+  if(nodeNum == 0)
+  {
+    mc_rtc::log::error_and_throw("[CentroidalManager] MpcData is empty in nodeIdx.");
+  }
+  return std::clamp(static_cast<int>(std::round((_t - t) / horizonDt)), 0, nodeNum - 1);
+}
+
 CentroidalManager::CentroidalManager(MultiContactController * ctlPtr, const mc_rtc::Configuration & // mcRtcConfig
                                      )
 : ctlPtr_(ctlPtr)
 {
 }
 
+CentroidalManager::~CentroidalManager()
+{
+  stopMpcWorkers();
+}
+
 void CentroidalManager::reset(const mc_rtc::Configuration & nominalCentroidalPoseConfig)
 {
   config().nominalCentroidalPose = static_cast<sva::PTransformd>(nominalCentroidalPoseConfig);
@@ -157,6 +291,8 @@ void CentroidalManager::reset(const mc_rtc::Configuration & nominalCentroidalPos
 
 void CentroidalManager::reset()
 {
+  stopMpcWorkers();
+
   refData_.reset();
   controlData_.reset(ctlPtr_);
 
@@ -177,41 +313,129 @@ void CentroidalManager::reset()
   lowPass_.reset(sva::MotionVecd::Zero());
 
   nominalCentroidalPoseList_.emplace(ctl().t(), config().nominalCentroidalPose);
+
+  wrenchDistCache_.clear();
+
+  // Resolve the limb frames and the body once, so that the control loop does not look up them by name
+  controlLimbFrameVec_.assign(Limb::idNum(), nullptr);
+  realLimbFrameVec_.assign(Limb::idNum(), nullptr);
+  for(const auto & limbTaskKV : ctl().limbTasks_)
+  {
+    controlLimbFrameVec_[limbTaskKV.first.id] = &ctl().robot().frame(limbTaskKV.second->frame().name());
+    realLimbFrameVec_[limbTaskKV.first.id] = &ctl().realRobot().frame(limbTaskKV.second->frame().name());
+  }
+  realBaseOriBodyIdx_ = ctl().realRobot().bodyIndexByName(ctl().baseOriTask_->frame_->body());
+  limbTargetWrenchVec_.assign(Limb::idNum(), sva::ForceVecd::Zero());
+
+  refDataBuffer_.clear();
+  refDataCursor_.assign(Limb::idNum(), LimbManager::QueryCursor());
+  refDataBufferCursor_.assign(Limb::idNum(), LimbManager::QueryCursor());
+  refDataBufferHead_ = 0;
+  refDataBufferValidNum_ = 0;
+  refDataBufferInvalidTime_ = std::numeric_limits<double>::infinity();
+  refDataBufferStaleStartTick_ = 0;
+  refDataBufferStaleEndTick_ = 0;
+  ctl().limbManagerSet_->clearCommandChangedTime();
+
+  mpcData_ = MpcData();
+  mpcElapsedCycles_ = config().mpcPeriod; // Solve MPC in the first control cycle
+  solverHorizonList_.clear();
+  std::vector<MpcDegradation> mpcDegradationList = mpcDegradationCandidates_;
+  mpcDegradationList.push_back(mpcDegradation_);
+  for(const auto & mpcDegradation : mpcDegradationList)
+  {
+    if(std::none_of(solverHorizonList_.begin(), solverHorizonList_.end(),
+                    [&](const MpcDegradation & solverHorizon) { return solverHorizon.hasSameHorizon(mpcDegradation); }))
+    {
+      solverHorizonList_.push_back(mpcDegradation);
+    }
+  }
+  if(config().enableAsyncMpc)
+  {
+    startMpcWorkers();
+    if(ctl().realTimeProfile_->config().enabled)
+    {
+      ctl().realTimeProfile_->applyToWorkerThreads(mpcWorkerNativeHandles(), "MPC worker thread");
+    }
+  }
 }
 
 void CentroidalManager::update()
+{
+  updateActualState();
+  updateControl();
+}
+
+void CentroidalManager::updateActualState()
+{
+  controlData_.actualCentroidalPose.translation() = actualCom();
+  controlData_.actualCentroidalPose.rotation() = ctl().realRobot().bodyPosW()[realBaseOriBodyIdx_].rotation();
+  if(lowPass_.cutoffPeriod() != config().lowPassCutoffPeriod)
+  {
+    lowPass_.cutoffPeriod(config().lowPassCutoffPeriod);
+  }
+  lowPass_.update(
+      sva::MotionVecd(ctl().realRobot().bodyVelW()[realBaseOriBodyIdx_].angular(), ctl().realRobot().comVelocity()));
+  controlData_.actualCentroidalVel = lowPass_.eval();
+  controlData_.actualCentroidalMomentum = rbd::computeCentroidalMomentum(
+      ctl().realRobot().mb(), ctl().realRobot().mbc(), controlData_.actualCentroidalPose.translation());
+  controlData_.actualCentroidalWrench = sva::ForceVecd::Zero();
+  for(const auto & limbTaskKV : ctl().limbTasks_)
+  {
+    sva::PTransformd limbPoseFromCom = realLimbFrameVec_[limbTaskKV.first.id]->position()
+                                       * sva::PTransformd(controlData_.actualCentroidalPose.translation()).inv();
+    controlData_.actualCentroidalWrench += limbPoseFromCom.transMul(limbTaskKV.second->measuredWrench());
+  }
+}
+
+void CentroidalManager::updateControl()
 {
   // Set data
-  refData_ = calcRefData(ctl().t());
   {
-    const auto & baseOriLinkName = ctl().baseOriTask_->frame_->body();
-    controlData_.actualCentroidalPose.translation() = actualCom();
-    controlData_.actualCentroidalPose.rotation() = ctl().realRobot().bodyPosW(baseOriLinkName).rotation();
-    if(lowPass_.cutoffPeriod() != config().lowPassCutoffPeriod)
+    MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, RefData);
+
+    refData_ = calcRefData(ctl().t(), refDataCursor_);
+    controlData_.setMpcState(config().useActualStateForMpc);
+    updateRefDataBuffer();
+  }
+
+  // Run MPC
+  {
+    MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, Mpc);
+
+    // The contact schedule is rebuilt only if it does not cover the MPC horizon
+    ctl().limbManagerSet_->setContactScheduleHorizon(mpcHorizonSteps() * mpcHorizonDt());
+
+    // If MPC is degraded to reuse the previous plan, the previous plan is kept applied unless there is no plan
+    bool reusePreviousPlan = mpcDegradation_.reusePreviousPlan && !mpcData_.refDataSeq.empty();
+    bool requestMpc = (mpcElapsedCycles_ >= config().mpcPeriod) && !reusePreviousPlan;
+    if(config().enableAsyncMpc)
     {
-      lowPass_.cutoffPeriod(config().lowPassCutoffPeriod);
+      if(runMpcAsync(requestMpc))
+      {
+        mpcElapsedCycles_ = 0;
+      }
+      if(config().enableSpeculativeMpc)
+      {
+        adoptSpeculativeMpcData();
+      }
     }
-    lowPass_.update(
-        sva::MotionVecd(ctl().realRobot().bodyVelW(baseOriLinkName).angular(), ctl().realRobot().comVelocity()));
-    controlData_.actualCentroidalVel = lowPass_.eval();
-    controlData_.actualCentroidalMomentum = rbd::computeCentroidalMomentum(
-        ctl().realRobot().mb(), ctl().realRobot().mbc(), controlData_.actualCentroidalPose.translation());
-    controlData_.actualCentroidalWrench = sva::ForceVecd::Zero();
-    for(const auto & limbTaskKV : ctl().limbTasks_)
+    else if(requestMpc)
     {
-      sva::PTransformd limbPoseFromCom = ctl().realRobot().frame(limbTaskKV.second->frame().name()).position()
-                                         * sva::PTransformd(controlData_.actualCentroidalPose.translation()).inv();
-      controlData_.actualCentroidalWrench += limbPoseFromCom.transMul(limbTaskKV.second->measuredWrench());
+      setMpcData(mpcData_);
+      runMpc(mpcData_);
+      mpcElapsedCycles_ = 0;
     }
-  }
-  controlData_.setMpcState(config().useActualStateForMpc);
+    mpcElapsedCycles_++;
 
-  // Run MPC
-  runMpc();
+    mpcFeedbackApplied_ = false;
+    applyMpcData(mpcData_);
+  }
 
   // Apply centroidal feedback
+  // If the feedback policy of MPC has been applied, the planned centroidal wrench already reflects the actual state
   controlData_.controlCentroidalWrench = controlData_.plannedCentroidalWrench;
-  if(config().enableCentroidalFeedback)
+  if(config().enableCentroidalFeedback && !mpcFeedbackApplied_)
   {
     // sva::transformError(A, B) corresponds to (B - A).
     sva::ForceVecd deltaControlWrench =
@@ -223,9 +447,14 @@ void CentroidalManager::update()
 
   // Distribute control wrench
   {
-    contactList_ = ctl().limbManagerSet_->contactList(ctl().t());
-    wrenchDist_ = std::make_shared<ForceColl::WrenchDistribution>(ForceColl::getContactVecFromMap(contactList_),
-                                                                  config().wrenchDistConfig);
+    MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, WrenchDist);
+
+    contactSegment_ = ctl().limbManagerSet_->contactSchedule().segmentPtr(ctl().t());
+    const auto & wrenchDistEntry =
+        wrenchDistCache_.get(*contactSegment_, config().wrenchDistConfig, config().wrenchDistCacheSize);
+    wrenchDist_ = wrenchDistEntry.wrenchDist;
+    wrenchDistLimbVec_ = wrenchDistEntry.limbVec;
+    wrenchDistContactVec_ = wrenchDistEntry.contactVec;
     Eigen::Vector3d comForWrenchDist =
         (config().useActualComForWrenchDist
              ? controlData_.actualCentroidalPose.translation()
@@ -272,19 +501,18 @@ void CentroidalManager::update()
 
   // Set target wrench of limb tasks
   {
-    const auto & targetWrenchList = ForceColl::calcWrenchList(contactList_, wrenchDist_->resultWrenchRatio_);
+    const auto & targetWrenchVec = ForceColl::calcWrenchList(wrenchDistContactVec_, wrenchDist_->resultWrenchRatio_);
     for(const auto & limbManagerKV : *ctl().limbManagerSet_)
     {
-      sva::ForceVecd targetWrench;
-      if(targetWrenchList.count(limbManagerKV.first) == 0)
-      {
-        targetWrench = sva::ForceVecd::Zero();
-      }
-      else
-      {
-        targetWrench = targetWrenchList.at(limbManagerKV.first);
-      }
-      ctl().limbTasks_.at(limbManagerKV.first)->targetWrenchW(targetWrench);
+      limbTargetWrenchVec_[limbManagerKV.first.id] = sva::ForceVecd::Zero();
+    }
+    for(size_t i = 0; i < wrenchDistLimbVec_.size(); i++)
+    {
+      limbTargetWrenchVec_[wrenchDistLimbVec_[i].id] = targetWrenchVec[i];
+    }
+    for(const auto & limbManagerKV : *ctl().limbManagerSet_)
+    {
+      limbManagerKV.second->limbTask()->targetWrenchW(limbTargetWrenchVec_[limbManagerKV.first.id]);
     }
   }
 
@@ -315,13 +543,27 @@ void CentroidalManager::update()
 
   // Update force visualization
   {
+    MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, GuiMarker);
+
     ctl().gui()->removeCategory({ctl().name(), config().name, "ForceMarker"});
     wrenchDist_->addToGUI(*ctl().gui(), {ctl().name(), config().name, "ForceMarker"});
   }
 }
 
+void CentroidalManager::setMpcDegradation(const MpcDegradation & mpcDegradation)
+{
+  if(!solverHorizonList_.empty())
+  {
+    // Throw in the control thread instead of in runMpc
+    solverHorizonIdx(mpcDegradation);
+  }
+  mpcDegradation_ = mpcDegradation;
+}
+
 void CentroidalManager::stop()
 {
+  stopMpcWorkers();
+
   removeFromGUI(*ctl().gui());
   removeFromLogger(ctl().logger());
 }
@@ -341,14 +583,28 @@ void CentroidalManager::addToGUI(mc_rtc::gui::StateBuilder & gui)
   gui.addElement(
       {ctl().name(), config().name, "Config"},
       mc_rtc::gui::Label("method", [this]() -> const std::string & { return config().method; }),
+      mc_rtc::gui::Label("enableAsyncMpc", [this]() { return config().enableAsyncMpc; }),
+      mc_rtc::gui::Label("enableSpeculativeMpc", [this]() { return config().enableSpeculativeMpc; }),
+      mc_rtc::gui::Label("mpcPeriod", [this]() { return config().mpcPeriod; }),
       mc_rtc::gui::ComboInput(
           "nominalCentroidalPoseBaseFrame", {"LimbAveragePose", "World"},
-          [this]() -> const std::string & { return config().nominalCentroidalPoseBaseFrame; },
-          [this](const std::string & v) { config().nominalCentroidalPoseBaseFrame = v; }),
+          [this]() -> const std::string & {
+            return enumToStr(Configuration::strToNominalCentroidalPoseBaseFrame,
+                             config().nominalCentroidalPoseBaseFrame);
+          },
+          [this](const std::string & v) {
+            config().nominalCentroidalPoseBaseFrame = Configuration::strToNominalCentroidalPoseBaseFrame.at(v);
+            invalidateRefDataBuffer(ctl().t());
+          }),
       mc_rtc::gui::ComboInput(
           "refComZPolicy", {"Average", "Constant", "Min", "Max"},
-          [this]() -> const std::string & { return config().refComZPolicy; },
-          [this](const std::string & v) { config().refComZPolicy = v; }),
+          [this]() -> const std::string & {
+            return enumToStr(Configuration::strToRefComZPolicy, config().refComZPolicy);
+          },
+          [this](const std::string & v) {
+            config().refComZPolicy = Configuration::strToRefComZPolicy.at(v);
+            invalidateRefDataBuffer(ctl().t());
+          }),
       mc_rtc::gui::ArrayInput(
           "Centroidal P-Gain", {"ax", "ay", "az", "lx", "ly", "lz"},
           [this]() -> const sva::ImpedanceVecd & { return config().centroidalGainP; },
@@ -483,6 +739,7 @@ bool CentroidalManager::appendNominalCentroidalPose(double t, const sva::PTransf
   }
 
   nominalCentroidalPoseList_.emplace(t, nominalCentroidalPose);
+  invalidateRefDataBuffer(t);
 
   return true;
 }
@@ -506,24 +763,432 @@ bool CentroidalManager::isFinished(const double t) const
   return t > nominalCentroidalPoseList_.rbegin()->first;
 }
 
-CentroidalManager::RefData CentroidalManager::calcRefData(double t) const
+void CentroidalManager::setMpcData(MpcData & mpcData) const
+{
+  mpcData.t = ctl().t();
+  mpcData.horizonDt = mpcHorizonDt();
+  mpcData.degradation = mpcDegradation_;
+  mpcData.requireFeedbackGain = requireFeedbackGain();
+  mpcData.controlData = controlData_;
+  mpcData.refData = refData_;
+
+  mpcData.contactSchedule = ctl().limbManagerSet_->contactSchedule();
+
+  int nodeNum = mpcHorizonSteps() + 1;
+  mpcData.refDataSeq.resize(nodeNum);
+  RefDataCursor refDataCursor(Limb::idNum());
+  for(int i = 0; i < nodeNum; i++)
+  {
+    if(refDataBufferTicksPerNode_ > 0)
+    {
+      // The stale elements of the buffer are calculated directly
+      long long tick = refDataBufferStartTick_ + i * refDataBufferTicksPerNode_;
+      if(isRefDataBufferStale(tick))
+      {
+        mpcData.refDataSeq[i] = calcRefData(calcRefDataBufferTime(tick), refDataCursor);
+      }
+      else
+      {
+        int bufferIdx =
+            (refDataBufferHead_ + i * refDataBufferTicksPerNode_) % static_cast<int>(refDataBuffer_.size());
+        mpcData.refDataSeq[i] = refDataBuffer_[bufferIdx];
+      }
+    }
+    else
+    {
+      mpcData.refDataSeq[i] = calcRefData(mpcData.t + i * mpcData.horizonDt, refDataCursor);
+    }
+  }
+}
+
+void CentroidalManager::applyMpcData(const MpcData & mpcData)
+{
+  controlData_.plannedCentroidalAccel = mpcData.controlData.plannedCentroidalAccel;
+  controlData_.plannedCentroidalMomentum = mpcData.controlData.plannedCentroidalMomentum;
+  controlData_.plannedCentroidalWrench = mpcData.controlData.plannedCentroidalWrench;
+
+  double elapsedDuration = ctl().t() - mpcData.t;
+  if(elapsedDuration <= 0)
+  {
+    return;
+  }
+
+  // Interpolate the planned trajectory at the specified node position
+  auto interpolateSeq = [](const std::vector<sva::ForceVecd> & seq, double nodePos) {
+    nodePos = std::clamp(nodePos, 0.0, static_cast<double>(seq.size() - 1));
+    int nodeIdx = std::min(static_cast<int>(std::floor(nodePos)), static_cast<int>(seq.size()) - 1);
+    if(nodeIdx + 1 == static_cast<int>(seq.size()))
+    {
+      return seq[nodeIdx];
+    }
+    double ratio = nodePos - nodeIdx;
+    return sva::ForceVecd((1.0 - ratio) * seq[nodeIdx].vector() + ratio * seq[nodeIdx + 1].vector());
+  };
+  double elapsedNodeNum = elapsedDuration / mpcData.horizonDt;
+
+  if(!mpcData.plannedWrenchSeq.empty())
+  {
+    controlData_.plannedCentroidalWrench = interpolateSeq(mpcData.plannedWrenchSeq, elapsedNodeNum);
+    controlData_.plannedCentroidalAccel.linear() =
+        controlData_.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  }
+
+  if(!mpcData.plannedMomentumSeq.empty())
+  {
+    // The planned momentum taken from MPC corresponds to the first node after the start of MPC
+    controlData_.plannedCentroidalMomentum = interpolateSeq(mpcData.plannedMomentumSeq, 1.0 + elapsedNodeNum);
+  }
+  else
+  {
+    // Extrapolate momentum assuming that the planned wrench is kept constant
+    controlData_.plannedCentroidalMomentum.force() +=
+        elapsedDuration
+        * (controlData_.plannedCentroidalWrench.force() - robotMass_ * Eigen::Vector3d(0.0, 0.0, CCC::constants::g));
+    controlData_.plannedCentroidalMomentum.moment() += elapsedDuration * controlData_.plannedCentroidalWrench.moment();
+  }
+
+  // The planned angular acceleration is recalculated every control cycle in the same manner as the linear one
+  controlData_.plannedCentroidalAccel.angular() = calcPlannedCentroidalAngularAccel(controlData_, refData_);
+}
+
+Eigen::Vector3d CentroidalManager::calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                                     const RefData & // refData
+                                                                     ) const
+{
+  return controlData.plannedCentroidalWrench.moment().cwiseQuotient(robotInertiaMat_.diagonal());
+}
+
+bool CentroidalManager::runMpcAsync(bool requestMpc)
+{
+  // Request MPC to the worker if it is idle
+  bool requestMpcNow = requestMpc && requestMpcToWorker(mpcWorker_, [this](MpcData & mpcData) {
+                         setMpcData(mpcData);
+                         mpcData.speculative = false;
+                         return true;
+                       });
+
+  // Request speculative MPC from the same state if any limb is about to touch down
+  if(requestMpcNow && config().enableSpeculativeMpc)
+  {
+    requestMpcToWorker(speculativeMpcWorker_, [this](MpcData & mpcData) {
+      ContactSchedule touchDownContactSchedule;
+      if(!ctl().limbManagerSet_->calcTouchDownContactSchedule(touchDownContactSchedule))
+      {
+        return false;
+      }
+      setMpcData(mpcData);
+      mpcData.contactSchedule = std::move(touchDownContactSchedule);
+      mpcData.speculative = true;
+      return true;
+    });
+  }
+
+  // Receive the latest result (wait only for the first result since there is no plan to use yet)
+  if(receiveMpcFromWorker(mpcWorker_, mpcReceivedData_, !mpcResultReceived_))
+  {
+    // The result solved at the same time as the adopted speculative MPC is discarded since its contact set is outdated
+    if(!mpcResultReceived_ || mpcReceivedData_.t > mpcData_.t)
+    {
+      std::swap(mpcData_, mpcReceivedData_);
+    }
+    mpcResultReceived_ = true;
+  }
+  if(config().enableSpeculativeMpc && receiveMpcFromWorker(speculativeMpcWorker_, speculativeMpcData_, false))
+  {
+    speculativeMpcDataValid_ = true;
+  }
+
+  return requestMpcNow;
+}
+
+bool CentroidalManager::adoptSpeculativeMpcData()
+{
+  if(!speculativeMpcDataValid_ || speculativeMpcData_.t < mpcData_.t)
+  {
+    return false;
+  }
+
+  // Adopt the speculative MPC only when the current contact set differs from the one assumed by mpcData_ (i.e., touch
+  // down has been detected) and matches the one assumed by the speculative MPC
+  double t = ctl().t();
+  const auto & contactList = ctl().limbManagerSet_->contactSchedule().segment(t).contactList;
+  if(ContactSchedule::isSameContactList(contactList, mpcData_.contactSchedule.segment(t).contactList)
+     || !ContactSchedule::isSameContactList(contactList, speculativeMpcData_.contactSchedule.segment(t).contactList))
+  {
+    return false;
+  }
+
+  std::swap(mpcData_, speculativeMpcData_);
+  speculativeMpcDataValid_ = false;
+  return true;
+}
+
+bool CentroidalManager::requestMpcToWorker(MpcWorker & worker, const std::function<bool(MpcData &)> & setRequestData)
+{
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if(worker.requested)
+    {
+      return false;
+    }
+  }
+
+  // The worker thread does not access requestData while requested is false
+  if(!setRequestData(worker.requestData))
+  {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.requested = true;
+  }
+  worker.cond.notify_all();
+  return true;
+}
+
+size_t CentroidalManager::solverHorizonIdx(const MpcDegradation & mpcDegradation) const
+{
+  for(size_t i = 0; i < solverHorizonList_.size(); i++)
+  {
+    if(solverHorizonList_[i].hasSameHorizon(mpcDegradation))
+    {
+      return i;
+    }
+  }
+  mc_rtc::log::error_and_throw("[CentroidalManager] No solver is built for the horizon of MPC degradation ({}). Set "
+                               "the degradation in setMpcDegradationCandidates before reset.",
+                               mpcDegradation.description());
+}
+
+bool CentroidalManager::receiveMpcFromWorker(MpcWorker & worker, MpcData & mpcData, bool wait)
+{
+  std::unique_lock<std::mutex> lock(worker.mutex);
+  if(wait)
+  {
+    worker.cond.wait(lock, [&worker]() { return worker.resultUpdated || worker.exception; });
+  }
+  if(worker.exception)
+  {
+    std::exception_ptr exception = worker.exception;
+    worker.exception = nullptr;
+    std::rethrow_exception(exception);
+  }
+  if(!worker.resultUpdated)
+  {
+    return false;
+  }
+  std::swap(mpcData, worker.resultData);
+  worker.resultUpdated = false;
+  return true;
+}
+
+void CentroidalManager::startMpcWorkers()
+{
+  stopMpcWorkers();
+
+  mpcResultReceived_ = false;
+  speculativeMpcDataValid_ = false;
+  for(MpcWorker * worker : {&mpcWorker_, &speculativeMpcWorker_})
+  {
+    if(worker == &speculativeMpcWorker_ && !config().enableSpeculativeMpc)
+    {
+      continue;
+    }
+    worker->requested = false;
+    worker->resultUpdated = false;
+    worker->stopRequested = false;
+    worker->exception = nullptr;
+    worker->thread = std::thread(&CentroidalManager::mpcWorkerLoop, this, std::ref(*worker));
+  }
+}
+
+std::vector<pthread_t> CentroidalManager::mpcWorkerNativeHandles()
+{
+  std::vector<pthread_t> nativeHandles;
+  for(MpcWorker * worker : {&mpcWorker_, &speculativeMpcWorker_})
+  {
+    if(worker->thread.joinable())
+    {
+      nativeHandles.push_back(worker->thread.native_handle());
+    }
+  }
+  return nativeHandles;
+}
+
+void CentroidalManager::stopMpcWorkers()
+{
+  stopMpcWorker(mpcWorker_);
+  stopMpcWorker(speculativeMpcWorker_);
+}
+
+void CentroidalManager::stopMpcWorker(MpcWorker & worker)
+{
+  if(!worker.thread.joinable())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.stopRequested = true;
+  }
+  worker.cond.notify_all();
+  worker.thread.join();
+}
+
+void CentroidalManager::mpcWorkerLoop(MpcWorker & worker)
+{
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(worker.mutex);
+      worker.cond.wait(lock, [&worker]() { return worker.requested || worker.stopRequested; });
+      if(worker.stopRequested)
+      {
+        return;
+      }
+      // Swap instead of copy; threadData itself is kept as the object referred to by the MPC solver
+      std::swap(worker.threadData, worker.requestData);
+    }
+
+    std::exception_ptr exception = nullptr;
+    try
+    {
+      runMpc(worker.threadData);
+    }
+    catch(...)
+    {
+      exception = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if(exception)
+      {
+        worker.exception = exception;
+      }
+      else
+      {
+        std::swap(worker.resultData, worker.threadData);
+        worker.resultUpdated = true;
+      }
+      worker.requested = false;
+    }
+    worker.cond.notify_all();
+  }
+}
+
+CentroidalManager::RefData CentroidalManager::calcRefData(double t, RefDataCursor & cursor) const
 {
   RefData refData;
 
   sva::PTransformd nominalCentroidalPose = getNominalCentroidalPose(t);
-  if(config().nominalCentroidalPoseBaseFrame == "World")
+  if(config().nominalCentroidalPoseBaseFrame == Configuration::NominalCentroidalPoseBaseFrame::World)
   {
     refData.centroidalPose = nominalCentroidalPose;
   }
-  else // if(config().nominalCentroidalPoseBaseFrame == "LimbAveragePose")
+  else // if(config().nominalCentroidalPoseBaseFrame == Configuration::NominalCentroidalPoseBaseFrame::LimbAveragePose)
   {
-    refData.centroidalPose = nominalCentroidalPose * projGround(calcLimbAveragePoseForRefData(t, false), false);
+    refData.centroidalPose = nominalCentroidalPose * projGround(calcLimbAveragePoseForRefData(t, false, cursor), false);
   }
 
   return refData;
 }
 
-sva::PTransformd CentroidalManager::calcLimbAveragePoseForRefData(double t, bool recursive) const
+void CentroidalManager::updateRefDataBuffer()
+{
+  // Invalidate elements affected by the change of limb commands
+  invalidateRefDataBuffer(ctl().limbManagerSet_->commandChangedTime());
+  ctl().limbManagerSet_->clearCommandChangedTime();
+
+  // The buffer is not used if MPC horizon nodes are not on the control time grid
+  double dt = ctl().dt();
+  double ticksPerNode = mpcHorizonDt() / dt;
+  int ticksPerNodeInt = static_cast<int>(std::round(ticksPerNode));
+  if(ticksPerNodeInt < 1 || std::abs(ticksPerNode - ticksPerNodeInt) > 1e-6)
+  {
+    refDataBufferTicksPerNode_ = 0;
+    refDataBufferValidNum_ = 0;
+    refDataBufferInvalidTime_ = std::numeric_limits<double>::infinity();
+    refDataBufferStaleEndTick_ = refDataBufferStaleStartTick_;
+    return;
+  }
+  refDataBufferTicksPerNode_ = ticksPerNodeInt;
+  int bufferSize = mpcHorizonSteps() * ticksPerNodeInt + 1;
+  if(static_cast<int>(refDataBuffer_.size()) != bufferSize)
+  {
+    refDataBuffer_.resize(bufferSize);
+    refDataBufferValidNum_ = 0;
+  }
+
+  // Mark invalidated elements as stale
+  if(refDataBufferInvalidTime_ < std::numeric_limits<double>::infinity())
+  {
+    // Conservatively invalidate from the control tick just before the invalid time
+    long long invalidTick = std::max(static_cast<long long>(std::floor(refDataBufferInvalidTime_ / dt)),
+                                     refDataBufferStartTick_);
+    long long validEndTick = refDataBufferStartTick_ + refDataBufferValidNum_;
+    if(invalidTick < validEndTick)
+    {
+      if(refDataBufferStaleStartTick_ < refDataBufferStaleEndTick_)
+      {
+        invalidTick = std::min(invalidTick, refDataBufferStaleStartTick_);
+      }
+      refDataBufferStaleStartTick_ = invalidTick;
+      refDataBufferStaleEndTick_ = validEndTick;
+    }
+    refDataBufferInvalidTime_ = std::numeric_limits<double>::infinity();
+  }
+
+  // Shift the buffer to the current control tick
+  long long currentTick = std::llround(ctl().t() / dt);
+  if(currentTick < refDataBufferStartTick_ || currentTick - refDataBufferStartTick_ >= refDataBufferValidNum_)
+  {
+    refDataBufferHead_ = 0;
+    refDataBufferValidNum_ = 0;
+  }
+  else
+  {
+    int shiftNum = static_cast<int>(currentTick - refDataBufferStartTick_);
+    refDataBufferHead_ = (refDataBufferHead_ + shiftNum) % bufferSize;
+    refDataBufferValidNum_ -= shiftNum;
+  }
+  refDataBufferStartTick_ = currentTick;
+  refDataBufferStaleStartTick_ = std::max(refDataBufferStaleStartTick_, currentTick);
+  refDataBufferStaleEndTick_ = std::min(refDataBufferStaleEndTick_, currentTick + refDataBufferValidNum_);
+
+  // Calculate the newly exposed elements
+  for(; refDataBufferValidNum_ < bufferSize; refDataBufferValidNum_++)
+  {
+    int bufferIdx = (refDataBufferHead_ + refDataBufferValidNum_) % bufferSize;
+    refDataBuffer_[bufferIdx] =
+        calcRefData(calcRefDataBufferTime(refDataBufferStartTick_ + refDataBufferValidNum_), refDataBufferCursor_);
+  }
+
+  // Recalculate the stale elements from the front
+  long long staleEndTick = refDataBufferStaleEndTick_;
+  if(config().refDataRecalcNumPerCycle > 0)
+  {
+    staleEndTick = std::min(staleEndTick, refDataBufferStaleStartTick_ + config().refDataRecalcNumPerCycle);
+  }
+  RefDataCursor staleCursor(Limb::idNum());
+  for(; refDataBufferStaleStartTick_ < staleEndTick; refDataBufferStaleStartTick_++)
+  {
+    int bufferIdx = static_cast<int>((refDataBufferHead_ + refDataBufferStaleStartTick_ - refDataBufferStartTick_)
+                                     % bufferSize);
+    refDataBuffer_[bufferIdx] = calcRefData(calcRefDataBufferTime(refDataBufferStaleStartTick_), staleCursor);
+  }
+}
+
+double CentroidalManager::calcRefDataBufferTime(long long tick) const
+{
+  // Clamp the time of the first element so that it does not precede the current time due to rounding
+  return std::max(static_cast<double>(tick) * ctl().dt(), ctl().t());
+}
+
+sva::PTransformd CentroidalManager::calcLimbAveragePoseForRefData(double t,
+                                                                  bool recursive,
+                                                                  RefDataCursor & cursor) const
 {
   // Set weightPoseList
   std::vector<std::pair<double, sva::PTransformd>> weightPoseList;
@@ -534,34 +1199,36 @@ sva::PTransformd CentroidalManager::calcLimbAveragePoseForRefData(double t, bool
       continue;
     }
 
-    double weight =
-        config().limbWeightListForRefData.at(limbManagerKV.first) * limbManagerKV.second->getContactWeight(t);
+    auto & limbCursor = cursor[limbManagerKV.first.id];
+    double weight = config().limbWeightListForRefData.at(limbManagerKV.first)
+                    * limbManagerKV.second->getContactWeight(t, limbCursor);
     if(weight < std::numeric_limits<double>::min())
     {
       continue;
     }
 
-    weightPoseList.emplace_back(weight, limbManagerKV.second->getLimbPose(t));
+    weightPoseList.emplace_back(weight, limbManagerKV.second->getLimbPose(t, limbCursor));
   }
 
   // Calculate average pose
   if(weightPoseList.size() > 0)
   {
     sva::PTransformd averagePose = calcWeightedAveragePose(weightPoseList);
-    if(config().refComZPolicy == "Constant")
+    if(config().refComZPolicy == Configuration::RefComZPolicy::Constant)
     {
       averagePose.translation().z() = 0.0;
     }
-    else if(config().refComZPolicy == "Min" || config().refComZPolicy == "Max")
+    else if(config().refComZPolicy == Configuration::RefComZPolicy::Min
+            || config().refComZPolicy == Configuration::RefComZPolicy::Max)
     {
       double posZ = weightPoseList.front().second.translation().z();
       for(const auto & weightPoseKV : weightPoseList)
       {
-        if(config().refComZPolicy == "Min")
+        if(config().refComZPolicy == Configuration::RefComZPolicy::Min)
         {
           posZ = std::min(posZ, weightPoseKV.second.translation().z());
         }
-        else if(config().refComZPolicy == "Max")
+        else // if(config().refComZPolicy == Configuration::RefComZPolicy::Max)
         {
           posZ = std::max(posZ, weightPoseKV.second.translation().z());
         }
@@ -587,6 +1254,8 @@ sva::PTransformd CentroidalManager::calcLimbAveragePoseForRefData(double t, bool
     const auto & closestContactTimes = ctl().limbManagerSet_->getClosestContactTimes(t, limbs);
 
     // Calculate closestAveragePoses
+    // The closest contact times are apart from the time of the sequential calls, so separate cursors are used
+    RefDataCursor closestCursor(cursor.size());
     std::array<sva::PTransformd, 2> closestAveragePoses;
     for(int i = 0; i < 2; i++)
     {
@@ -595,7 +1264,7 @@ sva::PTransformd CentroidalManager::calcLimbAveragePoseForRefData(double t, bool
         mc_rtc::log::error_and_throw(
             "[CentroidalManager] closestContactTimes[{}] is NaN in calcLimbAveragePoseForRefData.", i);
       }
-      closestAveragePoses[i] = calcLimbAveragePoseForRefData(closestContactTimes[i], true);
+      closestAveragePoses[i] = calcLimbAveragePoseForRefData(closestContactTimes[i], true, closestCursor);
     }
 
     return sva::interpolate(closestAveragePoses[0], closestAveragePoses[1], 0.5);
@@ -617,7 +1286,7 @@ sva::PTransformd CentroidalManager::getNominalCentroidalPose(double t) const
 
 std::array<Eigen::Vector2d, 2> CentroidalManager::calcContactRegionMinMax() const
 {
-  if(contactList_.empty())
+  if(!contactSegment_ || contactSegment_->contactVec.empty())
   {
     Eigen::Vector2d pos = ctl().robot().posW().translation().head<2>();
     return {pos, pos};
@@ -625,9 +1294,9 @@ std::array<Eigen::Vector2d, 2> CentroidalManager::calcContactRegionMinMax() cons
 
   Eigen::Vector2d minPos = Eigen::Vector2d::Constant(std::numeric_limits<double>::max());
   Eigen::Vector2d maxPos = Eigen::Vector2d::Constant(std::numeric_limits<double>::lowest());
-  for(const auto & contactKV : contactList_)
+  for(const auto & contact : contactSegment_->contactVec)
   {
-    for(const auto & vertexWithRidge : contactKV.second->vertexWithRidgeList_)
+    for(const auto & vertexWithRidge : contact->vertexWithRidgeList_)
     {
       const Eigen::Vector2d & pos = vertexWithRidge.vertex.head<2>();
       minPos = minPos.cwiseMin(pos);
@@ -640,18 +1309,21 @@ std::array<Eigen::Vector2d, 2> CentroidalManager::calcContactRegionMinMax() cons
 sva::PTransformd CentroidalManager::calcAnchorFrame(const mc_rbdyn::Robot & robot) const
 {
   bool isControlRobot = (&(ctl().robot()) == &robot);
+  bool isRealRobot = (&(ctl().realRobot()) == &robot);
 
   // Set list of weight and limb pose
+  // The contact weight is zero for the limbs not in contact, so only the limbs in the contact snapshot are checked
   std::vector<std::pair<double, sva::PTransformd>> weightPoseList;
-  for(const auto & limbManagerKV : *ctl().limbManagerSet_)
+  const auto & contactSnapshot = ctl().limbManagerSet_->contactSnapshot();
+  for(size_t i = 0; i < contactSnapshot.size(); i++)
   {
-    if(config().limbWeightListForAnchorFrame.count(limbManagerKV.first) == 0)
+    const Limb & limb = contactSnapshot.limbVec[i];
+    if(config().limbWeightListForAnchorFrame.count(limb) == 0)
     {
       continue;
     }
 
-    double weight = config().limbWeightListForAnchorFrame.at(limbManagerKV.first)
-                    * limbManagerKV.second->getContactWeight(ctl().t());
+    double weight = config().limbWeightListForAnchorFrame.at(limb) * contactSnapshot.weightVec[i];
     if(weight < std::numeric_limits<double>::min())
     {
       continue;
@@ -660,11 +1332,16 @@ sva::PTransformd CentroidalManager::calcAnchorFrame(const mc_rbdyn::Robot & robo
     sva::PTransformd pose;
     if(config().useTargetPoseForControlRobotAnchorFrame && isControlRobot)
     {
-      pose = ctl().limbTasks_.at(limbManagerKV.first)->targetPose(); // target pose
+      pose = ctl().limbTasks_.at(limb)->targetPose(); // target pose
+    }
+    else if(isControlRobot || isRealRobot)
+    {
+      // robot limb pose (the frames are resolved at reset)
+      pose = (isControlRobot ? controlLimbFrameVec_ : realLimbFrameVec_)[limb.id]->position();
     }
     else
     {
-      pose = robot.frame(ctl().limbTasks_.at(limbManagerKV.first)->frame().name()).position(); // robot limb pose
+      pose = robot.frame(ctl().limbTasks_.at(limb)->frame().name()).position(); // robot limb pose
     }
     weightPoseList.emplace_back(weight, pose);
   }
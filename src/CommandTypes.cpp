@@ -3,6 +3,7 @@
 #include <ForceColl/Contact.h>
 
 #include <MultiContactController/CommandTypes.h>
+#include <MultiContactController/ContactConstraintPool.h>
 
 using namespace MCC;
 
@@ -31,7 +32,7 @@ ContactCommand::ContactCommand(double _time, const std::shared_ptr<ContactConstr
 }
 
 ContactCommand::ContactCommand(const mc_rtc::Configuration & mcRtcConfig)
-: ContactCommand(mcRtcConfig("time"), ContactConstraint::makeSharedFromConfig(mcRtcConfig("constraint")))
+: ContactCommand(mcRtcConfig("time"), ContactConstraintPool::make(mcRtcConfig("constraint")))
 {
 }
 
@@ -45,131 +46,90 @@ void GripperCommand::setBaseTime(double baseTime)
   time += baseTime;
 }
 
-StepCommand::StepCommand(const mc_rtc::Configuration & _mcRtcConfig)
+StepCommand::StepCommand(const mc_rtc::Configuration & mcRtcConfig, const std::shared_ptr<CommandArena> & arena)
 {
   // Parse according to simple/full description format
-  mc_rtc::Configuration mcRtcConfig;
-  if(_mcRtcConfig.has("swingCommand") || _mcRtcConfig.has("contactCommandList")) // full description format
+  // The commands are constructed directly by the builder without composing the intermediate configuration
+  std::string limbName = mcRtcConfig("limb");
+  if(mcRtcConfig.has("swingCommand") || mcRtcConfig.has("contactCommandList")) // full description format
   {
-    mcRtcConfig = _mcRtcConfig;
-  }
-  else // simple description format
-  {
-    const auto & type = SwingCommand::strToType.at(_mcRtcConfig("type"));
-    mcRtcConfig.add("limb", _mcRtcConfig("limb"));
-    if(type == SwingCommand::Type::Add)
-    {
-      mcRtcConfig.add("pose", _mcRtcConfig("pose"));
-    }
-    else
+    StepCommandBuilder builder = mcRtcConfig.has("pose")
+                                     ? StepCommandBuilder(limbName, static_cast<sva::PTransformd>(mcRtcConfig("pose")))
+                                     : StepCommandBuilder(limbName);
+    builder.arena(arena);
+
+    // Set SwingCommand
+    if(mcRtcConfig.has("swingCommand"))
     {
-      if(_mcRtcConfig.has("pose"))
+      const auto & swingCommandConfig = mcRtcConfig("swingCommand");
+
+      // "pose" entry is automatically set
+      const auto & type = SwingCommand::strToType.at(swingCommandConfig("type"));
+      sva::PTransformd pose = sva::PTransformd::Identity();
+      if(type == SwingCommand::Type::Add)
       {
-        mc_rtc::log::error("[StepCommand] pose entry is not used in the remove type command.");
+        pose = static_cast<sva::PTransformd>(swingCommandConfig.has("pose") ? swingCommandConfig("pose")
+                                                                             : mcRtcConfig("pose"));
       }
-      if(_mcRtcConfig.has("constraint"))
+      else
       {
-        mc_rtc::log::error("[StepCommand] constraint entry is not used in the remove type command.");
+        if(swingCommandConfig.has("pose"))
+        {
+          mc_rtc::log::error("[StepCommand] pose entry is not used in the remove type command.");
+        }
       }
+
+      builder.swing(CommandArena::makeShared<SwingCommand>(arena, type, swingCommandConfig("startTime"),
+                                                           swingCommandConfig("endTime"), pose,
+                                                           swingCommandConfig("config", mc_rtc::Configuration{})));
     }
 
-    // Add SwingCommand configuration
+    // Set ContactCommand
+    if(mcRtcConfig.has("contactCommandList"))
     {
-      mc_rtc::Configuration swingCommandConfig;
-      swingCommandConfig.add("type", _mcRtcConfig("type"));
-      swingCommandConfig.add("startTime", _mcRtcConfig("startTime"));
-      swingCommandConfig.add("endTime", _mcRtcConfig("endTime"));
-      if(_mcRtcConfig.has("swingConfig"))
+      for(const auto & contactCommandConfig : mcRtcConfig("contactCommandList"))
       {
-        swingCommandConfig.add("config", _mcRtcConfig("swingConfig"));
+        builder.contactFromConfig(contactCommandConfig("time"), contactCommandConfig("constraint"));
       }
-      mcRtcConfig.add("swingCommand", swingCommandConfig);
     }
 
-    // Add ContactCommand configuration
-    mcRtcConfig.array("contactCommandList");
-    {
-      mc_rtc::Configuration removeContactCommandConfig;
-      removeContactCommandConfig.add("time", _mcRtcConfig("startTime"));
-      removeContactCommandConfig.add_null("constraint");
-      mcRtcConfig("contactCommandList").push(removeContactCommandConfig);
-    }
-    if(type == SwingCommand::Type::Add)
+    // Set GripperCommand
+    if(mcRtcConfig.has("gripperCommandList"))
     {
-      mc_rtc::Configuration addContactCommandConfig;
-      addContactCommandConfig.add("time", _mcRtcConfig("endTime"));
-      addContactCommandConfig.add("constraint", _mcRtcConfig("constraint"));
-      mcRtcConfig("contactCommandList").push(addContactCommandConfig);
+      for(const auto & gripperCommandConfig : mcRtcConfig("gripperCommandList"))
+      {
+        builder.gripper(gripperCommandConfig("time"), gripperCommandConfig("name"), gripperCommandConfig("config"));
+      }
     }
-  }
 
-  // Set SwingCommand
-  if(mcRtcConfig.has("swingCommand"))
+    *this = builder.build();
+  }
+  else // simple description format
   {
-    mc_rtc::Configuration swingCommandConfig;
-    swingCommandConfig.load(mcRtcConfig("swingCommand")); // deep copy
-
-    // "pose" entry is automatically set
-    const auto & type = SwingCommand::strToType.at(swingCommandConfig("type"));
+    const auto & type = SwingCommand::strToType.at(mcRtcConfig("type"));
     if(type == SwingCommand::Type::Add)
     {
-      if(!swingCommandConfig.has("pose"))
-      {
-        swingCommandConfig.add("pose", mcRtcConfig("pose"));
-      }
+      *this = StepCommandBuilder(limbName, static_cast<sva::PTransformd>(mcRtcConfig("pose")))
+                  .arena(arena)
+                  .simple(type, mcRtcConfig("startTime"), mcRtcConfig("endTime"), mcRtcConfig("constraint"),
+                          mcRtcConfig("swingConfig", mc_rtc::Configuration{}))
+                  .build();
     }
     else
     {
-      if(swingCommandConfig.has("pose"))
+      if(mcRtcConfig.has("pose"))
       {
         mc_rtc::log::error("[StepCommand] pose entry is not used in the remove type command.");
       }
-    }
-
-    swingCommand = std::make_shared<SwingCommand>(swingCommandConfig);
-  }
-
-  // Set ContactCommand
-  if(mcRtcConfig.has("contactCommandList"))
-  {
-    for(const auto & _contactCommandConfig : mcRtcConfig("contactCommandList"))
-    {
-      if(_contactCommandConfig("constraint").empty())
+      if(mcRtcConfig.has("constraint"))
       {
-        contactCommandList.emplace(_contactCommandConfig("time"), nullptr);
-      }
-      else
-      {
-        mc_rtc::Configuration contactCommandConfig;
-        contactCommandConfig.load(_contactCommandConfig); // deep copy
-
-        mc_rtc::Configuration constraintConfig = contactCommandConfig("constraint");
-        // "name", "verticesName", and "pose" entries are automatically set
-        if(!constraintConfig.has("name"))
-        {
-          constraintConfig.add("name", mcRtcConfig("limb"));
-        }
-        if(!constraintConfig.has("verticesName"))
-        {
-          constraintConfig.add("verticesName", mcRtcConfig("limb"));
-        }
-        if(!constraintConfig.has("pose") && mcRtcConfig.has("pose"))
-        {
-          constraintConfig.add("pose", mcRtcConfig("pose"));
-        }
-
-        contactCommandList.emplace(contactCommandConfig("time"),
-                                   std::make_shared<ContactCommand>(contactCommandConfig));
+        mc_rtc::log::error("[StepCommand] constraint entry is not used in the remove type command.");
       }
-    }
-  }
-
-  // Set GripperCommand
-  if(mcRtcConfig.has("gripperCommandList"))
-  {
-    for(const auto & gripperCommandConfig : mcRtcConfig("gripperCommandList"))
-    {
-      gripperCommandList.emplace(gripperCommandConfig("time"), std::make_shared<GripperCommand>(gripperCommandConfig));
+      *this = StepCommandBuilder(limbName)
+                  .arena(arena)
+                  .simple(type, mcRtcConfig("startTime"), mcRtcConfig("endTime"), {},
+                          mcRtcConfig("swingConfig", mc_rtc::Configuration{}))
+                  .build();
     }
   }
 }
@@ -209,3 +169,84 @@ void StepCommand::setBaseTime(double baseTime)
     gripperCommandList = newGripperCommandList;
   }
 }
+
+StepCommandBuilder & StepCommandBuilder::swing(const SwingCommand::Type & type,
+                                               double startTime,
+                                               double endTime,
+                                               const mc_rtc::Configuration & swingConfig)
+{
+  if(type == SwingCommand::Type::Add && !hasPose_)
+  {
+    mc_rtc::log::error_and_throw("[StepCommandBuilder({})] pose must be specified for the add type swing command.",
+                                 limbName_);
+  }
+  return swing(CommandArena::makeShared<SwingCommand>(arena_, type, startTime, endTime, pose_, swingConfig));
+}
+
+StepCommandBuilder & StepCommandBuilder::swing(const std::shared_ptr<SwingCommand> & swingCommand)
+{
+  swingCommand_ = swingCommand;
+  return *this;
+}
+
+StepCommandBuilder & StepCommandBuilder::contact(double time, const std::shared_ptr<ContactConstraint> & constraint)
+{
+  if(constraint)
+  {
+    contactCommandList_.emplace(time, CommandArena::makeShared<ContactCommand>(arena_, time, constraint));
+  }
+  else
+  {
+    contactCommandList_.emplace(time, nullptr);
+  }
+  return *this;
+}
+
+StepCommandBuilder & StepCommandBuilder::contactFromConfig(double time, const mc_rtc::Configuration & constraintConfig)
+{
+  if(constraintConfig.empty())
+  {
+    return contact(time, nullptr);
+  }
+
+  // Only the configuration of contact constraint is copied to complement the entries
+  mc_rtc::Configuration complementedConfig;
+  complementedConfig.load(constraintConfig); // deep copy
+  // "name", "verticesName", and "pose" entries are automatically set
+  if(!complementedConfig.has("name"))
+  {
+    complementedConfig.add("name", limbName_);
+  }
+  if(!complementedConfig.has("verticesName"))
+  {
+    complementedConfig.add("verticesName", limbName_);
+  }
+  if(!complementedConfig.has("pose") && hasPose_)
+  {
+    complementedConfig.add("pose", pose_);
+  }
+  return contact(time, ContactConstraintPool::make(complementedConfig, arena_));
+}
+
+StepCommandBuilder & StepCommandBuilder::gripper(double time,
+                                                 const std::string & name,
+                                                 const mc_rtc::Configuration & config)
+{
+  gripperCommandList_.emplace(time, CommandArena::makeShared<GripperCommand>(arena_, time, name, config));
+  return *this;
+}
+
+StepCommandBuilder & StepCommandBuilder::simple(const SwingCommand::Type & type,
+                                                double startTime,
+                                                double endTime,
+                                                const mc_rtc::Configuration & constraintConfig,
+                                                const mc_rtc::Configuration & swingConfig)
+{
+  swing(type, startTime, endTime, swingConfig);
+  contact(startTime, nullptr);
+  if(type == SwingCommand::Type::Add)
+  {
+    contactFromConfig(endTime, constraintConfig);
+  }
+  return *this;
+}
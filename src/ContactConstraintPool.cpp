@@ -0,0 +1,177 @@
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <mc_rtc/logging.h>
+
+#include <ForceColl/Contact.h>
+
+#include <MultiContactController/ContactConstraintPool.h>
+
+using namespace MCC;
+
+namespace
+{
+/** \brief Key of contact constraint template. */
+struct TemplateKey
+{
+  //! Constraint type
+  std::string type;
+
+  //! Constraint name
+  std::string name;
+
+  //! Vertices name
+  std::string verticesName;
+
+  //! Friction coefficient
+  double fricCoeff;
+
+  /** \brief Equal operator. */
+  bool operator==(const TemplateKey & other) const
+  {
+    return type == other.type && name == other.name && verticesName == other.verticesName
+           && fricCoeff == other.fricCoeff;
+  }
+};
+
+/** \brief Hash operator of TemplateKey. */
+struct TemplateKeyHash
+{
+  size_t operator()(const TemplateKey & key) const
+  {
+    size_t seed = std::hash<std::string>()(key.type);
+    for(size_t value : {std::hash<std::string>()(key.name), std::hash<std::string>()(key.verticesName),
+                        std::hash<double>()(key.fricCoeff)})
+    {
+      seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+/** \brief Registry of contact constraint templates.
+
+    This is accessed through a function-local static variable in the same manner as the registry of limb names.
+ */
+struct TemplateRegistry
+{
+  //! Mutex
+  std::mutex mutex;
+
+  //! Map from key to template
+  std::unordered_map<TemplateKey, std::shared_ptr<ContactConstraint>, TemplateKeyHash> templateMap;
+
+  /** \brief Get the instance. */
+  static TemplateRegistry & instance()
+  {
+    static TemplateRegistry registry;
+    return registry;
+  }
+};
+
+/** \brief Copy the template and transform it to the pose.
+    \tparam ContactType concrete type of contact constraint
+    \param constraintTemplate template
+    \param pose pose
+    \param arena arena from which the constraint is allocated
+    \param constraint constraint to set (not set if the template is not ContactType)
+ */
+template<class ContactType>
+bool copyTemplate(const ContactConstraint & constraintTemplate,
+                  const sva::PTransformd & pose,
+                  const std::shared_ptr<CommandArena> & arena,
+                  std::shared_ptr<ContactConstraint> & constraint)
+{
+  const auto * typedTemplate = dynamic_cast<const ContactType *>(&constraintTemplate);
+  if(!typedTemplate)
+  {
+    return false;
+  }
+  auto typedConstraint = CommandArena::makeShared<ContactType>(arena, *typedTemplate);
+  typedConstraint->updateGlobalVertices(pose);
+  constraint = typedConstraint;
+  return true;
+}
+} // namespace
+
+std::shared_ptr<ContactConstraint> ContactConstraintPool::make(const mc_rtc::Configuration & constraintConfig,
+                                                               const std::shared_ptr<CommandArena> & arena)
+{
+  // Only the configuration consisting of the key and pose is interned
+  for(const auto & key : constraintConfig.keys())
+  {
+    if(key != "type" && key != "name" && key != "verticesName" && key != "fricCoeff" && key != "pose")
+    {
+      return ContactConstraint::makeSharedFromConfig(constraintConfig);
+    }
+  }
+  std::string type = constraintConfig("type");
+  if(type != "Empty" && !constraintConfig.has("fricCoeff"))
+  {
+    return ContactConstraint::makeSharedFromConfig(constraintConfig);
+  }
+
+  TemplateKey templateKey{type, constraintConfig("name", std::string()),
+                          constraintConfig("verticesName", std::string()), constraintConfig("fricCoeff", 0.0)};
+
+  // Get or make the template
+  std::shared_ptr<ContactConstraint> constraintTemplate;
+  {
+    auto & registry = TemplateRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.templateMap.find(templateKey);
+    if(it == registry.templateMap.end())
+    {
+      mc_rtc::Configuration templateConfig;
+      templateConfig.load(constraintConfig); // deep copy
+      templateConfig.add("pose", sva::PTransformd::Identity());
+      it = registry.templateMap.emplace(templateKey, ContactConstraint::makeSharedFromConfig(templateConfig)).first;
+    }
+    constraintTemplate = it->second;
+  }
+
+  // The empty constraint is not updated in place, so the template is shared
+  if(type == "Empty")
+  {
+    return constraintTemplate;
+  }
+
+  // Copy the template and transform it to the pose
+  sva::PTransformd pose = constraintConfig("pose", sva::PTransformd::Identity());
+  std::shared_ptr<ContactConstraint> constraint;
+  if(copyTemplate<ForceColl::SurfaceContact>(*constraintTemplate, pose, arena, constraint)
+     || copyTemplate<ForceColl::GraspContact>(*constraintTemplate, pose, arena, constraint))
+  {
+    return constraint;
+  }
+  return ContactConstraint::makeSharedFromConfig(constraintConfig);
+}
+
+std::shared_ptr<ContactConstraint> ContactConstraintPool::copy(const ContactConstraint & constraint,
+                                                               const sva::PTransformd & pose)
+{
+  std::shared_ptr<ContactConstraint> copiedConstraint;
+  if(copyTemplate<ForceColl::SurfaceContact>(constraint, pose, nullptr, copiedConstraint)
+     || copyTemplate<ForceColl::GraspContact>(constraint, pose, nullptr, copiedConstraint))
+  {
+    return copiedConstraint;
+  }
+  mc_rtc::log::error_and_throw("[ContactConstraintPool] Unsupported contact constraint type to copy: {}",
+                               constraint.type());
+}
+
+size_t ContactConstraintPool::size()
+{
+  auto & registry = TemplateRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.templateMap.size();
+}
+
+void ContactConstraintPool::clear()
+{
+  auto & registry = TemplateRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.templateMap.clear();
+}
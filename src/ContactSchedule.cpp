@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/ContactSchedule.h>
+
+using namespace MCC;
+
+ContactSchedule::Segment::Segment(double _startTime,
+                                  const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & _contactList)
+: startTime(_startTime), contactList(_contactList)
+{
+  contactVec.reserve(contactList.size());
+  limbVec.reserve(contactList.size());
+  for(const auto & contactKV : contactList)
+  {
+    limbVec.push_back(contactKV.first);
+    contactVec.push_back(contactKV.second);
+  }
+}
+
+bool ContactSchedule::isSameContactList(
+    const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList1,
+    const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList2)
+{
+  if(contactList1.size() != contactList2.size())
+  {
+    return false;
+  }
+  for(const auto & contactKV : contactList1)
+  {
+    auto it = contactList2.find(contactKV.first);
+    if(it == contactList2.end() || it->second != contactKV.second)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ContactSchedule::appendSegment(double startTime,
+                                    const std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> & contactList)
+{
+  if(!segments_.empty())
+  {
+    const auto & lastSegment = *segments_.back();
+    if(startTime <= lastSegment.startTime)
+    {
+      mc_rtc::log::error_and_throw(
+          "[ContactSchedule] Start time of the appended segment must be later than that of the last segment: {} <= {}",
+          startTime, lastSegment.startTime);
+    }
+
+    // Extend the last segment if the contact list is unchanged
+    if(isSameContactList(contactList, lastSegment.contactList))
+    {
+      return;
+    }
+  }
+
+  segments_.push_back(std::make_shared<const Segment>(startTime, contactList));
+}
+
+int ContactSchedule::segmentIdx(double t) const
+{
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), t,
+      [](double _t, const std::shared_ptr<const Segment> & segment) { return _t < segment->startTime; });
+  if(it == segments_.begin())
+  {
+    if(segments_.empty())
+    {
+      mc_rtc::log::error_and_throw("[ContactSchedule] Schedule is empty in segmentIdx.");
+    }
+    mc_rtc::log::error_and_throw(
+        "[ContactSchedule] Past time is specified in segmentIdx. specified time: {}, start time of schedule: {}", t,
+        segments_.front()->startTime);
+  }
+  return static_cast<int>(std::distance(segments_.begin(), it)) - 1;
+}
@@ -1,15 +1,36 @@
+#include <chrono>
+#include <cmath>
 #include <limits>
 
 #include <mc_tasks/FirstOrderImpedanceTask.h>
 
 #include <ForceColl/Contact.h>
 
+#include <MultiContactController/ContactConstraintPool.h>
 #include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
+#include <MultiContactController/StageTimer.h>
 #include <MultiContactController/swing/SwingTrajCubicSplineSimple.h>
+#include <MultiContactController/swing/SwingTrajQuinticSimple.h>
 
 using namespace MCC;
 
+namespace
+{
+/** \brief Check whether a command collides at the same control tick with a command in the timeline or the last
+    command to be appended.
+    \param timeline command timeline
+    \param t time of the command
+    \param lastTime time of the last command to be appended (-inf if none)
+*/
+template<class CommandType>
+bool isTickCollided(const CommandTimeline<CommandType> & timeline, double t, double lastTime)
+{
+  return timeline.hasCommandAtTick(t)
+         || (std::isfinite(lastTime) && timeline.timeToTick(t) == timeline.timeToTick(lastTime));
+}
+} // namespace
+
 void LimbManager::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
 {
   mcRtcConfig("name", name);
@@ -18,7 +39,17 @@ void LimbManager::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
     taskGain = TaskGain(mcRtcConfig("taskGain"));
   }
   mcRtcConfig("defaultSwingTrajType", defaultSwingTrajType);
-  mcRtcConfig("swingStartPolicy", swingStartPolicy);
+  if(mcRtcConfig.has("swingStartPolicy"))
+  {
+    std::string swingStartPolicyStr = mcRtcConfig("swingStartPolicy");
+    if(strToSwingStartPolicy.count(swingStartPolicyStr) == 0)
+    {
+      mc_rtc::log::error_and_throw("[LimbManager] swingStartPolicy must be \"ControlRobot\", \"Target\", or "
+                                   "\"Compliance\", but \"{}\" is specified.",
+                                   swingStartPolicyStr);
+    }
+    swingStartPolicy = strToSwingStartPolicy.at(swingStartPolicyStr);
+  }
   mcRtcConfig("overwriteLandingPose", overwriteLandingPose);
   mcRtcConfig("stopSwingTrajForTouchDownLimb", stopSwingTrajForTouchDownLimb);
   mcRtcConfig("keepPoseForTouchDownLimb", keepPoseForTouchDownLimb);
@@ -36,9 +67,13 @@ void LimbManager::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
 }
 
 LimbManager::LimbManager(MultiContactController * ctlPtr, const Limb & limb, const mc_rtc::Configuration & mcRtcConfig)
-: ctlPtr_(ctlPtr), limb_(limb)
+: ctlPtr_(ctlPtr), limb_(limb), limbTask_(ctlPtr->limbTasks_.at(limb)), swingCommandList_(ctlPtr->dt()),
+  contactCommandList_(ctlPtr->dt()), gripperCommandList_(ctlPtr->dt())
 {
   config_.load(mcRtcConfig);
+
+  // At most, the limb task is removed and added, and a few gripper commands are sent in a control cycle
+  deferredSharedActions_.reserve(8);
 }
 
 void LimbManager::reset(const mc_rtc::Configuration & _constraintConfig)
@@ -48,6 +83,8 @@ void LimbManager::reset(const mc_rtc::Configuration & _constraintConfig)
   currentSwingCommand_.reset();
   prevSwingCommand_.reset();
 
+  swingTrajPreparationList_.clear();
+
   gripperCommandList_.clear();
 
   targetPose_ = limbTask()->frame().position();
@@ -56,6 +93,7 @@ void LimbManager::reset(const mc_rtc::Configuration & _constraintConfig)
   taskGain_ = config_.taskGain;
 
   swingTraj_.reset();
+  swingTrajLookupTable_ = {};
 
   touchDown_ = false;
 
@@ -63,6 +101,8 @@ void LimbManager::reset(const mc_rtc::Configuration & _constraintConfig)
   {
     phase_ = "Uninitialized";
 
+    requirePhaseUpdate_ = true;
+
     impGainType_ = "Uninitialized";
 
     requireImpGainUpdate_ = false;
@@ -96,13 +136,64 @@ void LimbManager::reset(const mc_rtc::Configuration & _constraintConfig)
     {
       constraintConfig.add("pose", targetPose_);
     }
-    currentContactCommand_ =
-        std::make_shared<ContactCommand>(ctl().t(), ContactConstraint::makeSharedFromConfig(constraintConfig));
+    currentContactCommand_ = std::make_shared<ContactCommand>(ctl().t(), ContactConstraintPool::make(constraintConfig));
   }
   contactCommandList_.emplace(ctl().t(), currentContactCommand_);
+
+  notifyCommandChanged(ctl().t());
 }
 
 void LimbManager::update()
+{
+  updateLimb(false);
+  updateContactMarker();
+}
+
+void LimbManager::updateLocal()
+{
+  updateLimb(true);
+}
+
+void LimbManager::updateShared()
+{
+  for(const auto & action : deferredSharedActions_)
+  {
+    executeSharedAction(action);
+  }
+  deferredSharedActions_.clear();
+
+  updateContactMarker();
+}
+
+void LimbManager::requestSharedAction(SharedAction && action, bool defer)
+{
+  if(defer)
+  {
+    deferredSharedActions_.push_back(std::move(action));
+  }
+  else
+  {
+    executeSharedAction(action);
+  }
+}
+
+void LimbManager::executeSharedAction(const SharedAction & action)
+{
+  switch(action.type)
+  {
+    case SharedAction::Type::AddTask:
+      ctl().solver().addTask(limbTask());
+      break;
+    case SharedAction::Type::RemoveTask:
+      ctl().solver().removeTask(limbTask());
+      break;
+    case SharedAction::Type::SendGripperCommand:
+      ctl().robot().gripper(action.gripperCommand->name).configure(action.gripperCommand->config);
+      break;
+  }
+}
+
+void LimbManager::updateLimb(bool deferSharedActions)
 {
   // Disable hold mode by default
   limbTask()->hold(false);
@@ -156,16 +247,20 @@ void LimbManager::update()
     }
     else // if(completedSwingCommand->type == SwingCommand::Type::Remove)
     {
-      ctl().solver().removeTask(limbTask());
+      requestSharedAction(SharedAction{SharedAction::Type::RemoveTask, nullptr}, deferSharedActions);
     }
 
     // Update variables
     swingTraj_.reset();
+    swingTrajLookupTable_ = {};
     currentSwingCommand_.reset();
     prevSwingCommand_ = completedSwingCommand;
 
     // Remove completed swing command
     swingCommandList_.erase(swingCommandList_.begin());
+
+    // The limb pose returned by getLimbPose changes from the end pose of swingTraj_ to the pose of prevSwingCommand_
+    notifyCommandChanged(ctl().t());
   }
 
   // Process swing command
@@ -192,30 +287,24 @@ void LimbManager::update()
       if(currentSwingCommand_->type == SwingCommand::Type::Add)
       {
         limbTask()->reset();
-        ctl().solver().addTask(limbTask());
+        requestSharedAction(SharedAction{SharedAction::Type::AddTask, nullptr}, deferSharedActions);
       }
 
       // Set swingTraj_
       {
         sva::PTransformd swingStartPose;
-        if(config_.swingStartPolicy == "ControlRobot")
+        if(config_.swingStartPolicy == Configuration::SwingStartPolicy::ControlRobot)
         {
           swingStartPose = limbTask()->frame().position(); // control robot pose (i.e., IK result)
         }
-        else if(config_.swingStartPolicy == "Target")
+        else if(config_.swingStartPolicy == Configuration::SwingStartPolicy::Target)
         {
           swingStartPose = limbTask()->targetPose(); // target pose
         }
-        else if(config_.swingStartPolicy == "Compliance")
+        else // if(config_.swingStartPolicy == Configuration::SwingStartPolicy::Compliance)
         {
           swingStartPose = limbTask()->compliancePose(); // compliance pose, which is modified by impedance
         }
-        else
-        {
-          mc_rtc::log::error_and_throw("[LimbManager({})] swingStartPolicy must be \"ControlRobot\", \"Target\", or "
-                                       "\"Compliance\", but \"{}\" is specified.",
-                                       std::to_string(limb_), config_.swingStartPolicy);
-        }
         sva::PTransformd swingEndPose = currentSwingCommand_->pose;
         if(config_.overwriteLandingPose && prevSwingCommand_ && prevSwingCommand_->type == SwingCommand::Type::Add)
         {
@@ -223,23 +312,58 @@ void LimbManager::update()
           swingEndPose = swingRelPose * swingStartPose;
         }
 
-        std::string swingTrajType =
-            currentSwingCommand_->config("type", static_cast<std::string>(config_.defaultSwingTrajType));
-        if(swingTrajType == "CubicSplineSimple")
+        // Get the data prepared when the swing command was appended
+        std::string swingTrajType;
+        std::shared_ptr<const SwingTraj::Preparation> swingTrajPreparation;
+        auto preparationIt = swingTrajPreparationList_.find(currentSwingCommand_);
+        if(preparationIt != swingTrajPreparationList_.end())
         {
-          swingTraj_ = std::make_shared<SwingTrajCubicSplineSimple>(
-              currentSwingCommand_->type, static_cast<bool>(currentContactCommand_), swingStartPose, swingEndPose,
-              currentSwingCommand_->startTime, currentSwingCommand_->endTime, config_.taskGain,
-              currentSwingCommand_->config);
+          swingTrajType = preparationIt->second.type;
+          // The control cycle is not blocked by waiting for the preparation; if it is not finished yet, the swing
+          // trajectory is constructed from the configuration in this cycle instead
+          if(preparationIt->second.data.valid())
+          {
+            if(preparationIt->second.data.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+              swingTrajPreparation = preparationIt->second.data.get();
+            }
+            else
+            {
+              mc_rtc::log::warning("[LimbManager({})] Preparation of the swing trajectory is not finished at the swing "
+                                   "start. Construct it in the control thread.",
+                                   std::to_string(limb_));
+            }
+          }
+          swingTrajPreparationList_.erase(preparationIt);
         }
         else
         {
-          mc_rtc::log::error_and_throw("[LimbManager({})] Invalid swingTrajType: {}.", std::to_string(limb_),
-                                       swingTrajType);
+          swingTrajType = currentSwingCommand_->config("type", static_cast<std::string>(config_.defaultSwingTrajType));
+        }
+
+        bool isContact = static_cast<bool>(currentContactCommand_);
+        swingTraj_ = makeSwingTraj(limb_, swingTrajType, *currentSwingCommand_, isContact, swingStartPose, swingEndPose,
+                                   config_.taskGain, swingTrajPreparation);
+
+        // The lookup table is calculated in the background from a separate instance constructed with the same
+        // arguments, and is set to swingTraj_ when it is ready
+        swingTrajLookupTable_ = {};
+        if(swingTraj_->config().lookupTableStep > 0)
+        {
+          swingTrajLookupTable_ = ctl().limbManagerSet_->swingTrajPreparationQueue().submit(
+              [limb = limb_, swingTrajType, swingCommand = currentSwingCommand_, isContact, swingStartPose,
+               swingEndPose, taskGain = config_.taskGain, swingTrajPreparation]() {
+                auto swingTraj = makeSwingTraj(limb, swingTrajType, *swingCommand, isContact, swingStartPose,
+                                               swingEndPose, taskGain, swingTrajPreparation);
+                return swingTraj->calcLookupTable(swingTraj->config().lookupTableStep);
+              });
         }
       }
 
       touchDown_ = false;
+
+      // The limb pose returned by getLimbPose changes to the start or end pose of swingTraj_
+      notifyCommandChanged(ctl().t());
     }
 
     // Update touchDown_
@@ -256,14 +380,25 @@ void LimbManager::update()
       {
         swingTraj_->touchDown(ctl().t());
       }
+
+      // notifyCommandChanged is not called because the results of getLimbPose, getContactWeight, and
+      // getClosestContactTimes do not depend on touch down
+    }
+
+    // Set the lookup table calculated in the background if it is ready
+    if(swingTrajLookupTable_.valid()
+       && swingTrajLookupTable_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+      swingTraj_->setLookupTable(swingTrajLookupTable_.get());
     }
 
     // Update target
     {
-      targetPose_ = swingTraj_->pose(ctl().t());
-      targetVel_ = swingTraj_->vel(ctl().t());
-      targetAccel_ = swingTraj_->accel(ctl().t());
-      taskGain_ = swingTraj_->taskGain(ctl().t());
+      const auto & swingTrajSample = swingTraj_->evaluate(ctl().t());
+      targetPose_ = swingTrajSample.pose;
+      targetVel_ = swingTrajSample.vel;
+      targetAccel_ = swingTrajSample.accel;
+      taskGain_ = swingTrajSample.taskGain;
     }
   }
 
@@ -271,10 +406,9 @@ void LimbManager::update()
   while(!gripperCommandList_.empty() && gripperCommandList_.begin()->first <= ctl().t())
   {
     auto it = gripperCommandList_.begin();
-    const auto & gripperCommand = it->second;
 
     // Send gripper command
-    ctl().robot().gripper(gripperCommand->name).configure(gripperCommand->config);
+    requestSharedAction(SharedAction{SharedAction::Type::SendGripperCommand, it->second}, deferSharedActions);
 
     // Remove processed gripper command
     gripperCommandList_.erase(it);
@@ -289,22 +423,39 @@ void LimbManager::update()
     // skipped for EmptyContact and requireTouchDownPoseUpdate_ is retained. The current implementation works well for
     // contact transitions where the hand grasps the environment (i.e., EmptyContact -> GraspContact), but it does not
     // work well to perform other contact transitions in the future (e.g., SurfaceContact -> GraspContact).
-    currentContactCommand_->constraint->updateGlobalVertices(targetPose_);
+    // The constraint is replaced with an updated copy instead of being updated in place, since the contact schedule
+    // passed to the MPC threads refers to it
+    currentContactCommand_->constraint = ContactConstraintPool::copy(*currentContactCommand_->constraint, targetPose_);
     requireTouchDownPoseUpdate_ = false;
   }
 
-  // Update phase_
+  // Update phase_ (the string is built only when the phase is changed)
+  const void * phaseSource = nullptr;
   if(currentSwingCommand_)
   {
-    phase_ = "Swing (" + swingTraj_->type() + ")" + (touchDown_ ? " [TouchDown]" : "");
+    phaseSource = swingTraj_.get();
   }
   else if(currentContactCommand_)
   {
-    phase_ = "Contact (" + currentContactCommand_->constraint->type() + ")";
+    phaseSource = currentContactCommand_->constraint.get();
   }
-  else
+  if(requirePhaseUpdate_ || phaseSource != phaseSource_ || touchDown_ != phaseTouchDown_)
   {
-    phase_ = "Free";
+    if(currentSwingCommand_)
+    {
+      phase_ = "Swing (" + swingTraj_->type() + ")" + (touchDown_ ? " [TouchDown]" : "");
+    }
+    else if(currentContactCommand_)
+    {
+      phase_ = "Contact (" + currentContactCommand_->constraint->type() + ")";
+    }
+    else
+    {
+      phase_ = "Free";
+    }
+    phaseSource_ = phaseSource;
+    phaseTouchDown_ = touchDown_;
+    requirePhaseUpdate_ = false;
   }
 
   // Set target of limb task
@@ -316,13 +467,45 @@ void LimbManager::update()
     limbTask()->targetAccel(targetAccel_);
     limbTask()->setGains(taskGain_.stiffness, taskGain_.damping);
   }
+}
+
+void LimbManager::updateContactMarker()
+{
+  MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, GuiMarker);
+
+  ctl().gui()->removeCategory({ctl().name(), config_.name, std::to_string(limb_), "ContactMarker"});
+
+  int contactIdx = 0;
+  for(const auto & contactCommandKV : contactCommandList_)
+  {
+    if(!contactCommandKV.second || contactCommandKV.second->time < ctl().t())
+    {
+      continue;
+    }
+    // Skip current contact as it is visualized in CentroidalManager
+    if(contactCommandKV.second == currentContactCommand_)
+    {
+      continue;
+    }
+
+    contactCommandKV.second->constraint->addToGUI(
+        *ctl().gui(),
+        {ctl().name(), config_.name, std::to_string(limb_), "ContactMarker",
+         contactCommandKV.second->constraint->name_ + "_" + std::to_string(contactIdx)},
+        0.0, 0.0);
+
+    contactIdx++;
+  }
+}
 
+void LimbManager::updateImpGains()
+{
   // Update impGainType_ and requireImpGainUpdate_
   {
     std::string newImpGainType;
     if(currentContactCommand_)
     {
-      if(ctl().limbManagerSet_->contactList(ctl().t()).size() == 1)
+      if(ctl().limbManagerSet_->contactSnapshot().size() == 1)
       {
         newImpGainType = "SingleContact";
       }
@@ -350,33 +533,6 @@ void LimbManager::update()
 
     limbTask()->gains() = config_.impGains.at(impGainType_);
   }
-
-  // Update contact visualization
-  {
-    ctl().gui()->removeCategory({ctl().name(), config_.name, std::to_string(limb_), "ContactMarker"});
-
-    int contactIdx = 0;
-    for(const auto & contactCommandKV : contactCommandList_)
-    {
-      if(!contactCommandKV.second || contactCommandKV.second->time < ctl().t())
-      {
-        continue;
-      }
-      // Skip current contact as it is visualized in CentroidalManager
-      if(contactCommandKV.second == currentContactCommand_)
-      {
-        continue;
-      }
-
-      contactCommandKV.second->constraint->addToGUI(
-          *ctl().gui(),
-          {ctl().name(), config_.name, std::to_string(limb_), "ContactMarker",
-           contactCommandKV.second->constraint->name_ + "_" + std::to_string(contactIdx)},
-          0.0, 0.0);
-
-      contactIdx++;
-    }
-  }
 }
 
 void LimbManager::stop()
@@ -426,6 +582,38 @@ void LimbManager::removeFromLogger(mc_rtc::Logger & logger)
 }
 
 bool LimbManager::appendStepCommand(const StepCommand & stepCommand)
+{
+  LastCommandTimes lastCommandTimes = this->lastCommandTimes();
+  if(!checkStepCommand(stepCommand, lastCommandTimes))
+  {
+    return false;
+  }
+
+  insertStepCommand(stepCommand);
+
+  return true;
+}
+
+LimbManager::LastCommandTimes LimbManager::lastCommandTimes() const
+{
+  LastCommandTimes lastCommandTimes;
+  if(!swingCommandList_.empty())
+  {
+    lastCommandTimes.swing = swingCommandList_.rbegin()->second->endTime;
+    lastCommandTimes.swingStart = swingCommandList_.rbegin()->first;
+  }
+  if(!contactCommandList_.empty())
+  {
+    lastCommandTimes.contact = contactCommandList_.rbegin()->first;
+  }
+  if(!gripperCommandList_.empty())
+  {
+    lastCommandTimes.gripper = gripperCommandList_.rbegin()->first;
+  }
+  return lastCommandTimes;
+}
+
+bool LimbManager::checkStepCommand(const StepCommand & stepCommand, LastCommandTimes & lastCommandTimes) const
 {
   // Check time of swing command
   if(stepCommand.swingCommand)
@@ -437,16 +625,19 @@ bool LimbManager::appendStepCommand(const StepCommand & stepCommand)
                          std::to_string(limb_), swingCommandStartTime, ctl().t());
       return false;
     }
-    if(!swingCommandList_.empty())
+    if(swingCommandStartTime < lastCommandTimes.swing)
     {
-      double lastSwingCommandTime = swingCommandList_.rbegin()->second->endTime;
-      if(swingCommandStartTime < lastSwingCommandTime)
-      {
-        mc_rtc::log::error("[LimbManager({})] Ignore a new step command with swing command earlier than the last swing "
-                           "command: {} < {}",
-                           std::to_string(limb_), swingCommandStartTime, lastSwingCommandTime);
-        return false;
-      }
+      mc_rtc::log::error("[LimbManager({})] Ignore a new step command with swing command earlier than the last swing "
+                         "command: {} < {}",
+                         std::to_string(limb_), swingCommandStartTime, lastCommandTimes.swing);
+      return false;
+    }
+    if(isTickCollided(swingCommandList_, swingCommandStartTime, lastCommandTimes.swingStart))
+    {
+      mc_rtc::log::error("[LimbManager({})] Ignore a new step command with swing command at the same tick as another "
+                         "swing command: {}",
+                         std::to_string(limb_), swingCommandStartTime);
+      return false;
     }
   }
 
@@ -460,16 +651,24 @@ bool LimbManager::appendStepCommand(const StepCommand & stepCommand)
                          std::to_string(limb_), contactCommandTime, ctl().t());
       return false;
     }
-    if(!contactCommandList_.empty())
+    if(contactCommandTime < lastCommandTimes.contact)
+    {
+      mc_rtc::log::error("[LimbManager({})] Ignore a new step command with contact command earlier than the last "
+                         "contact command: {} < {}",
+                         std::to_string(limb_), contactCommandTime, lastCommandTimes.contact);
+      return false;
+    }
+    double prevContactCommandTime = lastCommandTimes.contact;
+    for(const auto & contactCommandKV : stepCommand.contactCommandList)
     {
-      double lastContactCommandTime = contactCommandList_.rbegin()->first;
-      if(contactCommandTime < lastContactCommandTime)
+      if(isTickCollided(contactCommandList_, contactCommandKV.first, prevContactCommandTime))
       {
-        mc_rtc::log::error("[LimbManager({})] Ignore a new step command with contact command earlier than the last "
-                           "contact command: {} < {}",
-                           std::to_string(limb_), contactCommandTime, lastContactCommandTime);
+        mc_rtc::log::error("[LimbManager({})] Ignore a new step command with contact command at the same tick as "
+                           "another contact command: {}",
+                           std::to_string(limb_), contactCommandKV.first);
         return false;
       }
+      prevContactCommandTime = contactCommandKV.first;
     }
   }
 
@@ -483,23 +682,75 @@ bool LimbManager::appendStepCommand(const StepCommand & stepCommand)
                          std::to_string(limb_), gripperCommandTime, ctl().t());
       return false;
     }
-    if(!gripperCommandList_.empty())
+    if(gripperCommandTime < lastCommandTimes.gripper)
     {
-      double lastGripperCommandTime = gripperCommandList_.rbegin()->first;
-      if(gripperCommandTime < lastGripperCommandTime)
+      mc_rtc::log::error("[LimbManager({})] Ignore a new step command with gripper command earlier than the last "
+                         "gripper command: {} < {}",
+                         std::to_string(limb_), gripperCommandTime, lastCommandTimes.gripper);
+      return false;
+    }
+    double prevGripperCommandTime = lastCommandTimes.gripper;
+    for(const auto & gripperCommandKV : stepCommand.gripperCommandList)
+    {
+      if(isTickCollided(gripperCommandList_, gripperCommandKV.first, prevGripperCommandTime))
       {
-        mc_rtc::log::error("[LimbManager({})] Ignore a new step command with gripper command earlier than the last "
-                           "gripper command: {} < {}",
-                           std::to_string(limb_), gripperCommandTime, lastGripperCommandTime);
+        mc_rtc::log::error("[LimbManager({})] Ignore a new step command with gripper command at the same tick as "
+                           "another gripper command: {}",
+                           std::to_string(limb_), gripperCommandKV.first);
         return false;
       }
+      prevGripperCommandTime = gripperCommandKV.first;
+    }
+  }
+
+  // Update the last times as if the step command is appended
+  if(stepCommand.swingCommand)
+  {
+    lastCommandTimes.swing = stepCommand.swingCommand->endTime;
+    lastCommandTimes.swingStart = stepCommand.swingCommand->startTime;
+  }
+  if(!stepCommand.contactCommandList.empty())
+  {
+    lastCommandTimes.contact = std::max(lastCommandTimes.contact, stepCommand.contactCommandList.rbegin()->first);
+  }
+  if(!stepCommand.gripperCommandList.empty())
+  {
+    lastCommandTimes.gripper = std::max(lastCommandTimes.gripper, stepCommand.gripperCommandList.rbegin()->first);
+  }
+
+  return true;
+}
+
+void LimbManager::insertStepCommand(const StepCommand & stepCommand)
+{
+  // Notify command change
+  {
+    double changedTime = std::numeric_limits<double>::infinity();
+    if(stepCommand.swingCommand)
+    {
+      changedTime = std::min(changedTime, stepCommand.swingCommand->startTime);
+    }
+    if(!stepCommand.contactCommandList.empty())
+    {
+      changedTime = std::min(changedTime, stepCommand.contactCommandList.begin()->first);
+    }
+    // Contact weight changes before the contact command over the duration of weight transition
+    changedTime -= config_.weightTransitDuration;
+    // If the limb has no contact at the end of the current commands, the appended contact may be the closest contact
+    // after any time since then
+    if(!stepCommand.contactCommandList.empty() && !contactCommandList_.empty()
+       && !contactCommandList_.rbegin()->second)
+    {
+      changedTime = std::min(changedTime, contactCommandList_.rbegin()->first);
     }
+    notifyCommandChanged(std::max(changedTime, ctl().t()));
   }
 
   // Append swing command
   if(stepCommand.swingCommand)
   {
     swingCommandList_.emplace(stepCommand.swingCommand->startTime, stepCommand.swingCommand);
+    prepareSwingTraj(stepCommand.swingCommand);
   }
 
   // Append contact command
@@ -513,13 +764,88 @@ bool LimbManager::appendStepCommand(const StepCommand & stepCommand)
   {
     gripperCommandList_.insert(stepCommand.gripperCommandList.begin(), stepCommand.gripperCommandList.end());
   }
+}
 
-  return true;
+void LimbManager::prepareSwingTraj(const std::shared_ptr<SwingCommand> & swingCommand)
+{
+  SwingTrajPreparation preparation;
+  preparation.type = swingCommand->config("type", static_cast<std::string>(config_.defaultSwingTrajType));
+
+  // The default configuration is copied here because it may be modified from the GUI in the control thread
+  TaskQueue & preparationQueue = ctl().limbManagerSet_->swingTrajPreparationQueue();
+  if(preparation.type == "CubicSplineSimple")
+  {
+    preparation.data = preparationQueue.submit(
+        [swingCommand,
+         baseConfig = SwingTrajCubicSplineSimple::defaultConfig_]() -> std::shared_ptr<const SwingTraj::Preparation> {
+          return SwingTrajCubicSplineSimple::prepare(swingCommand->type, swingCommand->pose, swingCommand->startTime,
+                                                     swingCommand->endTime, baseConfig, swingCommand->config);
+        });
+  }
+  else if(preparation.type == "QuinticSimple")
+  {
+    preparation.data = preparationQueue.submit(
+        [swingCommand,
+         baseConfig = SwingTrajQuinticSimple::defaultConfig_]() -> std::shared_ptr<const SwingTraj::Preparation> {
+          return SwingTrajQuinticSimple::prepare(baseConfig, swingCommand->config);
+        });
+  }
+  // Invalid type is reported at the swing start
+
+  swingTrajPreparationList_[swingCommand] = std::move(preparation);
+}
+
+std::shared_ptr<SwingTraj> LimbManager::makeSwingTraj(
+    const Limb & limb,
+    const std::string & swingTrajType,
+    const SwingCommand & swingCommand,
+    bool isContact,
+    const sva::PTransformd & swingStartPose,
+    const sva::PTransformd & swingEndPose,
+    const TaskGain & taskGain,
+    const std::shared_ptr<const SwingTraj::Preparation> & swingTrajPreparation)
+{
+  if(swingTrajType == "CubicSplineSimple")
+  {
+    auto preparation = std::dynamic_pointer_cast<const SwingTrajCubicSplineSimple::Preparation>(swingTrajPreparation);
+    if(preparation)
+    {
+      return std::make_shared<SwingTrajCubicSplineSimple>(swingCommand.type, isContact, swingStartPose, swingEndPose,
+                                                          swingCommand.startTime, swingCommand.endTime, taskGain,
+                                                          preparation);
+    }
+    else
+    {
+      return std::make_shared<SwingTrajCubicSplineSimple>(swingCommand.type, isContact, swingStartPose, swingEndPose,
+                                                          swingCommand.startTime, swingCommand.endTime, taskGain,
+                                                          swingCommand.config);
+    }
+  }
+  else if(swingTrajType == "QuinticSimple")
+  {
+    auto preparation = std::dynamic_pointer_cast<const SwingTrajQuinticSimple::Preparation>(swingTrajPreparation);
+    if(preparation)
+    {
+      return std::make_shared<SwingTrajQuinticSimple>(swingCommand.type, isContact, swingStartPose, swingEndPose,
+                                                      swingCommand.startTime, swingCommand.endTime, taskGain,
+                                                      preparation);
+    }
+    else
+    {
+      return std::make_shared<SwingTrajQuinticSimple>(swingCommand.type, isContact, swingStartPose, swingEndPose,
+                                                      swingCommand.startTime, swingCommand.endTime, taskGain,
+                                                      swingCommand.config);
+    }
+  }
+  else
+  {
+    mc_rtc::log::error_and_throw("[LimbManager({})] Invalid swingTrajType: {}.", std::to_string(limb), swingTrajType);
+  }
 }
 
-sva::PTransformd LimbManager::getLimbPose(double t) const
+sva::PTransformd LimbManager::getLimbPose(double t, QueryCursor & cursor) const
 {
-  auto it = swingCommandList_.upper_bound(t);
+  auto it = swingCommandList_.upper_bound(t, cursor.swing);
   if(it == swingCommandList_.begin())
   {
     // If there is no swing command before the specified time, get pose based on some assumptions
@@ -555,9 +881,9 @@ sva::PTransformd LimbManager::getLimbPose(double t) const
   }
 }
 
-std::shared_ptr<ContactCommand> LimbManager::getContactCommand(double t) const
+std::shared_ptr<ContactCommand> LimbManager::getContactCommand(double t, QueryCursor & cursor) const
 {
-  auto it = contactCommandList_.upper_bound(t);
+  auto it = contactCommandList_.upper_bound(t, cursor.contact);
   if(it == contactCommandList_.begin())
   {
     mc_rtc::log::error_and_throw(
@@ -566,31 +892,48 @@ std::shared_ptr<ContactCommand> LimbManager::getContactCommand(double t) const
   }
   it--;
 
-  auto currentIt = contactCommandList_.upper_bound(ctl().t());
-  if(currentIt != contactCommandList_.begin())
+  // If the current command without contact is found and touch down is detected, return the next contact (the cheap
+  // conditions are checked first to avoid searching the current command)
+  // clang-format off
+  if(config_.enableWrenchDistForTouchDownLimb
+     && touchDown_
+     && !it->second
+     && std::next(it) != contactCommandList_.end()
+     && std::next(it)->second
+     && std::next(it) == contactCommandList_.upper_bound(ctl().t()))
+  // clang-format on
   {
-    currentIt--;
-    // If the current command without contact is found and touch down is detected, return the next contact
-    // clang-format off
-    if(it == currentIt
-       && !it->second
-       && std::next(it) != contactCommandList_.end()
-       && std::next(it)->second
-       && config_.enableWrenchDistForTouchDownLimb
-       && touchDown_
-       )
-    // clang-format on
-    {
-      return std::next(it)->second;
-    }
+    return std::next(it)->second;
   }
 
   return it->second;
 }
 
-double LimbManager::getContactWeight(double t) const
+std::shared_ptr<ContactCommand> LimbManager::getTouchDownContactCommand() const
 {
-  auto nextIt = contactCommandList_.upper_bound(t);
+  // clang-format off
+  if(!config_.enableWrenchDistForTouchDownLimb
+     || !currentSwingCommand_
+     || currentSwingCommand_->type != SwingCommand::Type::Add
+     || touchDown_
+     || swingTraj_->endTime_ - ctl().t() > config_.touchDownRemainingDuration)
+  // clang-format on
+  {
+    return nullptr;
+  }
+
+  // Return the next contact if the current command is without contact (same as getContactCommand after touch down)
+  auto nextIt = contactCommandList_.upper_bound(ctl().t());
+  if(nextIt == contactCommandList_.begin() || nextIt == contactCommandList_.end() || std::prev(nextIt)->second)
+  {
+    return nullptr;
+  }
+  return nextIt->second;
+}
+
+double LimbManager::getContactWeight(double t, QueryCursor & cursor) const
+{
+  auto nextIt = contactCommandList_.upper_bound(t, cursor.contact);
   if(nextIt == contactCommandList_.begin())
   {
     mc_rtc::log::error_and_throw(
@@ -658,7 +1001,7 @@ std::array<double, 2> LimbManager::getClosestContactTimes(double t) const
   {
     std::array<double, 2> closestContactTimes = {std::numeric_limits<double>::quiet_NaN(),
                                                  std::numeric_limits<double>::quiet_NaN()};
-    using ConstReverseIterator = std::map<double, std::shared_ptr<ContactCommand>>::const_reverse_iterator;
+    using ConstReverseIterator = CommandTimeline<ContactCommand>::const_reverse_iterator;
     for(auto backwardIt = ConstReverseIterator(it); backwardIt != contactCommandList_.rend(); backwardIt++)
     {
       constexpr double epsDuration = 1e-10;
@@ -680,11 +1023,6 @@ std::array<double, 2> LimbManager::getClosestContactTimes(double t) const
   }
 }
 
-const std::shared_ptr<mc_tasks::force::FirstOrderImpedanceTask> & LimbManager::limbTask() const
-{
-  return ctl().limbTasks_.at(limb_);
-}
-
 bool LimbManager::detectTouchDown() const
 {
   if(!currentSwingCommand_)
@@ -700,7 +1038,7 @@ bool LimbManager::detectTouchDown() const
   }
 
   // False if the position error does not meet the threshold
-  if((swingTraj_->endPose_.translation() - swingTraj_->pose(ctl().t()).translation()).norm()
+  if((swingTraj_->endPose_.translation() - swingTraj_->evaluate(ctl().t()).pose.translation()).norm()
      > config_.touchDownPosError)
   {
     return false;
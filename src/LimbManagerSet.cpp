@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -6,13 +7,19 @@
 
 #include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
+#include <MultiContactController/StageTimer.h>
+#include <MultiContactController/StepCommandSocket.h>
 #include <MultiContactController/swing/SwingTrajCubicSplineSimple.h>
+#include <MultiContactController/swing/SwingTrajQuinticSimple.h>
 
 using namespace MCC;
 
 void LimbManagerSet::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
 {
   mcRtcConfig("name", name);
+  mcRtcConfig("stepCommandQueueCapacity", stepCommandQueueCapacity);
+  mcRtcConfig("stepCommandSocketPath", stepCommandSocketPath);
+  mcRtcConfig("contactScheduleMargin", contactScheduleMargin);
 }
 
 LimbManagerSet::LimbManagerSet(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig)
@@ -20,10 +27,13 @@ LimbManagerSet::LimbManagerSet(MultiContactController * ctlPtr, const mc_rtc::Co
 {
   config_.load(mcRtcConfig);
 
+  stepCommandQueue_ = std::make_unique<CommandQueue<StepCommandRequest>>(config_.stepCommandQueueCapacity);
+
   if(mcRtcConfig.has("SwingTraj"))
   {
     SwingTrajCubicSplineSimple::loadDefaultConfig(
         mcRtcConfig("SwingTraj")("CubicSplineSimple", mc_rtc::Configuration{}));
+    SwingTrajQuinticSimple::loadDefaultConfig(mcRtcConfig("SwingTraj")("QuinticSimple", mc_rtc::Configuration{}));
   }
 
   for(const auto & limbTaskKV : ctl().limbTasks_)
@@ -39,8 +49,45 @@ LimbManagerSet::LimbManagerSet(MultiContactController * ctlPtr, const mc_rtc::Co
 
     groupLimbsMap_[limbTaskKV.first.group].insert(limbTaskKV.first);
   }
+
+  // Setup background preparation of swing trajectories
+  swingTrajPreparationQueue_ = std::make_unique<TaskQueue>();
+
+  // Setup parallel update
+  threadPool_ = std::make_unique<ThreadPool>(mcRtcConfig("ThreadPool", mc_rtc::Configuration{}));
+  for(const auto & limbManagerKV : *this)
+  {
+    limbManagerVec_.push_back(limbManagerKV.second);
+  }
+  if(threadPool_->threadNum() > 0 && !limbManagerVec_.empty())
+  {
+    // One chunk for each thread including the calling thread
+    size_t chunkNum = std::min(static_cast<size_t>(threadPool_->threadNum()) + 1, limbManagerVec_.size());
+    limbUpdateExceptions_.resize(chunkNum);
+    for(size_t chunkIdx = 0; chunkIdx < chunkNum; chunkIdx++)
+    {
+      size_t beginIdx = limbManagerVec_.size() * chunkIdx / chunkNum;
+      size_t endIdx = limbManagerVec_.size() * (chunkIdx + 1) / chunkNum;
+      limbUpdateTasks_.push_back([this, chunkIdx, beginIdx, endIdx]() {
+        try
+        {
+          for(size_t i = beginIdx; i < endIdx; i++)
+          {
+            limbManagerVec_[i]->updateLocal();
+          }
+        }
+        catch(...)
+        {
+          // The exception is rethrown in the calling thread because the task must not throw
+          limbUpdateExceptions_[chunkIdx] = std::current_exception();
+        }
+      });
+    }
+  }
 }
 
+LimbManagerSet::~LimbManagerSet() = default;
+
 void LimbManagerSet::reset(const mc_rtc::Configuration & constraintSetConfig)
 {
   std::unordered_map<Limb, mc_rtc::Configuration> constraintConfigMap;
@@ -66,14 +113,65 @@ void LimbManagerSet::reset(const mc_rtc::Configuration & constraintSetConfig)
       limbManagerKV.second->reset();
     }
   }
+
+  updateContactSnapshot();
+  updateContactSchedule(true);
+
+  // Discard the step commands pushed before reset
+  StepCommandRequest stepCommandRequest;
+  while(stepCommandQueue_->pop(stepCommandRequest))
+  {
+  }
+  lastUpdateTime_ = ctl().t();
+
+  if(!config_.stepCommandSocketPath.empty() && !stepCommandSocket_)
+  {
+    stepCommandSocket_ = std::make_unique<StepCommandSocket>(this, config_.stepCommandSocketPath);
+  }
 }
 
 void LimbManagerSet::update()
 {
+  MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, LimbManager);
+
+  lastUpdateTime_ = ctl().t();
+  appendQueuedStepCommands();
+
+  if(limbUpdateTasks_.empty())
+  {
+    for(const auto & limbManager : limbManagerVec_)
+    {
+      limbManager->update();
+    }
+  }
+  else
+  {
+    threadPool_->run(limbUpdateTasks_);
+    for(auto & exception : limbUpdateExceptions_)
+    {
+      if(exception)
+      {
+        std::exception_ptr thrownException = exception;
+        exception = nullptr;
+        std::rethrow_exception(thrownException);
+      }
+    }
+
+    // The actions on the resources shared among limbs are executed in the same order as the serial update
+    for(const auto & limbManager : limbManagerVec_)
+    {
+      limbManager->updateShared();
+    }
+  }
+
+  // The impedance gains depend on the contacts of all limbs, so they are updated after the snapshot is built
+  updateContactSnapshot();
   for(const auto & limbManagerKV : *this)
   {
-    limbManagerKV.second->update();
+    limbManagerKV.second->updateImpGains();
   }
+
+  updateContactSchedule(false);
 }
 
 void LimbManagerSet::stop()
@@ -81,6 +179,9 @@ void LimbManagerSet::stop()
   removeFromGUI(*ctl().gui());
   removeFromLogger(ctl().logger());
 
+  // Stop the socket thread before the limb managers are stopped
+  stepCommandSocket_.reset();
+
   for(const auto & limbManagerKV : *this)
   {
     limbManagerKV.second->stop();
@@ -101,6 +202,223 @@ std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> LimbManagerSet::con
   return contactList;
 }
 
+void LimbManagerSet::updateContactSnapshot()
+{
+  contactSnapshot_.t = ctl().t();
+  contactSnapshot_.limbVec.clear();
+  contactSnapshot_.contactVec.clear();
+  contactSnapshot_.weightVec.clear();
+  for(const auto & limbManagerKV : *this)
+  {
+    const auto & contactCommand = limbManagerKV.second->getContactCommand(ctl().t());
+    if(contactCommand)
+    {
+      contactSnapshot_.limbVec.push_back(limbManagerKV.first);
+      contactSnapshot_.contactVec.push_back(contactCommand->constraint);
+      contactSnapshot_.weightVec.push_back(limbManagerKV.second->getContactWeight(ctl().t()));
+    }
+  }
+}
+
+void LimbManagerSet::setContactScheduleHorizon(double horizon)
+{
+  contactScheduleHorizon_ = horizon;
+  if(ctl().t() + contactScheduleHorizon_ > contactScheduleEndTime_)
+  {
+    updateContactSchedule(true);
+  }
+}
+
+void LimbManagerSet::updateContactSchedule(bool forceRebuild)
+{
+  double t = ctl().t();
+  const auto & segments = contactSchedule_.segments();
+
+  // The current contact constraint may be replaced without changing the commands (e.g., by touch down)
+  auto isCurrentSegmentChanged = [&]() {
+    const auto & contactList = segments.front()->contactList;
+    if(contactList.size() != contactSnapshot_.size())
+    {
+      return true;
+    }
+    for(size_t i = 0; i < contactSnapshot_.size(); i++)
+    {
+      auto it = contactList.find(contactSnapshot_.limbVec[i]);
+      if(it == contactList.end() || it->second != contactSnapshot_.contactVec[i])
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Reuse the previous schedule unless the commands in it are changed, it does not cover the horizon, or the current
+  // time crosses the segment boundary
+  if(!forceRebuild && !segments.empty() && commandChangedTime() > contactScheduleEndTime_
+     && t + contactScheduleHorizon_ <= contactScheduleEndTime_ && (segments.size() == 1 || t < segments[1]->startTime)
+     && !isCurrentSegmentChanged())
+  {
+    return;
+  }
+
+  contactScheduleEndTime_ = t + contactScheduleHorizon_ + config_.contactScheduleMargin;
+  calcContactSchedule(contactSchedule_, {}, contactScheduleEndTime_);
+}
+
+bool LimbManagerSet::calcTouchDownContactSchedule(ContactSchedule & contactSchedule) const
+{
+  std::unordered_map<Limb, std::shared_ptr<ContactCommand>> touchDownContactCommandList;
+  for(const auto & limbManagerKV : *this)
+  {
+    auto touchDownContactCommand = limbManagerKV.second->getTouchDownContactCommand();
+    if(touchDownContactCommand)
+    {
+      touchDownContactCommandList.emplace(limbManagerKV.first, touchDownContactCommand);
+    }
+  }
+  if(touchDownContactCommandList.empty())
+  {
+    return false;
+  }
+
+  calcContactSchedule(contactSchedule, touchDownContactCommandList, contactScheduleEndTime_);
+  return true;
+}
+
+void LimbManagerSet::calcContactSchedule(
+    ContactSchedule & contactSchedule,
+    const std::unordered_map<Limb, std::shared_ptr<ContactCommand>> & touchDownContactCommandList,
+    double endTime) const
+{
+  // Since the contact set changes only at the start times of the contact commands, the contact list needs to be
+  // evaluated only at those times
+  // The timelines are queried at increasing times, so the query of each limb starts from its cursor
+  std::vector<LimbManager::QueryCursor> cursorList(this->size());
+  std::vector<double> switchTimes = {ctl().t()};
+  size_t limbIdx = 0;
+  for(const auto & limbManagerKV : *this)
+  {
+    const auto & contactCommandList = limbManagerKV.second->contactCommandList();
+    for(auto it = contactCommandList.upper_bound(ctl().t(), cursorList[limbIdx].contact);
+        it != contactCommandList.end() && it->first <= endTime; it++)
+    {
+      switchTimes.push_back(it->first);
+    }
+    limbIdx++;
+  }
+  std::sort(switchTimes.begin(), switchTimes.end());
+  switchTimes.erase(std::unique(switchTimes.begin(), switchTimes.end()), switchTimes.end());
+
+  // The contact of the limb touching down starts now instead of at the start time of its contact command
+  std::unordered_map<Limb, double> touchDownContactStartTimes;
+  for(const auto & touchDownKV : touchDownContactCommandList)
+  {
+    touchDownContactStartTimes.emplace(touchDownKV.first,
+                                       at(touchDownKV.first)->contactCommandList().upper_bound(ctl().t())->first);
+  }
+
+  contactSchedule.clear();
+  for(double switchTime : switchTimes)
+  {
+    std::unordered_map<Limb, std::shared_ptr<ContactConstraint>> contactListAtSwitch;
+    limbIdx = 0;
+    for(const auto & limbManagerKV : *this)
+    {
+      const auto & contactCommand = limbManagerKV.second->getContactCommand(switchTime, cursorList[limbIdx++]);
+      if(contactCommand)
+      {
+        contactListAtSwitch.emplace(limbManagerKV.first, contactCommand->constraint);
+      }
+    }
+    for(const auto & touchDownKV : touchDownContactCommandList)
+    {
+      if(switchTime < touchDownContactStartTimes.at(touchDownKV.first))
+      {
+        contactListAtSwitch.emplace(touchDownKV.first, touchDownKV.second->constraint);
+      }
+    }
+    contactSchedule.appendSegment(switchTime, contactListAtSwitch);
+  }
+}
+
+bool LimbManagerSet::appendStepCommands(const std::vector<std::pair<Limb, StepCommand>> & stepCommandList)
+{
+  // Validate the whole sequence before appending
+  std::unordered_map<Limb, LimbManager::LastCommandTimes> lastCommandTimesList;
+  for(size_t i = 0; i < stepCommandList.size(); i++)
+  {
+    const Limb & limb = stepCommandList[i].first;
+    auto limbManagerIt = this->find(limb);
+    if(limbManagerIt == this->end())
+    {
+      mc_rtc::log::error(
+          "[LimbManagerSet] Ignore {} step commands because the limb of the {}-th command is invalid: {}",
+          stepCommandList.size(), i, std::to_string(limb));
+      return false;
+    }
+
+    auto lastCommandTimesIt = lastCommandTimesList.find(limb);
+    if(lastCommandTimesIt == lastCommandTimesList.end())
+    {
+      lastCommandTimesIt = lastCommandTimesList.emplace(limb, limbManagerIt->second->lastCommandTimes()).first;
+    }
+    if(!limbManagerIt->second->checkStepCommand(stepCommandList[i].second, lastCommandTimesIt->second))
+    {
+      mc_rtc::log::error("[LimbManagerSet] Ignore {} step commands because the {}-th command is invalid.",
+                         stepCommandList.size(), i);
+      return false;
+    }
+  }
+
+  // Append all step commands
+  for(const auto & limbStepCommand : stepCommandList)
+  {
+    this->at(limbStepCommand.first)->insertStepCommand(limbStepCommand.second);
+  }
+
+  return true;
+}
+
+bool LimbManagerSet::pushStepCommands(std::vector<std::pair<Limb, StepCommand>> && stepCommandList)
+{
+  StepCommandRequest stepCommandRequest;
+  stepCommandRequest.stepCommandList = std::move(stepCommandList);
+  return stepCommandQueue_->push(std::move(stepCommandRequest));
+}
+
+bool LimbManagerSet::pushStepCommands(StepCommandGenerator && generator)
+{
+  StepCommandRequest stepCommandRequest;
+  stepCommandRequest.generator = std::move(generator);
+  return stepCommandQueue_->push(std::move(stepCommandRequest));
+}
+
+void LimbManagerSet::appendQueuedStepCommands()
+{
+  StepCommandRequest stepCommandRequest;
+  while(stepCommandQueue_->pop(stepCommandRequest))
+  {
+    if(stepCommandRequest.generator)
+    {
+      stepCommandRequest.stepCommandList.clear();
+      try
+      {
+        if(!stepCommandRequest.generator(ctl(), stepCommandRequest.stepCommandList))
+        {
+          continue;
+        }
+      }
+      catch(const std::exception & e)
+      {
+        mc_rtc::log::error("[LimbManagerSet] Ignore the queued step commands because an exception occurred: {}",
+                           e.what());
+        continue;
+      }
+    }
+    appendStepCommands(stepCommandRequest.stepCommandList);
+  }
+}
+
 bool LimbManagerSet::contactCommandStacked() const
 {
   for(const auto & limbManagerKV : *this)
@@ -196,6 +514,7 @@ void LimbManagerSet::addToGUI(mc_rtc::gui::StateBuilder & gui)
   }
 
   SwingTrajCubicSplineSimple::addConfigToGUI(gui, {ctl().name(), config_.name, "SwingTraj", "CubicSplineSimple"});
+  SwingTrajQuinticSimple::addConfigToGUI(gui, {ctl().name(), config_.name, "SwingTraj", "QuinticSimple"});
 }
 
 void LimbManagerSet::removeFromGUI(mc_rtc::gui::StateBuilder & gui)
@@ -203,6 +522,7 @@ void LimbManagerSet::removeFromGUI(mc_rtc::gui::StateBuilder & gui)
   gui.removeCategory({ctl().name(), config_.name});
 
   SwingTrajCubicSplineSimple::removeConfigFromGUI(gui, {ctl().name(), config_.name, "SwingTraj", "CubicSplineSimple"});
+  SwingTrajQuinticSimple::removeConfigFromGUI(gui, {ctl().name(), config_.name, "SwingTraj", "QuinticSimple"});
 
   // GUI of each LimbManager is not removed here (removed via stop method)
 }
@@ -258,3 +578,21 @@ std::array<double, 2> LimbManagerSet::getClosestContactTimes(double t, const std
   }
   return closestContactTimes;
 }
+
+double LimbManagerSet::commandChangedTime() const
+{
+  double changedTime = std::numeric_limits<double>::infinity();
+  for(const auto & limbManagerKV : *this)
+  {
+    changedTime = std::min(changedTime, limbManagerKV.second->commandChangedTime());
+  }
+  return changedTime;
+}
+
+void LimbManagerSet::clearCommandChangedTime()
+{
+  for(const auto & limbManagerKV : *this)
+  {
+    limbManagerKV.second->clearCommandChangedTime();
+  }
+}
@@ -1,8 +1,35 @@
+#include <mutex>
+#include <unordered_map>
+
 #include <MultiContactController/LimbTypes.h>
 
 using namespace MCC;
 
-Limb::Limb(const std::string & _name, const std::string & _group) : name(_name), group(_group)
+namespace
+{
+/** \brief Registry of interned limb names.
+
+    This is accessed through a function-local static variable so that limbs can be constructed during static
+    initialization.
+ */
+struct LimbIdRegistry
+{
+  //! Mutex
+  std::mutex mutex;
+
+  //! Map from interned limb name to ID
+  std::unordered_map<std::string, int> idMap;
+
+  /** \brief Get the instance. */
+  static LimbIdRegistry & instance()
+  {
+    static LimbIdRegistry registry;
+    return registry;
+  }
+};
+} // namespace
+
+Limb::Limb(const std::string & _name, const std::string & _group) : name(_name), group(_group), id(nameToId(_name))
 {
   if(group.empty())
   {
@@ -17,6 +44,20 @@ Limb::Limb(const std::string & _name, const std::string & _group) : name(_name),
   }
 }
 
+int Limb::nameToId(const std::string & _name)
+{
+  auto & registry = LimbIdRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.idMap.emplace(_name, static_cast<int>(registry.idMap.size())).first->second;
+}
+
+int Limb::idNum()
+{
+  auto & registry = LimbIdRegistry::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return static_cast<int>(registry.idMap.size());
+}
+
 std::string std::to_string(const Limb & limb)
 {
   return limb.name;
@@ -24,10 +65,10 @@ std::string std::to_string(const Limb & limb)
 
 bool std::equal_to<Limb>::operator()(const Limb & lhs, const Limb & rhs) const
 {
-  return lhs.name == rhs.name;
+  return lhs.id == rhs.id;
 }
 
 size_t std::hash<Limb>::operator()(const Limb & limb) const
 {
-  return std::hash<std::string>()(limb.name);
+  return std::hash<int>()(limb.id);
 }
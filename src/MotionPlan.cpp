@@ -0,0 +1,177 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/MotionPlan.h>
+
+using namespace MCC;
+
+size_t MotionPlan::compile(const mc_rtc::Configuration & mcRtcConfig, const std::string & path)
+{
+  struct Entry
+  {
+    double time;
+    RecordType type;
+    std::vector<char> payload;
+  };
+  std::vector<Entry> entryList;
+
+  auto addEntries = [&](const std::string & key, RecordType type) {
+    if(!mcRtcConfig.has(key))
+    {
+      return;
+    }
+    for(const auto & entryConfig : mcRtcConfig(key))
+    {
+      Entry entry;
+      entry.time = (type == RecordType::StepCommand ? calcStepCommandTime(entryConfig)
+                                                    : static_cast<double>(entryConfig("time")));
+      entry.type = type;
+      entryConfig.toMessagePack(entry.payload);
+      entryList.push_back(std::move(entry));
+    }
+  };
+  addEntries("stepCommandList", RecordType::StepCommand);
+  addEntries("nominalCentroidalPoseList", RecordType::NominalCentroidalPose);
+  addEntries("nominalPostureList", RecordType::NominalPosture);
+  addEntries("collisionConfigList", RecordType::CollisionConfig);
+  addEntries("taskConfigList", RecordType::TaskConfig);
+
+  // Sort by time while keeping the order of entries at the same time (e.g., step commands of the same limb)
+  std::stable_sort(entryList.begin(), entryList.end(),
+                   [](const Entry & lhs, const Entry & rhs) { return lhs.time < rhs.time; });
+
+  // Make header and records
+  std::vector<Record> records;
+  records.reserve(entryList.size());
+  uint64_t payloadAreaSize = 0;
+  for(const auto & entry : entryList)
+  {
+    if(entry.payload.size() > std::numeric_limits<uint32_t>::max())
+    {
+      mc_rtc::log::error_and_throw("[MotionPlan] Payload is too large: {} bytes.", entry.payload.size());
+    }
+    records.push_back(Record{entry.time, entry.type, static_cast<uint32_t>(entry.payload.size()), payloadAreaSize});
+    payloadAreaSize += entry.payload.size();
+  }
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.recordNum = static_cast<uint32_t>(records.size());
+  header.payloadAreaOffset = sizeof(Header) + sizeof(Record) * records.size();
+  header.payloadAreaSize = payloadAreaSize;
+
+  // Write file
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  if(!ofs)
+  {
+    mc_rtc::log::error_and_throw("[MotionPlan] Failed to open {} for writing.", path);
+  }
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  ofs.write(reinterpret_cast<const char *>(records.data()),
+            static_cast<std::streamsize>(sizeof(Record) * records.size()));
+  for(const auto & entry : entryList)
+  {
+    ofs.write(entry.payload.data(), static_cast<std::streamsize>(entry.payload.size()));
+  }
+  if(!ofs)
+  {
+    mc_rtc::log::error_and_throw("[MotionPlan] Failed to write {}.", path);
+  }
+
+  return records.size();
+}
+
+double MotionPlan::calcStepCommandTime(const mc_rtc::Configuration & stepCommandConfig)
+{
+  if(stepCommandConfig.has("swingCommand") || stepCommandConfig.has("contactCommandList")) // full description format
+  {
+    double time = std::numeric_limits<double>::infinity();
+    if(stepCommandConfig.has("swingCommand"))
+    {
+      time = std::min(time, static_cast<double>(stepCommandConfig("swingCommand")("startTime")));
+    }
+    for(const auto & key : {"contactCommandList", "gripperCommandList"})
+    {
+      if(stepCommandConfig.has(key))
+      {
+        for(const auto & commandConfig : stepCommandConfig(key))
+        {
+          time = std::min(time, static_cast<double>(commandConfig("time")));
+        }
+      }
+    }
+    return time;
+  }
+  else // simple description format
+  {
+    return stepCommandConfig("startTime");
+  }
+}
+
+MotionPlan::MotionPlan(const std::string & path) : path_(path)
+{
+  int fd = open(path_.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    mc_rtc::log::error_and_throw("[MotionPlan] Failed to open {}: {}", path_, std::strerror(errno));
+  }
+  struct stat fileStat;
+  if(fstat(fd, &fileStat) < 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header))
+  {
+    close(fd);
+    mc_rtc::log::error_and_throw("[MotionPlan] Invalid file size: {}", path_);
+  }
+  dataSize_ = static_cast<size_t>(fileStat.st_size);
+  data_ = mmap(nullptr, dataSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data_ == MAP_FAILED)
+  {
+    data_ = nullptr;
+    mc_rtc::log::error_and_throw("[MotionPlan] Failed to map {}: {}", path_, std::strerror(errno));
+  }
+  // Records are read mostly in order
+  madvise(data_, dataSize_, MADV_SEQUENTIAL);
+
+  // Check header
+  header_ = static_cast<const Header *>(data_);
+  if(std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->version != version
+     || header_->payloadAreaOffset != sizeof(Header) + sizeof(Record) * header_->recordNum
+     || header_->payloadAreaOffset + header_->payloadAreaSize > dataSize_)
+  {
+    munmap(data_, dataSize_);
+    data_ = nullptr;
+    mc_rtc::log::error_and_throw("[MotionPlan] Invalid motion plan file (version {} is supported): {}", version,
+                                 path_);
+  }
+  records_ = reinterpret_cast<const Record *>(static_cast<const char *>(data_) + sizeof(Header));
+  payloadArea_ = static_cast<const char *>(data_) + header_->payloadAreaOffset;
+}
+
+MotionPlan::~MotionPlan()
+{
+  if(data_)
+  {
+    munmap(data_, dataSize_);
+  }
+}
+
+mc_rtc::Configuration MotionPlan::payload(size_t idx) const
+{
+  const Record & record = records_[idx];
+  if(record.payloadOffset + record.payloadSize > header_->payloadAreaSize)
+  {
+    mc_rtc::log::error_and_throw("[MotionPlan] Payload of the {}-th record is out of range: {}", idx, path_);
+  }
+  return mc_rtc::Configuration::fromMessagePack(payloadArea_ + record.payloadOffset, record.payloadSize);
+}
@@ -1,5 +1,7 @@
 #include <sys/syscall.h>
 
+#include <chrono>
+
 #include <mc_tasks/CoMTask.h>
 #include <mc_tasks/FirstOrderImpedanceTask.h>
 #include <mc_tasks/MetaTaskLoader.h>
@@ -8,9 +10,14 @@
 
 #include <ForceColl/Contact.h>
 
+#include <MultiContactController/ContactConstraintPool.h>
 #include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
+#include <MultiContactController/OverrunWatchdog.h>
 #include <MultiContactController/PostureManager.h>
+#include <MultiContactController/RealTimeProfile.h>
+#include <MultiContactController/StageTimer.h>
+#include <MultiContactController/ThreadPool.h>
 #include <MultiContactController/centroidal/CentroidalManagerDDP.h>
 #include <MultiContactController/centroidal/CentroidalManagerPC.h>
 #include <MultiContactController/centroidal/CentroidalManagerSRB.h>
@@ -133,12 +140,57 @@ MultiContactController::MultiContactController(mc_rbdyn::RobotModulePtr rm,
     postureManager_ = std::make_shared<PostureManager>(this); // config is not mandatory
   }
 
+  // Setup manager update pipeline
+  // The stages are run in order, and the tasks in each stage, which are independent of each other, are run concurrently
+  threadPool_ = std::make_shared<ThreadPool>(config()("ThreadPool", mc_rtc::Configuration{}));
+  std::vector<std::vector<std::function<void()>>> managerUpdateFuncs = {
+      {[this]() { limbManagerSet_->update(); }, [this]() { centroidalManager_->updateActualState(); },
+       [this]() { postureManager_->update(); }},
+      {[this]() { centroidalManager_->updateControl(); }}};
+  managerUpdateStages_.resize(managerUpdateFuncs.size());
+  managerUpdateExceptions_.resize(managerUpdateFuncs.size());
+  for(size_t stageIdx = 0; stageIdx < managerUpdateFuncs.size(); stageIdx++)
+  {
+    managerUpdateExceptions_[stageIdx].resize(managerUpdateFuncs[stageIdx].size());
+    for(size_t taskIdx = 0; taskIdx < managerUpdateFuncs[stageIdx].size(); taskIdx++)
+    {
+      managerUpdateStages_[stageIdx].push_back(
+          [this, stageIdx, taskIdx, func = std::move(managerUpdateFuncs[stageIdx][taskIdx])]() {
+            try
+            {
+              func();
+            }
+            catch(...)
+            {
+              // The exception is rethrown in the calling thread because the task must not throw
+              managerUpdateExceptions_[stageIdx][taskIdx] = std::current_exception();
+            }
+          });
+    }
+  }
+  if(threadPool_->threadNum() > 0)
+  {
+    mc_rtc::log::info("[MultiContactController] Run the manager update with {} worker threads.",
+                      threadPool_->threadNum());
+  }
+
+  // Setup real-time profile
+  realTimeProfile_ = std::make_shared<RealTimeProfile>(config()("RealTimeProfile", mc_rtc::Configuration{}));
+
+  // Setup overrun watchdog
+  overrunWatchdog_ = std::make_shared<OverrunWatchdog>(config()("OverrunWatchdog", mc_rtc::Configuration{}));
+
+  // Setup stage timer
+  stageTimer_ = std::make_shared<StageTimer>(config()("StageTimer", mc_rtc::Configuration{}));
+
   // Load other configurations
   if(config().has("Contacts"))
   {
     const auto & contactsConfig = config()("Contacts");
     ForceColl::SurfaceContact::loadVerticesMap(contactsConfig("Surface", mc_rtc::Configuration{}));
     ForceColl::GraspContact::loadVerticesMap(contactsConfig("Grasp", mc_rtc::Configuration{}));
+    // The templates made from the previous vertices map are discarded
+    ContactConstraintPool::clear();
   }
   if(config_.has("basePose"))
   {
@@ -182,30 +234,87 @@ void MultiContactController::reset(const mc_control::ControllerResetData & reset
 
   enableManagerUpdate_ = false;
 
-  // Print message to set priority
-  long tid = static_cast<long>(syscall(SYS_gettid));
-  mc_rtc::log::info("[MultiContactController] TID is {}. Run the following command to set high priority:\n  sudo "
-                    "renice -n -20 -p {}",
-                    tid, tid);
-  mc_rtc::log::info("[MultiContactController] You can check the current priority by the following command:\n  ps -p "
-                    "`pgrep choreonoid` -o pid,tid,args,ni,pri,wchan m");
+  overrunWatchdog_->reset();
+  centroidalManager_->setMpcDegradation(overrunWatchdog_->mpcDegradation());
+  if(overrunWatchdog_->config().enabled)
+  {
+    centroidalManager_->setMpcDegradationCandidates(overrunWatchdog_->levelDegradationList());
+  }
+
+  // Apply real-time profile
+  if(realTimeProfile_->config().enabled)
+  {
+    // The MPC worker threads are configured when they are started at the reset of the centroidal manager
+    std::vector<pthread_t> workerThreadList;
+    if(limbManagerSet_)
+    {
+      workerThreadList.push_back(limbManagerSet_->swingTrajPreparationQueue().nativeHandle());
+    }
+    realTimeProfile_->apply({threadPool_.get(), limbManagerSet_ ? &limbManagerSet_->threadPool() : nullptr},
+                            workerThreadList);
+  }
+  else
+  {
+    // Print message to set priority
+    long tid = static_cast<long>(syscall(SYS_gettid));
+    mc_rtc::log::info("[MultiContactController] TID is {}. Run the following command to set high priority:\n  sudo "
+                      "renice -n -20 -p {}",
+                      tid, tid);
+    mc_rtc::log::info("[MultiContactController] You can check the current priority by the following command:\n  ps "
+                      "-p `pgrep choreonoid` -o pid,tid,args,ni,pri,wchan m");
+    mc_rtc::log::info("[MultiContactController] Enable RealTimeProfile in the configuration to apply the real-time "
+                      "settings at reset.");
+  }
 
   mc_rtc::log::success("[MultiContactController] Reset.");
 }
 
 bool MultiContactController::run()
 {
-  t_ += dt();
+  auto startTime = std::chrono::steady_clock::now();
+
+  bool ret = false;
+  {
+    MCC_STAGE_TIMER_SCOPE(*stageTimer_, Cycle);
+
+    t_ += dt();
+
+    if(enableManagerUpdate_)
+    {
+      // Update managers
+      for(size_t stageIdx = 0; stageIdx < managerUpdateStages_.size(); stageIdx++)
+      {
+        threadPool_->run(managerUpdateStages_[stageIdx]);
+        for(auto & exception : managerUpdateExceptions_[stageIdx])
+        {
+          if(exception)
+          {
+            std::exception_ptr thrownException = exception;
+            exception = nullptr;
+            std::rethrow_exception(thrownException);
+          }
+        }
+      }
+    }
+
+    {
+      MCC_STAGE_TIMER_SCOPE(*stageTimer_, Fsm);
+      ret = mc_control::fsm::Controller::run();
+    }
+  }
+  stageTimer_->finishCycle();
 
-  if(enableManagerUpdate_)
+  // Degrade MPC while the control cycles overrun
+  if(overrunWatchdog_->config().enabled)
   {
-    // Update managers
-    limbManagerSet_->update();
-    centroidalManager_->update();
-    postureManager_->update();
+    double cycleDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if(overrunWatchdog_->update(cycleDuration, dt()))
+    {
+      centroidalManager_->setMpcDegradation(overrunWatchdog_->mpcDegradation());
+    }
   }
 
-  return mc_control::fsm::Controller::run();
+  return ret;
 }
 
 void MultiContactController::stop()
@@ -223,6 +332,10 @@ void MultiContactController::stop()
   limbManagerSet_->stop();
   centroidalManager_->stop();
   postureManager_->stop();
+  overrunWatchdog_->removeFromGUI(*gui());
+  overrunWatchdog_->removeFromLogger(logger());
+  stageTimer_->removeFromGUI(*gui());
+  stageTimer_->removeFromLogger(logger());
 
   // Clean up anchor
   setDefaultAnchor();
@@ -0,0 +1,149 @@
+#include <algorithm>
+
+#include <mc_rtc/gui/Label.h>
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/OverrunWatchdog.h>
+
+using namespace MCC;
+
+void OverrunWatchdog::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  mcRtcConfig("enabled", enabled);
+  mcRtcConfig("overrunRatio", overrunRatio);
+  mcRtcConfig("windowSize", windowSize);
+  mcRtcConfig("overrunNumToDegrade", overrunNumToDegrade);
+  mcRtcConfig("headroomRatio", headroomRatio);
+  mcRtcConfig("headroomCycleNumToRecover", headroomCycleNumToRecover);
+  if(mcRtcConfig.has("degradationLadder"))
+  {
+    degradationLadder.clear();
+    for(const auto & degradationConfig : mcRtcConfig("degradationLadder"))
+    {
+      degradationLadder.emplace_back();
+      degradationLadder.back().load(degradationConfig);
+    }
+  }
+
+  if(windowSize < 1 || overrunNumToDegrade < 1 || overrunNumToDegrade > windowSize)
+  {
+    mc_rtc::log::error_and_throw(
+        "[OverrunWatchdog] overrunNumToDegrade must be in [1, windowSize]: {} (windowSize: {})", overrunNumToDegrade,
+        windowSize);
+  }
+  if(headroomRatio >= overrunRatio)
+  {
+    mc_rtc::log::error_and_throw("[OverrunWatchdog] headroomRatio must be smaller than overrunRatio: {} >= {}",
+                                 headroomRatio, overrunRatio);
+  }
+}
+
+OverrunWatchdog::OverrunWatchdog(const mc_rtc::Configuration & mcRtcConfig)
+{
+  config_.load(mcRtcConfig);
+
+  levelDegradationList_.resize(config_.degradationLadder.size() + 1);
+  for(size_t i = 0; i < config_.degradationLadder.size(); i++)
+  {
+    levelDegradationList_[i + 1] = levelDegradationList_[i];
+    levelDegradationList_[i + 1].merge(config_.degradationLadder[i]);
+  }
+
+  overrunWindow_.assign(config_.windowSize, 0);
+}
+
+void OverrunWatchdog::reset()
+{
+  level_ = 0;
+  std::fill(overrunWindow_.begin(), overrunWindow_.end(), 0);
+  overrunWindowIdx_ = 0;
+  overrunNum_ = 0;
+  headroomCycleNum_ = 0;
+  cycleDuration_ = 0;
+  totalOverrunNum_ = 0;
+}
+
+bool OverrunWatchdog::update(double cycleDuration, double dt)
+{
+  cycleDuration_ = cycleDuration;
+
+  // Update the sliding window
+  bool overrun = (cycleDuration > config_.overrunRatio * dt);
+  overrunNum_ += static_cast<int>(overrun) - static_cast<int>(overrunWindow_[overrunWindowIdx_]);
+  overrunWindow_[overrunWindowIdx_] = overrun;
+  overrunWindowIdx_ = (overrunWindowIdx_ + 1) % config_.windowSize;
+  if(overrun)
+  {
+    totalOverrunNum_++;
+  }
+  headroomCycleNum_ = (cycleDuration < config_.headroomRatio * dt ? headroomCycleNum_ + 1 : 0);
+
+  // Degrade
+  int maxLevel = static_cast<int>(config_.degradationLadder.size());
+  if(overrunNum_ >= config_.overrunNumToDegrade && level_ < maxLevel)
+  {
+    mc_rtc::log::warning("[OverrunWatchdog] Degrade MPC to level {}/{} ({}) because {} of the last {} cycles overran "
+                         "(last cycle: {:.3f} ms, period: {:.3f} ms).",
+                         level_ + 1, maxLevel, levelDegradationList_[level_ + 1].description(), overrunNum_,
+                         config_.windowSize, 1e3 * cycleDuration, 1e3 * dt);
+    setLevel(level_ + 1);
+    return true;
+  }
+
+  // Recover
+  if(headroomCycleNum_ >= config_.headroomCycleNumToRecover && level_ > 0)
+  {
+    mc_rtc::log::info("[OverrunWatchdog] Recover MPC to level {}/{} ({}) after {} cycles with headroom.", level_ - 1,
+                      maxLevel, levelDegradationList_[level_ - 1].description(), headroomCycleNum_);
+    setLevel(level_ - 1);
+    return true;
+  }
+
+  return false;
+}
+
+void OverrunWatchdog::addToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category)
+{
+  guiCategory_ = category;
+  gui.addElement(guiCategory_, mc_rtc::gui::Label("enabled", [this]() { return config_.enabled; }),
+                 mc_rtc::gui::Label("level",
+                                    [this]() {
+                                      return std::to_string(level_) + "/"
+                                             + std::to_string(config_.degradationLadder.size());
+                                    }),
+                 mc_rtc::gui::Label("degradation", [this]() { return mpcDegradation().description(); }),
+                 mc_rtc::gui::Label("cycleDuration [ms]", [this]() { return 1e3 * cycleDuration_; }),
+                 mc_rtc::gui::Label("overrunNum in window", [this]() { return overrunNum_; }),
+                 mc_rtc::gui::Label("totalOverrunNum", [this]() { return totalOverrunNum_; }));
+}
+
+void OverrunWatchdog::removeFromGUI(mc_rtc::gui::StateBuilder & gui)
+{
+  if(!guiCategory_.empty())
+  {
+    gui.removeCategory(guiCategory_);
+  }
+}
+
+void OverrunWatchdog::addToLogger(mc_rtc::Logger & logger, const std::string & name)
+{
+  logger.addLogEntry(name + "_cycleDuration", this, [this]() { return cycleDuration_; });
+  logger.addLogEntry(name + "_level", this, [this]() { return level_; });
+  logger.addLogEntry(name + "_overrunNum", this, [this]() { return overrunNum_; });
+}
+
+void OverrunWatchdog::removeFromLogger(mc_rtc::Logger & logger)
+{
+  logger.removeLogEntries(this);
+}
+
+void OverrunWatchdog::setLevel(int level)
+{
+  level_ = level;
+
+  // Clear the statistics so that the next transition is decided by the cycles at the new level
+  std::fill(overrunWindow_.begin(), overrunWindow_.end(), 0);
+  overrunWindowIdx_ = 0;
+  overrunNum_ = 0;
+  headroomCycleNum_ = 0;
+}
@@ -8,6 +8,7 @@
 
 #include <MultiContactController/MultiContactController.h>
 #include <MultiContactController/PostureManager.h>
+#include <MultiContactController/StageTimer.h>
 
 using namespace MCC;
 
@@ -36,6 +37,8 @@ void PostureManager::reset(const PostureManager::PostureMap & initialPosture)
 
 void PostureManager::update()
 {
+  MCC_STAGE_TIMER_SCOPE(*ctl().stageTimer_, PostureManager);
+
   // Set data
   PostureMap nominalPosture = getNominalPosture(ctl().t());
   postureTask_->target(nominalPosture); // this function will do nothing if nominalPosture is empty
@@ -0,0 +1,229 @@
+#include <malloc.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/RealTimeProfile.h>
+#include <MultiContactController/ThreadPool.h>
+
+using namespace MCC;
+
+void RealTimeProfile::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  mcRtcConfig("enabled", enabled);
+  mcRtcConfig("cpuList", cpuList);
+  mcRtcConfig("workerCpuList", workerCpuList);
+  mcRtcConfig("schedPolicy", schedPolicy);
+  mcRtcConfig("priority", priority);
+  mcRtcConfig("workerPriority", workerPriority);
+  mcRtcConfig("lockMemory", lockMemory);
+  mcRtcConfig("prefaultHeapSize", prefaultHeapSize);
+}
+
+RealTimeProfile::RealTimeProfile(const mc_rtc::Configuration & mcRtcConfig)
+{
+  config_.load(mcRtcConfig);
+
+  if(config_.schedPolicy == "FIFO")
+  {
+    schedPolicy_ = SCHED_FIFO;
+  }
+  else if(config_.schedPolicy == "RR")
+  {
+    schedPolicy_ = SCHED_RR;
+  }
+  else if(config_.schedPolicy == "Other")
+  {
+    schedPolicy_ = SCHED_OTHER;
+  }
+  else
+  {
+    mc_rtc::log::error_and_throw("[RealTimeProfile] Invalid schedPolicy: {}.", config_.schedPolicy);
+  }
+
+  if(schedPolicy_ != SCHED_OTHER)
+  {
+    int minPriority = sched_get_priority_min(schedPolicy_);
+    int maxPriority = sched_get_priority_max(schedPolicy_);
+    for(int priority : {config_.priority, config_.workerPriority})
+    {
+      if(priority < minPriority || priority > maxPriority)
+      {
+        mc_rtc::log::error_and_throw("[RealTimeProfile] Priority {} is out of range [{}, {}] for policy {}.",
+                                     priority, minPriority, maxPriority, config_.schedPolicy);
+      }
+    }
+  }
+}
+
+bool RealTimeProfile::apply(const std::vector<ThreadPool *> & threadPoolList,
+                            const std::vector<pthread_t> & workerThreadList) const
+{
+  bool success = true;
+
+  // Lock and prefault the memory before the real-time scheduling
+  if(config_.lockMemory)
+  {
+    success = lockMemory() && success;
+  }
+  if(config_.prefaultHeapSize > 0)
+  {
+    prefaultHeap();
+  }
+
+  // Control thread
+  if(!config_.cpuList.empty())
+  {
+    success = setAffinity(pthread_self(), config_.cpuList, "control thread") && success;
+  }
+  if(schedPolicy_ != SCHED_OTHER)
+  {
+    success = setScheduling(pthread_self(), config_.priority, "control thread") && success;
+  }
+
+  // Worker threads
+  for(auto * threadPool : threadPoolList)
+  {
+    if(!threadPool)
+    {
+      continue;
+    }
+    auto nativeHandles = threadPool->nativeHandles();
+    for(size_t i = 0; i < nativeHandles.size(); i++)
+    {
+      std::string threadDesc = std::to_string(i) + "-th worker thread";
+      // The worker threads pinned by the thread pool configuration are not overwritten
+      if(threadPool->config().cpuList.empty() && !config_.workerCpuList.empty())
+      {
+        success = setAffinity(nativeHandles[i], config_.workerCpuList, threadDesc) && success;
+      }
+      if(schedPolicy_ != SCHED_OTHER)
+      {
+        success = setScheduling(nativeHandles[i], config_.workerPriority, threadDesc) && success;
+      }
+    }
+  }
+  success = applyToWorkerThreads(workerThreadList, "worker thread") && success;
+
+  long tid = static_cast<long>(syscall(SYS_gettid));
+  if(success)
+  {
+    mc_rtc::log::success("[RealTimeProfile] Applied the real-time profile to the control thread (TID: {}).", tid);
+  }
+  else
+  {
+    mc_rtc::log::warning("[RealTimeProfile] Some settings of the real-time profile are not applied. The control thread "
+                         "(TID: {}) may suffer from jitter.",
+                         tid);
+  }
+
+  return success;
+}
+
+bool RealTimeProfile::applyToWorkerThreads(const std::vector<pthread_t> & workerThreadList,
+                                           const std::string & threadDesc) const
+{
+  bool success = true;
+
+  for(size_t i = 0; i < workerThreadList.size(); i++)
+  {
+    std::string desc = std::to_string(i) + "-th " + threadDesc;
+    if(!config_.workerCpuList.empty())
+    {
+      success = setAffinity(workerThreadList[i], config_.workerCpuList, desc) && success;
+    }
+    if(schedPolicy_ != SCHED_OTHER)
+    {
+      success = setScheduling(workerThreadList[i], config_.workerPriority, desc) && success;
+    }
+  }
+
+  return success;
+}
+
+bool RealTimeProfile::setAffinity(pthread_t thread,
+                                  const std::vector<int> & cpuList,
+                                  const std::string & threadDesc) const
+{
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  for(int cpu : cpuList)
+  {
+    CPU_SET(cpu, &cpuSet);
+  }
+  int ret = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuSet);
+  if(ret != 0)
+  {
+    mc_rtc::log::warning("[RealTimeProfile] Failed to pin the {} to the CPUs: {}", threadDesc, std::strerror(ret));
+    return false;
+  }
+  return true;
+}
+
+bool RealTimeProfile::setScheduling(pthread_t thread, int priority, const std::string & threadDesc) const
+{
+  sched_param param = {};
+  param.sched_priority = priority;
+  int ret = pthread_setschedparam(thread, schedPolicy_, &param);
+  if(ret == EPERM)
+  {
+    rlimit limit;
+    getrlimit(RLIMIT_RTPRIO, &limit);
+    mc_rtc::log::warning("[RealTimeProfile] Not permitted to set the {} scheduling with priority {} for the {} "
+                         "(RLIMIT_RTPRIO: {}). Grant CAP_SYS_NICE or set \"rtprio\" in /etc/security/limits.conf.",
+                         config_.schedPolicy, priority, threadDesc, limit.rlim_cur);
+    return false;
+  }
+  else if(ret != 0)
+  {
+    mc_rtc::log::warning("[RealTimeProfile] Failed to set the {} scheduling with priority {} for the {}: {}",
+                         config_.schedPolicy, priority, threadDesc, std::strerror(ret));
+    return false;
+  }
+  return true;
+}
+
+bool RealTimeProfile::lockMemory() const
+{
+  if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    std::string errorStr = std::strerror(errno);
+    rlimit limit;
+    getrlimit(RLIMIT_MEMLOCK, &limit);
+    mc_rtc::log::warning("[RealTimeProfile] Failed to lock the memory (RLIMIT_MEMLOCK: {}): {}. Grant CAP_IPC_LOCK or "
+                         "set \"memlock\" in /etc/security/limits.conf.",
+                         limit.rlim_cur, errorStr);
+    return false;
+  }
+  return true;
+}
+
+void RealTimeProfile::prefaultHeap() const
+{
+  // Keep the freed memory in the heap instead of returning it to the system
+  mallopt(M_TRIM_THRESHOLD, -1);
+  mallopt(M_MMAP_MAX, 0);
+
+  // Touch each page so that the subsequent allocations do not cause page faults
+  // The volatile pointer prevents the compiler from eliding the writes to the memory that is freed immediately
+  volatile char * buf = static_cast<char *>(malloc(config_.prefaultHeapSize));
+  if(!buf)
+  {
+    mc_rtc::log::warning("[RealTimeProfile] Failed to allocate {} bytes to prefault the heap.",
+                         config_.prefaultHeapSize);
+    return;
+  }
+  long pageSize = sysconf(_SC_PAGESIZE);
+  for(size_t i = 0; i < config_.prefaultHeapSize; i += static_cast<size_t>(pageSize))
+  {
+    buf[i] = 0;
+  }
+  free(const_cast<char *>(buf));
+}
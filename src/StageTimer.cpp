@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cmath>
+
+#include <mc_rtc/gui/ArrayLabel.h>
+
+#include <MultiContactController/StageTimer.h>
+
+using namespace MCC;
+
+LatencyHistogram::LatencyHistogram(int windowSize) : windowBucketIdxList_(std::max(windowSize, 1), 0) {}
+
+void LatencyHistogram::add(double latency)
+{
+  int idx = bucketIdx(latency);
+  if(sampleNum_ == static_cast<int>(windowBucketIdxList_.size()))
+  {
+    bucketCounts_[windowBucketIdxList_[windowIdx_]]--;
+  }
+  else
+  {
+    sampleNum_++;
+  }
+  bucketCounts_[idx]++;
+  windowBucketIdxList_[windowIdx_] = static_cast<uint16_t>(idx);
+  windowIdx_ = (windowIdx_ + 1) % static_cast<int>(windowBucketIdxList_.size());
+}
+
+void LatencyHistogram::clear()
+{
+  bucketCounts_.fill(0);
+  windowIdx_ = 0;
+  sampleNum_ = 0;
+}
+
+double LatencyHistogram::percentile(double ratio) const
+{
+  if(sampleNum_ == 0)
+  {
+    return 0;
+  }
+
+  int rank = std::clamp(static_cast<int>(std::ceil(ratio * sampleNum_)), 1, sampleNum_);
+  int count = 0;
+  for(int i = 0; i < bucketNum; i++)
+  {
+    count += bucketCounts_[i];
+    if(count >= rank)
+    {
+      return bucketUpperBound(i);
+    }
+  }
+  return bucketUpperBound(bucketNum - 1);
+}
+
+int LatencyHistogram::bucketIdx(double latency)
+{
+  double latencyUs = 1e3 * latency;
+  if(!(latencyUs >= 1.0))
+  {
+    return 0;
+  }
+
+  // latencyUs = mantissa * 2^exponent where mantissa is in [0.5, 1)
+  int exponent;
+  double mantissa = std::frexp(latencyUs, &exponent);
+  int octave = exponent - 1;
+  if(octave >= octaveNum)
+  {
+    return bucketNum - 1;
+  }
+  int subBucket = std::min(static_cast<int>((2.0 * mantissa - 1.0) * subBucketNum), subBucketNum - 1);
+  return 1 + octave * subBucketNum + subBucket;
+}
+
+double LatencyHistogram::bucketUpperBound(int bucketIdx)
+{
+  if(bucketIdx == 0)
+  {
+    return 1e-3;
+  }
+  int octave = (bucketIdx - 1) / subBucketNum;
+  int subBucket = (bucketIdx - 1) % subBucketNum;
+  return 1e-3 * std::ldexp(1.0 + static_cast<double>(subBucket + 1) / subBucketNum, octave);
+}
+
+const char * StageTimer::stageName(Stage stage)
+{
+  switch(stage)
+  {
+    case Stage::LimbManager:
+      return "LimbManager";
+    case Stage::RefData:
+      return "RefData";
+    case Stage::Mpc:
+      return "Mpc";
+    case Stage::WrenchDist:
+      return "WrenchDist";
+    case Stage::GuiMarker:
+      return "GuiMarker";
+    case Stage::PostureManager:
+      return "PostureManager";
+    case Stage::Fsm:
+      return "Fsm";
+    case Stage::Cycle:
+      return "Cycle";
+  }
+  return "Unknown";
+}
+
+void StageTimer::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  mcRtcConfig("histogramWindowSize", histogramWindowSize);
+}
+
+StageTimer::StageTimer(const mc_rtc::Configuration & mcRtcConfig)
+{
+  config_.load(mcRtcConfig);
+
+  for(auto & stageData : stageDataList_)
+  {
+    stageData.histogram = LatencyHistogram(config_.histogramWindowSize);
+  }
+}
+
+void StageTimer::finishCycle()
+{
+#ifdef MCC_ENABLE_STAGE_TIMER
+  for(auto & stageData : stageDataList_)
+  {
+    stageData.lastDuration = stageData.duration;
+    stageData.histogram.add(stageData.duration);
+    stageData.duration = 0;
+  }
+#endif
+}
+
+void StageTimer::addToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category)
+{
+#ifdef MCC_ENABLE_STAGE_TIMER
+  guiCategory_ = category;
+  for(int i = 0; i < stageNum; i++)
+  {
+    const auto & histogram = stageDataList_[i].histogram;
+    gui.addElement(guiCategory_, mc_rtc::gui::ArrayLabel(std::string(stageName(static_cast<Stage>(i))) + " [ms]",
+                                                         {"p50", "p99", "p99.9", "max"}, [&histogram]() {
+                                                           return Eigen::Vector4d(
+                                                               histogram.percentile(0.5), histogram.percentile(0.99),
+                                                               histogram.percentile(0.999), histogram.max());
+                                                         }));
+  }
+#else
+  (void)gui;
+  (void)category;
+#endif
+}
+
+void StageTimer::removeFromGUI(mc_rtc::gui::StateBuilder & gui)
+{
+  if(!guiCategory_.empty())
+  {
+    gui.removeCategory(guiCategory_);
+  }
+}
+
+void StageTimer::addToLogger(mc_rtc::Logger & logger, const std::string & name)
+{
+#ifdef MCC_ENABLE_STAGE_TIMER
+  for(int i = 0; i < stageNum; i++)
+  {
+    const auto & stageData = stageDataList_[i];
+    logger.addLogEntry(name + "_" + stageName(static_cast<Stage>(i)) + "_duration", this,
+                       [&stageData]() { return stageData.lastDuration; });
+  }
+#else
+  (void)logger;
+  (void)name;
+#endif
+}
+
+void StageTimer::removeFromLogger(mc_rtc::Logger & logger)
+{
+  logger.removeLogEntries(this);
+}
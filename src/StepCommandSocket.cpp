@@ -0,0 +1,166 @@
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/LimbManagerSet.h>
+#include <MultiContactController/StepCommandSocket.h>
+
+using namespace MCC;
+
+StepCommandSocket::StepCommandSocket(LimbManagerSet * limbManagerSet, const std::string & path)
+: limbManagerSet_(limbManagerSet), path_(path)
+{
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if(path_.empty() || path_.size() >= sizeof(addr.sun_path))
+  {
+    mc_rtc::log::error_and_throw("[StepCommandSocket] Invalid socket path: {}", path_);
+  }
+  std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+
+  listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listenFd_ < 0)
+  {
+    mc_rtc::log::error_and_throw("[StepCommandSocket] Failed to create socket: {}", std::strerror(errno));
+  }
+  unlink(path_.c_str());
+  if(bind(listenFd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listenFd_, 4) < 0)
+  {
+    std::string errorStr = std::strerror(errno);
+    close(listenFd_);
+    mc_rtc::log::error_and_throw("[StepCommandSocket] Failed to listen on {}: {}", path_, errorStr);
+  }
+
+  thread_ = std::thread(&StepCommandSocket::serve, this);
+  mc_rtc::log::info("[StepCommandSocket] Listening on {}", path_);
+}
+
+StepCommandSocket::~StepCommandSocket()
+{
+  stopRequested_ = true;
+  if(thread_.joinable())
+  {
+    thread_.join();
+  }
+  close(listenFd_);
+  unlink(path_.c_str());
+}
+
+void StepCommandSocket::serve()
+{
+  std::vector<Client> clients;
+  std::vector<pollfd> pollFds;
+  while(!stopRequested_)
+  {
+    // The timeout bounds the delay to stop the thread
+    constexpr int timeoutMs = 100;
+    pollFds.clear();
+    pollFds.push_back(pollfd{listenFd_, POLLIN, 0});
+    for(const auto & client : clients)
+    {
+      pollFds.push_back(pollfd{client.fd, POLLIN, 0});
+    }
+    if(poll(pollFds.data(), pollFds.size(), timeoutMs) <= 0)
+    {
+      continue;
+    }
+
+    // Receive from the existing clients
+    for(size_t i = clients.size(); i > 0; i--)
+    {
+      if(pollFds[i].revents != 0 && !receive(clients[i - 1]))
+      {
+        close(clients[i - 1].fd);
+        clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i - 1));
+      }
+    }
+
+    // Accept a new client
+    if(pollFds[0].revents & POLLIN)
+    {
+      int fd = accept(listenFd_, nullptr, nullptr);
+      if(fd >= 0)
+      {
+        clients.push_back(Client{fd, {}});
+      }
+    }
+  }
+
+  for(const auto & client : clients)
+  {
+    close(client.fd);
+  }
+}
+
+bool StepCommandSocket::receive(Client & client)
+{
+  char buf[4096];
+  ssize_t size = recv(client.fd, buf, sizeof(buf), 0);
+  if(size <= 0)
+  {
+    return size < 0 && (errno == EINTR || errno == EAGAIN);
+  }
+  client.buffer.insert(client.buffer.end(), buf, buf + size);
+
+  // Process all the complete messages
+  size_t offset = 0;
+  while(client.buffer.size() - offset >= sizeof(uint32_t))
+  {
+    uint32_t payloadSize;
+    std::memcpy(&payloadSize, client.buffer.data() + offset, sizeof(uint32_t));
+    if(payloadSize > maxPayloadSize)
+    {
+      mc_rtc::log::error("[StepCommandSocket] Close the connection because the payload is too large: {} bytes.",
+                         payloadSize);
+      return false;
+    }
+    if(client.buffer.size() - offset - sizeof(uint32_t) < payloadSize)
+    {
+      break;
+    }
+    try
+    {
+      processMessage(
+          mc_rtc::Configuration::fromMessagePack(client.buffer.data() + offset + sizeof(uint32_t), payloadSize));
+    }
+    catch(const std::exception & e)
+    {
+      mc_rtc::log::error("[StepCommandSocket] Ignore the message because an exception occurred: {}", e.what());
+    }
+    offset += sizeof(uint32_t) + payloadSize;
+  }
+  client.buffer.erase(client.buffer.begin(), client.buffer.begin() + static_cast<std::ptrdiff_t>(offset));
+
+  return true;
+}
+
+void StepCommandSocket::processMessage(const mc_rtc::Configuration & payload)
+{
+  bool relativeTime = payload("relativeTime", false);
+  double baseTime = limbManagerSet_->lastUpdateTime();
+
+  // The step commands of a message are allocated from the arena, which is released when they are all finished
+  auto arena = std::make_shared<CommandArena>();
+  std::vector<std::pair<Limb, StepCommand>> stepCommandList;
+  for(const auto & stepCommandConfig : payload("stepCommandList"))
+  {
+    StepCommand stepCommand = StepCommand(stepCommandConfig, arena);
+    if(relativeTime)
+    {
+      stepCommand.setBaseTime(baseTime);
+    }
+    stepCommandList.emplace_back(Limb(stepCommandConfig("limb")), std::move(stepCommand));
+  }
+
+  if(!limbManagerSet_->pushStepCommands(std::move(stepCommandList)))
+  {
+    mc_rtc::log::error("[StepCommandSocket] Ignore the message because the step command queue is full.");
+  }
+}
@@ -0,0 +1,56 @@
+#include <cmath>
+
+#include <MultiContactController/SwingTraj.h>
+
+using namespace MCC;
+
+const SwingTraj::Sample & SwingTraj::evaluate(double t) const
+{
+  if(lastSampleValid_ && lastSample_.t == t)
+  {
+    return lastSample_;
+  }
+
+  // Use the lookup table if the time matches a sample time before touch down
+  const std::vector<Sample> & sampleList = lookupTable_.sampleList;
+  if(!sampleList.empty() && (touchDownTime_ < 0 || t < touchDownTime_))
+  {
+    long long idx = std::llround((t - startTime_) / lookupTable_.step);
+    if(0 <= idx && idx < static_cast<long long>(sampleList.size())
+       && std::abs(t - sampleList[idx].t) <= 1e-6 * lookupTable_.step)
+    {
+      return sampleList[idx];
+    }
+  }
+
+  calcSample(t, lastSample_);
+  lastSampleValid_ = true;
+  return lastSample_;
+}
+
+void SwingTraj::calcSample(double t, Sample & sample) const
+{
+  sample.t = t;
+  sample.pose = pose(t);
+  sample.vel = vel(t);
+  sample.accel = accel(t);
+  sample.taskGain = taskGain(t);
+}
+
+SwingTraj::LookupTable SwingTraj::calcLookupTable(double step) const
+{
+  LookupTable lookupTable;
+  lookupTable.step = step;
+  if(step <= 0)
+  {
+    return lookupTable;
+  }
+
+  int sampleNum = static_cast<int>(std::floor((endTime_ - startTime_) / step + 1e-6)) + 1;
+  lookupTable.sampleList.resize(sampleNum);
+  for(int i = 0; i < sampleNum; i++)
+  {
+    calcSample(startTime_ + i * step, lookupTable.sampleList[i]);
+  }
+  return lookupTable;
+}
@@ -0,0 +1,36 @@
+#include <MultiContactController/TaskQueue.h>
+
+using namespace MCC;
+
+TaskQueue::TaskQueue() : thread_(&TaskQueue::work, this) {}
+
+TaskQueue::~TaskQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopRequested_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+void TaskQueue::work()
+{
+  while(true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [&]() { return stopRequested_ || !tasks_.empty(); });
+      if(stopRequested_)
+      {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+
+    // The task does not throw because the exception is stored in the future by std::packaged_task
+    task();
+  }
+}
@@ -0,0 +1,154 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+
+#include <mc_rtc/logging.h>
+
+#include <MultiContactController/ThreadPool.h>
+
+using namespace MCC;
+
+void ThreadPool::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  mcRtcConfig("threadNum", threadNum);
+  mcRtcConfig("cpuList", cpuList);
+}
+
+ThreadPool::ThreadPool(const mc_rtc::Configuration & mcRtcConfig)
+{
+  config_.load(mcRtcConfig);
+
+  threads_.reserve(static_cast<size_t>(std::max(config_.threadNum, 0)));
+  for(int i = 0; i < config_.threadNum; i++)
+  {
+    threads_.emplace_back(&ThreadPool::work, this);
+
+    if(!config_.cpuList.empty())
+    {
+      int cpu = config_.cpuList[static_cast<size_t>(i) % config_.cpuList.size()];
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      CPU_SET(cpu, &cpuSet);
+      if(pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpu_set_t), &cpuSet) != 0)
+      {
+        mc_rtc::log::warning("[ThreadPool] Failed to pin the {}-th worker thread to CPU {}.", i, cpu);
+      }
+    }
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopRequested_ = true;
+  }
+  cond_.notify_all();
+  for(auto & thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+std::vector<std::thread::native_handle_type> ThreadPool::nativeHandles()
+{
+  std::vector<std::thread::native_handle_type> handles;
+  for(auto & thread : threads_)
+  {
+    handles.push_back(thread.native_handle());
+  }
+  return handles;
+}
+
+void ThreadPool::run(const std::vector<std::function<void()>> & tasks)
+{
+  if(threads_.empty() || tasks.size() <= 1)
+  {
+    for(const auto & task : tasks)
+    {
+      task();
+    }
+    return;
+  }
+
+  // Publish the tasks
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nextTaskIdx_.store(0, std::memory_order_relaxed);
+    finishedTaskNum_.store(0, std::memory_order_relaxed);
+    tasks_ = &tasks;
+    generation_++;
+  }
+  cond_.notify_all();
+
+  // Run the tasks also in the calling thread
+  runTasks(tasks);
+
+  // Wait until all the tasks are finished, then withdraw the tasks and wait for the workers that have taken them so
+  // that the next run can reset the indices
+  std::unique_lock<std::mutex> lock(mutex_);
+  doneCond_.wait(lock, [&]() { return finishedTaskNum_.load(std::memory_order_acquire) == tasks.size(); });
+  tasks_ = nullptr;
+  doneCond_.wait(lock, [&]() { return busyThreadNum_ == 0; });
+}
+
+void ThreadPool::work()
+{
+  size_t generation = 0;
+  while(true)
+  {
+    const std::vector<std::function<void()>> * tasks = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [&]() { return stopRequested_ || generation_ != generation; });
+      if(stopRequested_)
+      {
+        return;
+      }
+      generation = generation_;
+      tasks = tasks_;
+      if(!tasks)
+      {
+        // The tasks have already been finished by other threads
+        continue;
+      }
+      busyThreadNum_++;
+    }
+
+    runTasks(*tasks);
+
+    bool isLastBusyThread = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busyThreadNum_--;
+      isLastBusyThread = (busyThreadNum_ == 0);
+    }
+    if(isLastBusyThread)
+    {
+      doneCond_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::runTasks(const std::vector<std::function<void()>> & tasks)
+{
+  while(true)
+  {
+    size_t taskIdx = nextTaskIdx_.fetch_add(1, std::memory_order_relaxed);
+    if(taskIdx >= tasks.size())
+    {
+      break;
+    }
+    tasks[taskIdx]();
+    if(finishedTaskNum_.fetch_add(1, std::memory_order_acq_rel) + 1 == tasks.size())
+    {
+      // The mutex is locked once so that the notification is not lost between the check and the wait of the calling
+      // thread
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+      }
+      doneCond_.notify_one();
+    }
+  }
+}
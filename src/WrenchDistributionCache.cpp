@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include <ForceColl/Contact.h>
+#include <ForceColl/WrenchDistribution.h>
+
+#include <MultiContactController/WrenchDistributionCache.h>
+
+using namespace MCC;
+
+bool WrenchDistributionCache::Entry::KeyElement::operator==(const KeyElement & other) const
+{
+  return limbName == other.limbName && constraintType == other.constraintType && geometry == other.geometry;
+}
+
+const WrenchDistributionCache::Entry & WrenchDistributionCache::get(const ContactSchedule::Segment & segment,
+                                                                    const mc_rtc::Configuration & wrenchDistConfig,
+                                                                    int capacity)
+{
+  // Skip the key calculation if the contact constraints are the same objects as those of the last call
+  // The constraints are not updated in place (see ContactConstraintPool), and the constraints of the last call are held
+  // here, so the same address means the same content
+  if(!entryList_.empty() && segment.contactVec == lastContactVec_
+     && std::equal(segment.limbVec.begin(), segment.limbVec.end(), lastLimbVec_.begin(), lastLimbVec_.end(),
+                   std::equal_to<Limb>()))
+  {
+    lastHit_ = true;
+    return entryList_.front();
+  }
+  lastLimbVec_ = segment.limbVec;
+  lastContactVec_ = segment.contactVec;
+
+  auto key = calcKey(segment);
+
+  // Search the cache and move the found entry to the front
+  auto it = std::find_if(entryList_.begin(), entryList_.end(), [&](const Entry & entry) { return entry.key == key; });
+  lastHit_ = (it != entryList_.end());
+  if(lastHit_)
+  {
+    entryList_.splice(entryList_.begin(), entryList_, it);
+    return entryList_.front();
+  }
+
+  // Construct a new entry
+  Entry entry;
+  entry.key = std::move(key);
+  entry.limbVec = segment.limbVec;
+  entry.contactVec = segment.contactVec;
+  entry.wrenchDist = std::make_shared<ForceColl::WrenchDistribution>(entry.contactVec, wrenchDistConfig);
+  entryList_.push_front(std::move(entry));
+
+  // Evict the least recently used entries (the new entry is always kept even if the cache is disabled)
+  while(entryList_.size() > static_cast<size_t>(std::max(capacity, 1)))
+  {
+    entryList_.pop_back();
+  }
+
+  return entryList_.front();
+}
+
+std::vector<WrenchDistributionCache::Entry::KeyElement> WrenchDistributionCache::calcKey(
+    const ContactSchedule::Segment & segment)
+{
+  std::vector<Entry::KeyElement> key;
+  key.reserve(segment.contactVec.size());
+  for(size_t i = 0; i < segment.contactVec.size(); i++)
+  {
+    const auto & constraint = segment.contactVec[i];
+
+    // Global vertices differ among the constraints made from the same template, so they are included in the key
+    std::vector<double> geometry;
+    for(const auto & vertexWithRidge : constraint->vertexWithRidgeList_)
+    {
+      geometry.insert(geometry.end(), vertexWithRidge.vertex.data(),
+                      vertexWithRidge.vertex.data() + vertexWithRidge.vertex.size());
+      for(const auto & ridge : vertexWithRidge.ridgeList)
+      {
+        geometry.insert(geometry.end(), ridge.data(), ridge.data() + ridge.size());
+      }
+    }
+
+    key.push_back(Entry::KeyElement{segment.limbVec[i].name, constraint->type(), std::move(geometry)});
+  }
+  std::sort(key.begin(), key.end(),
+            [](const Entry::KeyElement & lhs, const Entry::KeyElement & rhs) { return lhs.limbName < rhs.limbName; });
+  return key;
+}
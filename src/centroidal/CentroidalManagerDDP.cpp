@@ -1,10 +1,14 @@
+#include <algorithm>
+#include <cmath>
 #include <functional>
 
+#include <mc_rtc/gui/ArrayInput.h>
+#include <mc_rtc/gui/Checkbox.h>
+
 #include <CCC/Constants.h>
 
 #include <ForceColl/Contact.h>
 
-#include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
 #include <MultiContactController/centroidal/CentroidalManagerDDP.h>
 
@@ -17,6 +21,10 @@ void CentroidalManagerDDP::Configuration::load(const mc_rtc::Configuration & mcR
   mcRtcConfig("horizonDuration", horizonDuration);
   mcRtcConfig("horizonDt", horizonDt);
   mcRtcConfig("ddpMaxIter", ddpMaxIter);
+  mcRtcConfig("ddpTimeBudget", ddpTimeBudget);
+  mcRtcConfig("ddpCostImprovementThreshold", ddpCostImprovementThreshold);
+  mcRtcConfig("useTimeShiftedWarmStart", useTimeShiftedWarmStart);
+  mcRtcConfig("useDdpFeedbackGain", useDdpFeedbackGain);
   mcRtcConfig("angularGainP", angularGainP);
   mcRtcConfig("angularGainD", angularGainD);
   if(mcRtcConfig.has("mpcWeightParam"))
@@ -38,24 +46,44 @@ void CentroidalManagerDDP::Configuration::addToLogger(const std::string & baseEn
   MC_RTC_LOG_HELPER(baseEntry + "_horizonDuration", horizonDuration);
   MC_RTC_LOG_HELPER(baseEntry + "_horizonDt", horizonDt);
   MC_RTC_LOG_HELPER(baseEntry + "_ddpMaxIter", ddpMaxIter);
+  MC_RTC_LOG_HELPER(baseEntry + "_ddpTimeBudget", ddpTimeBudget);
+  MC_RTC_LOG_HELPER(baseEntry + "_ddpCostImprovementThreshold", ddpCostImprovementThreshold);
+  MC_RTC_LOG_HELPER(baseEntry + "_useTimeShiftedWarmStart", useTimeShiftedWarmStart);
+  MC_RTC_LOG_HELPER(baseEntry + "_useDdpFeedbackGain", useDdpFeedbackGain);
   MC_RTC_LOG_HELPER(baseEntry + "_angularGainP", angularGainP);
   MC_RTC_LOG_HELPER(baseEntry + "_angularGainD", angularGainD);
 }
 
 CentroidalManagerDDP::CentroidalManagerDDP(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig)
-: CentroidalManager(ctlPtr, mcRtcConfig)
+: CentroidalManagerDdpBase(ctlPtr, mcRtcConfig)
 {
   config_.load(mcRtcConfig);
 }
 
+CentroidalManagerDDP::~CentroidalManagerDDP()
+{
+  stopMpcWorkers();
+}
+
 void CentroidalManagerDDP::reset()
 {
-  CentroidalManager::reset();
+  CentroidalManagerDdpBase::reset();
 
-  ddp_ = std::make_shared<CCC::DdpCentroidal>(robotMass_, config_.horizonDt,
-                                              static_cast<int>(std::floor(config_.horizonDuration / config_.horizonDt)),
-                                              config_.mpcWeightParam);
-  ddp_->ddp_solver_->config().max_iter = config_.ddpMaxIter;
+  // Build DDP for each horizon in advance so that it is not built while the control is running
+  for(auto & ddpList : ddpList_)
+  {
+    ddpList.clear();
+  }
+  for(const auto & mpcDegradation : solverHorizonList_)
+  {
+    ddpList_[0].push_back(makeDdp(mpcDegradation));
+    if(config().enableSpeculativeMpc)
+    {
+      ddpList_[1].push_back(makeDdp(mpcDegradation));
+    }
+  }
+  ddp_ = ddpList_[0][solverHorizonIdx(mpcDegradation_)];
+  speculativeDdp_ = (config().enableSpeculativeMpc ? ddpList_[1][solverHorizonIdx(mpcDegradation_)] : nullptr);
 }
 
 void CentroidalManagerDDP::addToGUI(mc_rtc::gui::StateBuilder & gui)
@@ -64,6 +92,9 @@ void CentroidalManagerDDP::addToGUI(mc_rtc::gui::StateBuilder & gui)
 
   gui.addElement(
       {ctl().name(), config_.name, "Config"},
+      mc_rtc::gui::Checkbox(
+          "useDdpFeedbackGain", [this]() { return config_.useDdpFeedbackGain; },
+          [this]() { config_.useDdpFeedbackGain = !config_.useDdpFeedbackGain; }),
       mc_rtc::gui::ArrayInput(
           "Angular P-Gain", {"x", "y", "z"}, [this]() -> const Eigen::Vector3d & { return config_.angularGainP; },
           [this](const Eigen::Vector3d & v) { config_.angularGainP = v; }),
@@ -76,67 +107,194 @@ void CentroidalManagerDDP::addToLogger(mc_rtc::Logger & logger)
 {
   CentroidalManager::addToLogger(logger);
 
+  // The solver may be running in the MPC worker thread, so log the copies in mpcData_
   logger.addLogEntry(config_.name + "_DDP_computationDuration", this,
-                     [this]() { return ddp_->ddp_solver_->computationDuration().solve; });
-  logger.addLogEntry(config_.name + "_DDP_iter", this, [this]() {
-    return ddp_->ddp_solver_->traceDataList().empty() ? 0 : ddp_->ddp_solver_->traceDataList().back().iter;
-  });
+                     [this]() { return mpcData_.computationDuration; });
+  logger.addLogEntry(config_.name + "_DDP_iter", this, [this]() { return mpcData_.iter; });
+  logger.addLogEntry(config_.name + "_DDP_terminationReason", this,
+                     [this]() -> const std::string & { return mpcData_.terminationReason; });
+}
+
+std::shared_ptr<CCC::DdpCentroidal> CentroidalManagerDDP::makeDdp(const MpcDegradation & mpcDegradation) const
+{
+  auto ddp = std::make_shared<CCC::DdpCentroidal>(robotMass_, mpcDegradation.degradeHorizonDt(config_.horizonDt),
+                                                  calcHorizonSteps(mpcDegradation), config_.mpcWeightParam);
+  // If the time budget is used, DDP is iterated one by one in runMpc
+  ddp->ddp_solver_->config().max_iter =
+      (config_.ddpTimeBudget > 0 ? 1 : mpcDegradation.degradeDdpMaxIter(config_.ddpMaxIter));
+  return ddp;
 }
 
-void CentroidalManagerDDP::runMpc()
+void CentroidalManagerDDP::runMpc(MpcData & mpcData)
 {
+  auto & ddp = (mpcData.speculative ? speculativeDdp_ : ddp_);
+  auto & controlData = mpcData.controlData;
+
+  // Switch to DDP built for the horizon of the degradation of MPC, and keep the previous DDP for the warm start
+  std::shared_ptr<CCC::DdpCentroidal> prevDdp = ddp;
+  ddp = ddpList_[solverIdx(mpcData)][solverHorizonIdx(mpcData.degradation)];
+  int ddpMaxIter = mpcData.degradation.degradeDdpMaxIter(config_.ddpMaxIter);
+  ddp->ddp_solver_->config().max_iter = (config_.ddpTimeBudget > 0 ? 1 : ddpMaxIter);
+
   CCC::DdpCentroidal::InitialParam initialParam;
-  initialParam.pos = controlData_.mpcCentroidalPose.translation();
-  initialParam.vel = controlData_.mpcCentroidalVel.linear();
-  initialParam.angular_momentum = controlData_.mpcCentroidalMomentum.moment();
-  initialParam.u_list = ddp_->ddp_solver_->controlData().u_list;
-  if(!initialParam.u_list.empty())
+  initialParam.pos = controlData.mpcCentroidalPose.translation();
+  initialParam.vel = controlData.mpcCentroidalVel.linear();
+  initialParam.angular_momentum = controlData.mpcCentroidalMomentum.moment();
+  if(config_.useTimeShiftedWarmStart)
+  {
+    initialParam.u_list = calcWarmStartInputList(mpcData, prevDdp->ddp_solver_->controlData().u_list);
+  }
+  else if(ddp == prevDdp)
   {
-    for(int i = 0; i < ddp_->ddp_solver_->config().horizon_steps; i++)
+    // Warm start with the previous solution of the same DDP (DDP just switched by the degradation is cold-started)
+    initialParam.u_list = ddp->ddp_solver_->controlData().u_list;
+    if(!initialParam.u_list.empty())
     {
-      double tmpTime = ctl().t() + i * ddp_->ddp_problem_->dt();
-      int inputDim = ddp_->ddp_problem_->inputDim(tmpTime);
-      if(initialParam.u_list[i].size() != inputDim)
+      for(int i = 0; i < ddp->ddp_solver_->config().horizon_steps; i++)
       {
-        initialParam.u_list[i].setZero(inputDim);
+        // Note that inputDim refers to the motion parameter function passed in the previous planOnce call, which
+        // refers to the same mpcData object as this call
+        double tmpTime = mpcData.t + i * ddp->ddp_problem_->dt();
+        int inputDim = ddp->ddp_problem_->inputDim(tmpTime);
+        if(initialParam.u_list[i].size() != inputDim)
+        {
+          initialParam.u_list[i].setZero(inputDim);
+        }
       }
     }
   }
 
-  Eigen::VectorXd plannedForceScales = ddp_->planOnce(
-      std::bind(&CentroidalManagerDDP::calcMpcMotionParam, this, std::placeholders::_1),
-      std::bind(&CentroidalManagerDDP::calcMpcRefData, this, std::placeholders::_1), initialParam, ctl().t());
+  auto motionParamFunc = [this, &mpcData](double t) { return calcMpcMotionParam(mpcData, t); };
+  auto refDataFunc = [this, &mpcData](double t) { return calcMpcRefData(mpcData, t); };
+  Eigen::VectorXd plannedForceScales;
+  if(config_.ddpTimeBudget > 0)
+  {
+    // Run one DDP iteration at a time, continuing from the result of the previous iteration
+    runDdpIterations(mpcData, ddpMaxIter, config_.ddpTimeBudget, config_.ddpCostImprovementThreshold, [&]() {
+      plannedForceScales = ddp->planOnce(motionParamFunc, refDataFunc, initialParam, mpcData.t);
+      initialParam.u_list = ddp->ddp_solver_->controlData().u_list;
+      return ddp->ddp_solver_->traceDataList().back().cost;
+    });
+  }
+  else
+  {
+    plannedForceScales = ddp->planOnce(motionParamFunc, refDataFunc, initialParam, mpcData.t);
+    mpcData.computationDuration = ddp->ddp_solver_->computationDuration().solve;
+    mpcData.iter = ddp->ddp_solver_->traceDataList().empty() ? 0 : ddp->ddp_solver_->traceDataList().back().iter;
+    mpcData.terminationReason = "Solver";
+  }
+  setWarmStartData(mpcData);
 
-  const auto & motionParam = calcMpcMotionParam(ctl().t());
-  controlData_.plannedCentroidalWrench = ForceColl::calcTotalWrench(motionParam.contact_list, plannedForceScales,
-                                                                    controlData_.mpcCentroidalPose.translation());
-  controlData_.plannedCentroidalMomentum = sva::ForceVecd(ddp_->ddp_solver_->controlData().x_list[1].segment<3>(6),
-                                                          ddp_->ddp_solver_->controlData().x_list[1].segment<3>(3));
-  controlData_.plannedCentroidalAccel.linear() =
-      controlData_.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  // Set planned trajectory for interpolation between MPC solves
+  if(requirePlannedTrajectory())
+  {
+    const auto & ddpControlData = ddp->ddp_solver_->controlData();
+    mpcData.plannedWrenchSeq.resize(ddpControlData.u_list.size());
+    for(size_t i = 0; i < ddpControlData.u_list.size(); i++)
+    {
+      mpcData.plannedWrenchSeq[i] =
+          ForceColl::calcTotalWrench(mpcData.contactSchedule.segment(mpcData.t + i * mpcData.horizonDt).contactVec,
+                                     ddpControlData.u_list[i], ddpControlData.x_list[i].head<3>());
+    }
+    mpcData.plannedMomentumSeq.resize(ddpControlData.x_list.size());
+    for(size_t i = 0; i < ddpControlData.x_list.size(); i++)
+    {
+      mpcData.plannedMomentumSeq[i] =
+          sva::ForceVecd(ddpControlData.x_list[i].segment<3>(6), ddpControlData.x_list[i].segment<3>(3));
+    }
+  }
+  else
+  {
+    mpcData.plannedWrenchSeq.clear();
+    mpcData.plannedMomentumSeq.clear();
+  }
+
+  // Set local feedback policy of DDP
+  if(mpcData.requireFeedbackGain)
+  {
+    const auto & ddpControlData = ddp->ddp_solver_->controlData();
+    mpcData.plannedStateSeq = ddpControlData.x_list;
+    mpcData.plannedInputSeq = ddpControlData.u_list;
+    mpcData.feedbackGainSeq.assign(ddpControlData.K_list.begin(), ddpControlData.K_list.end());
+  }
+  else
+  {
+    mpcData.plannedStateSeq.clear();
+    mpcData.plannedInputSeq.clear();
+    mpcData.feedbackGainSeq.clear();
+  }
+
+  const auto & motionParam = calcMpcMotionParam(mpcData, mpcData.t);
+  controlData.plannedCentroidalWrench = ForceColl::calcTotalWrench(motionParam.contact_list, plannedForceScales,
+                                                                   controlData.mpcCentroidalPose.translation());
+  controlData.plannedCentroidalMomentum = sva::ForceVecd(ddp->ddp_solver_->controlData().x_list[1].segment<3>(6),
+                                                         ddp->ddp_solver_->controlData().x_list[1].segment<3>(3));
+  controlData.plannedCentroidalAccel.linear() =
+      controlData.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  controlData.plannedCentroidalAccel.angular() = calcPlannedCentroidalAngularAccel(controlData, mpcData.refData);
+}
+
+Eigen::Vector3d CentroidalManagerDDP::calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                                        const RefData & refData) const
+{
   // DdpCentroidal does not explicitly handle orientation (instead it only handles angular momentum), so apply simple PD
   // feedback to track the reference orientation
+  return -1
+             * config_.angularGainP.cwiseProduct(
+                 sva::rotationError(refData.centroidalPose.rotation(), controlData.mpcCentroidalPose.rotation()))
+         + -1 * config_.angularGainD.cwiseProduct(controlData.mpcCentroidalVel.angular());
+}
+
+void CentroidalManagerDDP::applyMpcData(const MpcData & mpcData)
+{
+  CentroidalManager::applyMpcData(mpcData);
+
+  if(!config_.useDdpFeedbackGain || mpcData.feedbackGainSeq.empty())
+  {
+    return;
+  }
+
+  // Get the node of DDP at the current time (the input is piecewise constant between nodes)
+  int nodeNum = static_cast<int>(mpcData.feedbackGainSeq.size());
+  double nodePos = std::clamp((ctl().t() - mpcData.t) / mpcData.horizonDt, 0.0, static_cast<double>(nodeNum));
+  int nodeIdx = std::min(static_cast<int>(std::floor(nodePos)), nodeNum - 1);
+  double ratio = std::min(nodePos - nodeIdx, 1.0);
+  Eigen::VectorXd plannedState =
+      (1.0 - ratio) * mpcData.plannedStateSeq[nodeIdx] + ratio * mpcData.plannedStateSeq[nodeIdx + 1];
+
+  // Apply local feedback policy
+  Eigen::VectorXd actualState(9);
+  actualState << controlData_.actualCentroidalPose.translation(), controlData_.actualCentroidalMomentum.force(),
+      controlData_.actualCentroidalMomentum.moment();
+  Eigen::VectorXd forceScales = (mpcData.plannedInputSeq[nodeIdx]
+                                 + mpcData.feedbackGainSeq[nodeIdx] * (actualState - plannedState))
+                                    .cwiseMax(0.0);
+
+  const auto & contactVec = mpcData.contactSchedule.segment(mpcData.t + nodeIdx * mpcData.horizonDt).contactVec;
+  controlData_.plannedCentroidalWrench =
+      ForceColl::calcTotalWrench(contactVec, forceScales, controlData_.actualCentroidalPose.translation());
+  controlData_.plannedCentroidalAccel.linear() =
+      controlData_.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  // The local feedback policy regulates the angular momentum, so the PD feedback of orientation is not applied
   controlData_.plannedCentroidalAccel.angular() =
-      -1
-          * config_.angularGainP.cwiseProduct(
-              sva::rotationError(refData_.centroidalPose.rotation(), controlData_.mpcCentroidalPose.rotation()))
-      + -1 * config_.angularGainD.cwiseProduct(controlData_.mpcCentroidalVel.angular());
+      CentroidalManager::calcPlannedCentroidalAngularAccel(controlData_, refData_);
+  mpcFeedbackApplied_ = true;
 }
 
-CCC::DdpCentroidal::MotionParam CentroidalManagerDDP::calcMpcMotionParam(double t) const
+CCC::DdpCentroidal::MotionParam CentroidalManagerDDP::calcMpcMotionParam(const MpcData & mpcData, double t) const
 {
   CCC::DdpCentroidal::MotionParam motionParam;
 
-  motionParam.contact_list = ForceColl::getContactVecFromMap(ctl().limbManagerSet_->contactList(t));
+  motionParam.contact_list = mpcData.contactSchedule.segment(t).contactVec;
 
   return motionParam;
 }
 
-CCC::DdpCentroidal::RefData CentroidalManagerDDP::calcMpcRefData(double t) const
+CCC::DdpCentroidal::RefData CentroidalManagerDDP::calcMpcRefData(const MpcData & mpcData, double t) const
 {
   CCC::DdpCentroidal::RefData refData;
 
-  refData.pos = calcRefData(t).centroidalPose.translation();
+  refData.pos = mpcData.refDataSeq[mpcData.nodeIdx(t)].centroidalPose.translation();
 
   return refData;
 }
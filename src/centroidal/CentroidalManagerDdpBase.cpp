@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <ForceColl/Contact.h>
+
+#include <MultiContactController/centroidal/CentroidalManagerDdpBase.h>
+
+using namespace MCC;
+
+namespace
+{
+/** \brief Get the input dimension of MPC for the contact constraint (i.e., number of ridges). */
+int calcContactInputDim(const ContactConstraint & constraint)
+{
+  int inputDim = 0;
+  for(const auto & vertexWithRidge : constraint.vertexWithRidgeList_)
+  {
+    inputDim += static_cast<int>(vertexWithRidge.ridgeList.size());
+  }
+  return inputDim;
+}
+} // namespace
+
+CentroidalManagerDdpBase::CentroidalManagerDdpBase(MultiContactController * ctlPtr,
+                                                   const mc_rtc::Configuration & mcRtcConfig)
+: CentroidalManager(ctlPtr, mcRtcConfig)
+{
+}
+
+void CentroidalManagerDdpBase::reset()
+{
+  CentroidalManager::reset();
+
+  warmStartData_.fill(WarmStartData());
+  ddpIterDurationEstimate_.fill(0);
+}
+
+std::vector<Eigen::VectorXd> CentroidalManagerDdpBase::calcWarmStartInputList(
+    const MpcData & mpcData,
+    const std::vector<Eigen::VectorXd> & prevInputList) const
+{
+  const auto & warmStartData = warmStartData_[solverIdx(mpcData)];
+  std::vector<Eigen::VectorXd> inputList;
+  if(!warmStartData.valid || prevInputList.empty())
+  {
+    return inputList;
+  }
+
+  // Get the input of the specified limb at the node of the previous MPC
+  int prevNodeNum = static_cast<int>(prevInputList.size());
+  auto getPrevLimbInput = [&](int prevNodeIdx, const Limb & limb, int inputDim, Eigen::VectorXd & limbInput) {
+    const auto & prevSegment =
+        warmStartData.contactSchedule.segment(warmStartData.t + prevNodeIdx * warmStartData.horizonDt);
+    const auto & prevInput = prevInputList[prevNodeIdx];
+    int inputIdx = 0;
+    for(size_t i = 0; i < prevSegment.limbVec.size(); i++)
+    {
+      int prevInputDim = calcContactInputDim(*prevSegment.contactVec[i]);
+      if(std::equal_to<Limb>()(prevSegment.limbVec[i], limb))
+      {
+        if(prevInputDim != inputDim || inputIdx + prevInputDim > prevInput.size())
+        {
+          return false;
+        }
+        limbInput = prevInput.segment(inputIdx, prevInputDim);
+        return true;
+      }
+      inputIdx += prevInputDim;
+    }
+    return false;
+  };
+
+  int nodeNum = static_cast<int>(mpcData.refDataSeq.size()) - 1;
+  inputList.resize(nodeNum);
+  for(int i = 0; i < nodeNum; i++)
+  {
+    double t = mpcData.t + i * mpcData.horizonDt;
+    const auto & segment = mpcData.contactSchedule.segment(t);
+
+    // Calculate the nodes of the previous MPC adjacent to the current node
+    double prevNodePos = std::clamp((t - warmStartData.t) / warmStartData.horizonDt, 0.0, prevNodeNum - 1.0);
+    int prevNodeIdx0 = std::min(static_cast<int>(std::floor(prevNodePos)), prevNodeNum - 1);
+    int prevNodeIdx1 = std::min(prevNodeIdx0 + 1, prevNodeNum - 1);
+    double ratio = prevNodePos - prevNodeIdx0;
+    double meanInput = (prevInputList[prevNodeIdx0].size() > 0 ? prevInputList[prevNodeIdx0].mean() : 0.0);
+
+    // Set input of each contact
+    int inputDim = 0;
+    for(const auto & contact : segment.contactVec)
+    {
+      inputDim += calcContactInputDim(*contact);
+    }
+    auto & input = inputList[i];
+    input.resize(inputDim);
+    int inputIdx = 0;
+    for(size_t j = 0; j < segment.limbVec.size(); j++)
+    {
+      int limbInputDim = calcContactInputDim(*segment.contactVec[j]);
+      Eigen::VectorXd limbInput0, limbInput1;
+      bool found0 = getPrevLimbInput(prevNodeIdx0, segment.limbVec[j], limbInputDim, limbInput0);
+      bool found1 = getPrevLimbInput(prevNodeIdx1, segment.limbVec[j], limbInputDim, limbInput1);
+      if(found0 && found1)
+      {
+        input.segment(inputIdx, limbInputDim) = (1.0 - ratio) * limbInput0 + ratio * limbInput1;
+      }
+      else if(found0)
+      {
+        input.segment(inputIdx, limbInputDim) = limbInput0;
+      }
+      else if(found1)
+      {
+        input.segment(inputIdx, limbInputDim) = limbInput1;
+      }
+      else
+      {
+        input.segment(inputIdx, limbInputDim).setConstant(meanInput);
+      }
+      inputIdx += limbInputDim;
+    }
+  }
+
+  return inputList;
+}
+
+void CentroidalManagerDdpBase::runDdpIterations(MpcData & mpcData,
+                                                int maxIter,
+                                                double timeBudget,
+                                                double costImprovementThreshold,
+                                                const std::function<double()> & runIter)
+{
+  using Clock = std::chrono::steady_clock;
+  auto calcDurationMs = [](const Clock::time_point & from, const Clock::time_point & to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  };
+  constexpr double estimateFilterGain = 0.2;
+
+  double & ddpIterDurationEstimate = ddpIterDurationEstimate_[solverIdx(mpcData)];
+  auto startTime = Clock::now();
+  double prevCost = std::numeric_limits<double>::quiet_NaN();
+  int iter = 0;
+  while(true)
+  {
+    auto iterStartTime = Clock::now();
+    double cost = runIter();
+    iter++;
+    auto iterEndTime = Clock::now();
+
+    // Update the running estimate of the duration of one iteration
+    double iterDuration = calcDurationMs(iterStartTime, iterEndTime);
+    if(ddpIterDurationEstimate <= 0)
+    {
+      ddpIterDurationEstimate = iterDuration;
+    }
+    else
+    {
+      ddpIterDurationEstimate =
+          (1.0 - estimateFilterGain) * ddpIterDurationEstimate + estimateFilterGain * iterDuration;
+    }
+
+    // Check termination
+    if(iter >= maxIter)
+    {
+      mpcData.terminationReason = "MaxIter";
+      break;
+    }
+    // The cost increase is not regarded as convergence
+    if(!std::isnan(prevCost) && cost <= prevCost && prevCost - cost <= costImprovementThreshold * std::abs(prevCost))
+    {
+      mpcData.terminationReason = "Converged";
+      break;
+    }
+    if(calcDurationMs(startTime, iterEndTime) + ddpIterDurationEstimate > timeBudget)
+    {
+      mpcData.terminationReason = "TimeBudget";
+      break;
+    }
+    prevCost = cost;
+  }
+
+  mpcData.iter = iter;
+  mpcData.computationDuration = calcDurationMs(startTime, Clock::now());
+}
+
+void CentroidalManagerDdpBase::setWarmStartData(const MpcData & mpcData)
+{
+  auto & warmStartData = warmStartData_[solverIdx(mpcData)];
+  warmStartData.valid = true;
+  warmStartData.t = mpcData.t;
+  warmStartData.horizonDt = mpcData.horizonDt;
+  warmStartData.contactSchedule = mpcData.contactSchedule;
+}
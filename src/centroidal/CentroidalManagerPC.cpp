@@ -6,7 +6,6 @@
 
 #include <ForceColl/Contact.h>
 
-#include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
 #include <MultiContactController/centroidal/CentroidalManagerPC.h>
 
@@ -41,12 +40,30 @@ CentroidalManagerPC::CentroidalManagerPC(MultiContactController * ctlPtr, const
   config_.load(mcRtcConfig);
 }
 
+CentroidalManagerPC::~CentroidalManagerPC()
+{
+  stopMpcWorkers();
+}
+
 void CentroidalManagerPC::reset()
 {
   CentroidalManager::reset();
 
-  pc_ = std::make_shared<CCC::PreviewControlCentroidal>(
-      robotMass_, robotInertiaMat_.diagonal(), config_.horizonDuration, config_.horizonDt, config_.mpcWeightParam);
+  // Build preview control for each horizon in advance so that it is not built while the control is running
+  for(auto & pcList : pcList_)
+  {
+    pcList.clear();
+  }
+  for(const auto & mpcDegradation : solverHorizonList_)
+  {
+    pcList_[0].push_back(makePc(mpcDegradation));
+    if(config().enableSpeculativeMpc)
+    {
+      pcList_[1].push_back(makePc(mpcDegradation));
+    }
+  }
+  pc_ = pcList_[0][solverHorizonIdx(mpcDegradation_)];
+  speculativePc_ = (config().enableSpeculativeMpc ? pcList_[1][solverHorizonIdx(mpcDegradation_)] : nullptr);
 }
 
 void CentroidalManagerPC::addToLogger(mc_rtc::Logger & logger)
@@ -54,43 +71,70 @@ void CentroidalManagerPC::addToLogger(mc_rtc::Logger & logger)
   CentroidalManager::addToLogger(logger);
 }
 
-void CentroidalManagerPC::runMpc()
+std::shared_ptr<CCC::PreviewControlCentroidal> CentroidalManagerPC::makePc(const MpcDegradation & mpcDegradation) const
+{
+  return std::make_shared<CCC::PreviewControlCentroidal>(
+      robotMass_, robotInertiaMat_.diagonal(), mpcDegradation.degradeHorizonDuration(config_.horizonDuration),
+      mpcDegradation.degradeHorizonDt(config_.horizonDt), config_.mpcWeightParam);
+}
+
+void CentroidalManagerPC::runMpc(MpcData & mpcData)
 {
+  auto & pc = (mpcData.speculative ? speculativePc_ : pc_);
+  auto & controlData = mpcData.controlData;
+
+  // Switch to preview control built for the horizon of the degradation of MPC
+  // Note that ddpMaxIter of the degradation has no effect on preview control
+  pc = pcList_[solverIdx(mpcData)][solverHorizonIdx(mpcData.degradation)];
+
   CCC::PreviewControlCentroidal::InitialParam initialParam;
-  initialParam.pos.linear() = controlData_.mpcCentroidalPose.translation();
-  initialParam.pos.angular() = mc_rbdyn::rpyFromMat(controlData_.mpcCentroidalPose.rotation());
-  initialParam.vel = controlData_.mpcCentroidalVel;
-  initialParam.acc = controlData_.plannedCentroidalAccel;
-
-  controlData_.plannedCentroidalWrench = pc_->planOnce(
-      calcMpcMotionParam(ctl().t()), std::bind(&CentroidalManagerPC::calcMpcRefData, this, std::placeholders::_1),
-      initialParam, ctl().t(), ctl().dt());
-  controlData_.plannedCentroidalMomentum.force() +=
+  initialParam.pos.linear() = controlData.mpcCentroidalPose.translation();
+  initialParam.pos.angular() = mc_rbdyn::rpyFromMat(controlData.mpcCentroidalPose.rotation());
+  initialParam.vel = controlData.mpcCentroidalVel;
+  initialParam.acc = controlData.plannedCentroidalAccel;
+
+  calcMpcRefPosSeq(mpcData);
+
+  controlData.plannedCentroidalWrench = pc->planOnce(
+      calcMpcMotionParam(mpcData, mpcData.t), [this, &mpcData](double t) { return calcMpcRefData(mpcData, t); },
+      initialParam, mpcData.t, ctl().dt());
+  controlData.plannedCentroidalMomentum.force() +=
       ctl().dt()
-      * (controlData_.plannedCentroidalWrench.force() - robotMass_ * Eigen::Vector3d(0.0, 0.0, CCC::constants::g));
-  controlData_.plannedCentroidalMomentum.moment() += ctl().dt() * controlData_.plannedCentroidalWrench.moment();
-  controlData_.plannedCentroidalAccel.linear() =
-      controlData_.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
-  controlData_.plannedCentroidalAccel.angular() =
-      controlData_.plannedCentroidalWrench.moment().cwiseQuotient(robotInertiaMat_.diagonal());
+      * (controlData.plannedCentroidalWrench.force() - robotMass_ * Eigen::Vector3d(0.0, 0.0, CCC::constants::g));
+  controlData.plannedCentroidalMomentum.moment() += ctl().dt() * controlData.plannedCentroidalWrench.moment();
+  controlData.plannedCentroidalAccel.linear() =
+      controlData.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  controlData.plannedCentroidalAccel.angular() = calcPlannedCentroidalAngularAccel(controlData, mpcData.refData);
 }
 
-CCC::PreviewControlCentroidal::MotionParam CentroidalManagerPC::calcMpcMotionParam(double t) const
+CCC::PreviewControlCentroidal::MotionParam CentroidalManagerPC::calcMpcMotionParam(const MpcData & mpcData,
+                                                                                   double t) const
 {
   CCC::PreviewControlCentroidal::MotionParam motionParam;
 
-  motionParam.contact_list = ForceColl::getContactVecFromMap(ctl().limbManagerSet_->contactList(t));
+  motionParam.contact_list = mpcData.contactSchedule.segment(t).contactVec;
 
   return motionParam;
 }
 
-CCC::PreviewControlCentroidal::RefData CentroidalManagerPC::calcMpcRefData(double t) const
+void CentroidalManagerPC::calcMpcRefPosSeq(const MpcData & mpcData)
+{
+  auto & mpcRefPosSeq = mpcRefPosSeq_[solverIdx(mpcData)];
+  int nodeNum = static_cast<int>(mpcData.refDataSeq.size());
+  mpcRefPosSeq.resize(Eigen::NoChange, nodeNum);
+  for(int i = 0; i < nodeNum; i++)
+  {
+    const auto & refData = mpcData.refDataSeq[i];
+    mpcRefPosSeq.col(i) << mc_rbdyn::rpyFromMat(refData.centroidalPose.rotation()),
+        refData.centroidalPose.translation();
+  }
+}
+
+CCC::PreviewControlCentroidal::RefData CentroidalManagerPC::calcMpcRefData(const MpcData & mpcData, double t) const
 {
   CCC::PreviewControlCentroidal::RefData mpcRefData;
 
-  const auto & refData = calcRefData(t);
-  mpcRefData.pos.linear() = refData.centroidalPose.translation();
-  mpcRefData.pos.angular() = mc_rbdyn::rpyFromMat(refData.centroidalPose.rotation());
+  mpcRefData.pos = sva::MotionVecd(mpcRefPosSeq_[solverIdx(mpcData)].col(mpcData.nodeIdx(t)));
 
   return mpcRefData;
 }
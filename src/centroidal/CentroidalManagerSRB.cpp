@@ -4,7 +4,6 @@
 
 #include <ForceColl/Contact.h>
 
-#include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
 #include <MultiContactController/centroidal/CentroidalManagerSRB.h>
 
@@ -31,6 +30,9 @@ void CentroidalManagerSRB::Configuration::load(const mc_rtc::Configuration & mcR
   mcRtcConfig("horizonDuration", horizonDuration);
   mcRtcConfig("horizonDt", horizonDt);
   mcRtcConfig("ddpMaxIter", ddpMaxIter);
+  mcRtcConfig("ddpTimeBudget", ddpTimeBudget);
+  mcRtcConfig("ddpCostImprovementThreshold", ddpCostImprovementThreshold);
+  mcRtcConfig("useTimeShiftedWarmStart", useTimeShiftedWarmStart);
   if(mcRtcConfig.has("mpcWeightParam"))
   {
     mcRtcConfig("mpcWeightParam")("runningPos", mpcWeightParam.running_pos);
@@ -52,88 +54,180 @@ void CentroidalManagerSRB::Configuration::addToLogger(const std::string & baseEn
   MC_RTC_LOG_HELPER(baseEntry + "_horizonDuration", horizonDuration);
   MC_RTC_LOG_HELPER(baseEntry + "_horizonDt", horizonDt);
   MC_RTC_LOG_HELPER(baseEntry + "_ddpMaxIter", ddpMaxIter);
+  MC_RTC_LOG_HELPER(baseEntry + "_ddpTimeBudget", ddpTimeBudget);
+  MC_RTC_LOG_HELPER(baseEntry + "_ddpCostImprovementThreshold", ddpCostImprovementThreshold);
+  MC_RTC_LOG_HELPER(baseEntry + "_useTimeShiftedWarmStart", useTimeShiftedWarmStart);
 }
 
 CentroidalManagerSRB::CentroidalManagerSRB(MultiContactController * ctlPtr, const mc_rtc::Configuration & mcRtcConfig)
-: CentroidalManager(ctlPtr, mcRtcConfig)
+: CentroidalManagerDdpBase(ctlPtr, mcRtcConfig)
 {
   config_.load(mcRtcConfig);
 }
 
+CentroidalManagerSRB::~CentroidalManagerSRB()
+{
+  stopMpcWorkers();
+}
+
 void CentroidalManagerSRB::reset()
 {
-  CentroidalManager::reset();
+  CentroidalManagerDdpBase::reset();
 
-  ddp_ = std::make_shared<CCC::DdpSingleRigidBody>(
-      robotMass_, config_.horizonDt, static_cast<int>(std::floor(config_.horizonDuration / config_.horizonDt)),
-      config_.mpcWeightParam);
-  ddp_->ddp_solver_->config().max_iter = config_.ddpMaxIter;
+  // Build DDP for each horizon in advance so that it is not built while the control is running
+  for(auto & ddpList : ddpList_)
+  {
+    ddpList.clear();
+  }
+  for(const auto & mpcDegradation : solverHorizonList_)
+  {
+    ddpList_[0].push_back(makeDdp(mpcDegradation));
+    if(config().enableSpeculativeMpc)
+    {
+      ddpList_[1].push_back(makeDdp(mpcDegradation));
+    }
+  }
+  ddp_ = ddpList_[0][solverHorizonIdx(mpcDegradation_)];
+  speculativeDdp_ = (config().enableSpeculativeMpc ? ddpList_[1][solverHorizonIdx(mpcDegradation_)] : nullptr);
 }
 
 void CentroidalManagerSRB::addToLogger(mc_rtc::Logger & logger)
 {
   CentroidalManager::addToLogger(logger);
 
+  // The solver may be running in the MPC worker thread, so log the copies in mpcData_
   logger.addLogEntry(config_.name + "_DDP_computationDuration", this,
-                     [this]() { return ddp_->ddp_solver_->computationDuration().solve; });
-  logger.addLogEntry(config_.name + "_DDP_iter", this, [this]() {
-    return ddp_->ddp_solver_->traceDataList().empty() ? 0 : ddp_->ddp_solver_->traceDataList().back().iter;
-  });
+                     [this]() { return mpcData_.computationDuration; });
+  logger.addLogEntry(config_.name + "_DDP_iter", this, [this]() { return mpcData_.iter; });
+  logger.addLogEntry(config_.name + "_DDP_terminationReason", this,
+                     [this]() -> const std::string & { return mpcData_.terminationReason; });
+}
+
+std::shared_ptr<CCC::DdpSingleRigidBody> CentroidalManagerSRB::makeDdp(const MpcDegradation & mpcDegradation) const
+{
+  auto ddp = std::make_shared<CCC::DdpSingleRigidBody>(
+      robotMass_, mpcDegradation.degradeHorizonDt(config_.horizonDt), calcHorizonSteps(mpcDegradation),
+      config_.mpcWeightParam);
+  // If the time budget is used, DDP is iterated one by one in runMpc
+  ddp->ddp_solver_->config().max_iter =
+      (config_.ddpTimeBudget > 0 ? 1 : mpcDegradation.degradeDdpMaxIter(config_.ddpMaxIter));
+  return ddp;
 }
 
-void CentroidalManagerSRB::runMpc()
+void CentroidalManagerSRB::runMpc(MpcData & mpcData)
 {
+  auto & ddp = (mpcData.speculative ? speculativeDdp_ : ddp_);
+  auto & controlData = mpcData.controlData;
+
+  // Switch to DDP built for the horizon of the degradation of MPC, and keep the previous DDP for the warm start
+  std::shared_ptr<CCC::DdpSingleRigidBody> prevDdp = ddp;
+  ddp = ddpList_[solverIdx(mpcData)][solverHorizonIdx(mpcData.degradation)];
+  int ddpMaxIter = mpcData.degradation.degradeDdpMaxIter(config_.ddpMaxIter);
+  ddp->ddp_solver_->config().max_iter = (config_.ddpTimeBudget > 0 ? 1 : ddpMaxIter);
+
   CCC::DdpSingleRigidBody::InitialParam initialParam;
-  initialParam.pos = controlData_.mpcCentroidalPose.translation();
-  initialParam.ori = eulerAnglesFromRot(controlData_.mpcCentroidalPose.rotation().transpose());
-  initialParam.linear_vel = controlData_.mpcCentroidalVel.linear();
-  initialParam.angular_vel = controlData_.mpcCentroidalVel.angular();
-  initialParam.u_list = ddp_->ddp_solver_->controlData().u_list;
-  if(!initialParam.u_list.empty())
+  initialParam.pos = controlData.mpcCentroidalPose.translation();
+  initialParam.ori = eulerAnglesFromRot(controlData.mpcCentroidalPose.rotation().transpose());
+  initialParam.linear_vel = controlData.mpcCentroidalVel.linear();
+  initialParam.angular_vel = controlData.mpcCentroidalVel.angular();
+  if(config_.useTimeShiftedWarmStart)
   {
-    for(int i = 0; i < ddp_->ddp_solver_->config().horizon_steps; i++)
+    initialParam.u_list = calcWarmStartInputList(mpcData, prevDdp->ddp_solver_->controlData().u_list);
+  }
+  else if(ddp == prevDdp)
+  {
+    // Warm start with the previous solution of the same DDP (DDP just switched by the degradation is cold-started)
+    initialParam.u_list = ddp->ddp_solver_->controlData().u_list;
+    if(!initialParam.u_list.empty())
     {
-      double tmpTime = ctl().t() + i * ddp_->ddp_problem_->dt();
-      int inputDim = ddp_->ddp_problem_->inputDim(tmpTime);
-      if(initialParam.u_list[i].size() != inputDim)
+      for(int i = 0; i < ddp->ddp_solver_->config().horizon_steps; i++)
       {
-        initialParam.u_list[i].setZero(inputDim);
+        // Note that inputDim refers to the motion parameter function passed in the previous planOnce call, which
+        // refers to the same mpcData object as this call
+        double tmpTime = mpcData.t + i * ddp->ddp_problem_->dt();
+        int inputDim = ddp->ddp_problem_->inputDim(tmpTime);
+        if(initialParam.u_list[i].size() != inputDim)
+        {
+          initialParam.u_list[i].setZero(inputDim);
+        }
       }
     }
   }
 
-  Eigen::VectorXd plannedForceScales = ddp_->planOnce(
-      std::bind(&CentroidalManagerSRB::calcMpcMotionParam, this, std::placeholders::_1),
-      std::bind(&CentroidalManagerSRB::calcMpcRefData, this, std::placeholders::_1), initialParam, ctl().t());
-
-  const auto & motionParam = calcMpcMotionParam(ctl().t());
-  controlData_.plannedCentroidalWrench = ForceColl::calcTotalWrench(motionParam.contact_list, plannedForceScales,
-                                                                    controlData_.mpcCentroidalPose.translation());
-  controlData_.plannedCentroidalMomentum =
-      sva::ForceVecd(motionParam.inertia_mat * controlData_.plannedCentroidalVel.angular(),
-                     robotMass_ * controlData_.plannedCentroidalVel.linear());
-  controlData_.plannedCentroidalAccel.linear() =
-      controlData_.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
-  controlData_.plannedCentroidalAccel.angular() = motionParam.inertia_mat.llt().solve(
-      -1 * controlData_.plannedCentroidalVel.angular().cross(controlData_.plannedCentroidalMomentum.moment())
-      + controlData_.plannedCentroidalWrench.moment());
+  auto motionParamFunc = [this, &mpcData](double t) { return calcMpcMotionParam(mpcData, t); };
+  auto refDataFunc = [this, &mpcData](double t) { return calcMpcRefData(mpcData, t); };
+  Eigen::VectorXd plannedForceScales;
+  if(config_.ddpTimeBudget > 0)
+  {
+    // Run one DDP iteration at a time, continuing from the result of the previous iteration
+    runDdpIterations(mpcData, ddpMaxIter, config_.ddpTimeBudget, config_.ddpCostImprovementThreshold, [&]() {
+      plannedForceScales = ddp->planOnce(motionParamFunc, refDataFunc, initialParam, mpcData.t);
+      initialParam.u_list = ddp->ddp_solver_->controlData().u_list;
+      return ddp->ddp_solver_->traceDataList().back().cost;
+    });
+  }
+  else
+  {
+    plannedForceScales = ddp->planOnce(motionParamFunc, refDataFunc, initialParam, mpcData.t);
+    mpcData.computationDuration = ddp->ddp_solver_->computationDuration().solve;
+    mpcData.iter = ddp->ddp_solver_->traceDataList().empty() ? 0 : ddp->ddp_solver_->traceDataList().back().iter;
+    mpcData.terminationReason = "Solver";
+  }
+  setWarmStartData(mpcData);
+
+  // Set planned trajectory for interpolation between MPC solves
+  if(requirePlannedTrajectory())
+  {
+    const auto & ddpControlData = ddp->ddp_solver_->controlData();
+    mpcData.plannedWrenchSeq.resize(ddpControlData.u_list.size());
+    for(size_t i = 0; i < ddpControlData.u_list.size(); i++)
+    {
+      mpcData.plannedWrenchSeq[i] =
+          ForceColl::calcTotalWrench(mpcData.contactSchedule.segment(mpcData.t + i * mpcData.horizonDt).contactVec,
+                                     ddpControlData.u_list[i], ddpControlData.x_list[i].head<3>());
+    }
+  }
+  else
+  {
+    mpcData.plannedWrenchSeq.clear();
+  }
+
+  const auto & motionParam = calcMpcMotionParam(mpcData, mpcData.t);
+  controlData.plannedCentroidalWrench = ForceColl::calcTotalWrench(motionParam.contact_list, plannedForceScales,
+                                                                   controlData.mpcCentroidalPose.translation());
+  controlData.plannedCentroidalMomentum =
+      sva::ForceVecd(motionParam.inertia_mat * controlData.plannedCentroidalVel.angular(),
+                     robotMass_ * controlData.plannedCentroidalVel.linear());
+  controlData.plannedCentroidalAccel.linear() =
+      controlData.plannedCentroidalWrench.force() / robotMass_ - Eigen::Vector3d(0.0, 0.0, CCC::constants::g);
+  controlData.plannedCentroidalAccel.angular() = calcPlannedCentroidalAngularAccel(controlData, mpcData.refData);
+}
+
+Eigen::Vector3d CentroidalManagerSRB::calcPlannedCentroidalAngularAccel(const ControlData & controlData,
+                                                                        const RefData & // refData
+                                                                        ) const
+{
+  // Euler's equation of the single rigid body with the inertia of calcMpcMotionParam
+  return robotInertiaMat_.llt().solve(
+      -1 * controlData.plannedCentroidalVel.angular().cross(controlData.plannedCentroidalMomentum.moment())
+      + controlData.plannedCentroidalWrench.moment());
 }
 
-CCC::DdpSingleRigidBody::MotionParam CentroidalManagerSRB::calcMpcMotionParam(double t) const
+CCC::DdpSingleRigidBody::MotionParam CentroidalManagerSRB::calcMpcMotionParam(const MpcData & mpcData, double t) const
 {
   CCC::DdpSingleRigidBody::MotionParam motionParam;
 
-  motionParam.contact_list = ForceColl::getContactVecFromMap(ctl().limbManagerSet_->contactList(t));
+  motionParam.contact_list = mpcData.contactSchedule.segment(t).contactVec;
   motionParam.inertia_mat = robotInertiaMat_;
 
   return motionParam;
 }
 
-CCC::DdpSingleRigidBody::RefData CentroidalManagerSRB::calcMpcRefData(double t) const
+CCC::DdpSingleRigidBody::RefData CentroidalManagerSRB::calcMpcRefData(const MpcData & mpcData, double t) const
 {
   CCC::DdpSingleRigidBody::RefData refData;
 
-  const auto & refDataBase = calcRefData(t);
+  const auto & refDataBase = mpcData.refDataSeq[mpcData.nodeIdx(t)];
   refData.pos = refDataBase.centroidalPose.translation();
   refData.ori = eulerAnglesFromRot(refDataBase.centroidalPose.rotation().transpose());
 
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include <MultiContactController/CentroidalManager.h>
 #include <MultiContactController/LimbManagerSet.h>
@@ -15,31 +16,39 @@ void ConfigMotionState::start(mc_control::fsm::Controller & _ctl)
   State::start(_ctl);
 
   // Set baseTime
-  double baseTime = std::numeric_limits<double>::quiet_NaN();
+  baseTime_ = std::numeric_limits<double>::quiet_NaN();
   if(config_.has("configs") && config_("configs").has("baseTime"))
   {
     if(config_("configs")("baseTime") == "Relative")
     {
-      baseTime = ctl().t();
+      baseTime_ = ctl().t();
     }
     else
     {
-      baseTime = static_cast<double>(config_("configs")("baseTime"));
+      baseTime_ = static_cast<double>(config_("configs")("baseTime"));
     }
   }
 
+  collisionConfigList_.clear();
+  taskConfigList_.clear();
+
+  // The step commands of this motion are allocated from the arena, which is released when they are all finished
+  commandArena_ = std::make_shared<CommandArena>();
+
   // Send step command
   if(config_.has("configs") && config_("configs").has("stepCommandList"))
   {
-    for(const auto & stepCommandConfig : config_("configs")("stepCommandList"))
+    mc_rtc::Configuration stepCommandListConfig = config_("configs")("stepCommandList");
+    std::vector<std::pair<Limb, StepCommand>> stepCommandList;
+    stepCommandList.reserve(stepCommandListConfig.size());
+    for(const auto & stepCommandConfig : stepCommandListConfig)
     {
-      StepCommand stepCommand = StepCommand(stepCommandConfig);
-      if(!std::isnan(baseTime))
-      {
-        stepCommand.setBaseTime(baseTime);
-      }
-      Limb limb = Limb(stepCommandConfig("limb"));
-      ctl().limbManagerSet_->at(limb)->appendStepCommand(stepCommand);
+      stepCommandList.emplace_back(Limb(stepCommandConfig("limb")), makeStepCommand(stepCommandConfig));
+    }
+    if(!ctl().limbManagerSet_->appendStepCommands(stepCommandList))
+    {
+      mc_rtc::log::error_and_throw("[ConfigMotionState] Failed to append {} step commands of the motion.",
+                                   stepCommandList.size());
     }
   }
 
@@ -48,13 +57,7 @@ void ConfigMotionState::start(mc_control::fsm::Controller & _ctl)
   {
     for(const auto & nominalCentroidalPoseConfig : config_("configs")("nominalCentroidalPoseList"))
     {
-      double time = nominalCentroidalPoseConfig("time");
-      if(!std::isnan(baseTime))
-      {
-        time += baseTime;
-      }
-      ctl().centroidalManager_->appendNominalCentroidalPose(
-          time, static_cast<sva::PTransformd>(nominalCentroidalPoseConfig("pose")));
+      appendNominalCentroidalPose(nominalCentroidalPoseConfig);
     }
   }
 
@@ -63,48 +66,38 @@ void ConfigMotionState::start(mc_control::fsm::Controller & _ctl)
   {
     for(const auto & nominalPostureConfig : config_("configs")("nominalPostureList"))
     {
-      double time = nominalPostureConfig("time");
-      if(!std::isnan(baseTime))
-      {
-        time += baseTime;
-      }
-      PostureManager::PostureMap nominalPosture = nominalPostureConfig("target");
-      ctl().postureManager_->appendNominalPosture(time, nominalPosture);
+      appendNominalPosture(nominalPostureConfig);
     }
   }
 
   // Set collision configuration list
-  collisionConfigList_.clear();
   if(config_.has("configs") && config_("configs").has("collisionConfigList"))
   {
-    for(const auto & _collisionConfig : config_("configs")("collisionConfigList"))
+    for(const auto & collisionConfig : config_("configs")("collisionConfigList"))
     {
-      mc_rtc::Configuration collisionConfig;
-      collisionConfig.load(_collisionConfig); // deep copy
-      if(!std::isnan(baseTime))
-      {
-        collisionConfig.add("time", static_cast<double>(collisionConfig("time")) + baseTime);
-      }
-      collisionConfigList_.emplace(static_cast<double>(collisionConfig("time")), collisionConfig);
+      appendCollisionConfig(collisionConfig);
     }
   }
 
   // Set task configuration list
-  taskConfigList_.clear();
   if(config_.has("configs") && config_("configs").has("taskConfigList"))
   {
-    for(const auto & _taskConfig : config_("configs")("taskConfigList"))
+    for(const auto & taskConfig : config_("configs")("taskConfigList"))
     {
-      mc_rtc::Configuration taskConfig;
-      taskConfig.load(_taskConfig); // deep copy
-      if(!std::isnan(baseTime))
-      {
-        taskConfig.add("time", static_cast<double>(taskConfig("time")) + baseTime);
-      }
-      taskConfigList_.emplace(static_cast<double>(taskConfig("time")), taskConfig);
+      appendTaskConfig(taskConfig);
     }
   }
 
+  // Open motion plan
+  motionPlan_.reset();
+  motionPlanIdx_ = 0;
+  if(config_.has("configs") && config_("configs").has("motionPlanFile"))
+  {
+    motionPlan_ = std::make_unique<MotionPlan>(static_cast<std::string>(config_("configs")("motionPlanFile")));
+    config_("configs")("motionPlanLookaheadDuration", motionPlanLookaheadDuration_);
+    feedMotionPlan();
+  }
+
   // Set option to wait for finishing swing motion
   if(config_.has("configs") && config_("configs").has("exitWhenLimbSwingFinished"))
   {
@@ -124,6 +117,12 @@ void ConfigMotionState::start(mc_control::fsm::Controller & _ctl)
 
 bool ConfigMotionState::run(mc_control::fsm::Controller &)
 {
+  // Feed motion plan
+  if(motionPlan_)
+  {
+    feedMotionPlan();
+  }
+
   // Process collision configuration
   {
     auto it = collisionConfigList_.begin();
@@ -191,12 +190,118 @@ bool ConfigMotionState::run(mc_control::fsm::Controller &)
     }
   }
 
-  return !ctl().limbManagerSet_->contactCommandStacked() && taskConfigList_.empty() && collisionConfigList_.empty()
+  return (!motionPlan_ || motionPlanIdx_ == motionPlan_->size()) && !ctl().limbManagerSet_->contactCommandStacked()
+         && taskConfigList_.empty() && collisionConfigList_.empty()
          && (!exitWhenLimbSwingFinished_ || !ctl().limbManagerSet_->isExecutingLimbSwing())
          && (!exitWhenCentroidalManagerFinished_ || ctl().centroidalManager_->isFinished(ctl().t()))
          && (!exitWhenPostureManagerFinished_ || ctl().postureManager_->isFinished(ctl().t()));
 }
 
-void ConfigMotionState::teardown(mc_control::fsm::Controller &) {}
+void ConfigMotionState::teardown(mc_control::fsm::Controller &)
+{
+  motionPlan_.reset();
+  commandArena_.reset();
+}
+
+void ConfigMotionState::feedMotionPlan()
+{
+  double baseTime = (std::isnan(baseTime_) ? 0.0 : baseTime_);
+  if(motionPlanIdx_ == motionPlan_->size()
+     || motionPlan_->record(motionPlanIdx_).time + baseTime > ctl().t() + motionPlanLookaheadDuration_)
+  {
+    return;
+  }
+
+  // Each batch has its own arena, so that the memory of the finished steps is released during the motion
+  commandArena_ = std::make_shared<CommandArena>();
+  std::vector<std::pair<Limb, StepCommand>> stepCommandList;
+  while(motionPlanIdx_ < motionPlan_->size()
+        && motionPlan_->record(motionPlanIdx_).time + baseTime <= ctl().t() + motionPlanLookaheadDuration_)
+  {
+    mc_rtc::Configuration entryConfig = motionPlan_->payload(motionPlanIdx_);
+    switch(motionPlan_->record(motionPlanIdx_).type)
+    {
+      case MotionPlan::RecordType::StepCommand:
+        stepCommandList.emplace_back(Limb(entryConfig("limb")), makeStepCommand(entryConfig));
+        break;
+      case MotionPlan::RecordType::NominalCentroidalPose:
+        appendNominalCentroidalPose(entryConfig);
+        break;
+      case MotionPlan::RecordType::NominalPosture:
+        appendNominalPosture(entryConfig);
+        break;
+      case MotionPlan::RecordType::CollisionConfig:
+        appendCollisionConfig(entryConfig);
+        break;
+      case MotionPlan::RecordType::TaskConfig:
+        appendTaskConfig(entryConfig);
+        break;
+      default:
+        mc_rtc::log::error_and_throw("[ConfigMotionState] Invalid record type in motion plan: {}",
+                                     static_cast<uint32_t>(motionPlan_->record(motionPlanIdx_).type));
+    }
+    motionPlanIdx_++;
+  }
+
+  if(!stepCommandList.empty() && !ctl().limbManagerSet_->appendStepCommands(stepCommandList))
+  {
+    mc_rtc::log::error_and_throw("[ConfigMotionState] Failed to append {} step commands of the motion plan.",
+                                 stepCommandList.size());
+  }
+}
+
+StepCommand ConfigMotionState::makeStepCommand(const mc_rtc::Configuration & stepCommandConfig) const
+{
+  StepCommand stepCommand = StepCommand(stepCommandConfig, commandArena_);
+  if(!std::isnan(baseTime_))
+  {
+    stepCommand.setBaseTime(baseTime_);
+  }
+  return stepCommand;
+}
+
+void ConfigMotionState::appendNominalCentroidalPose(const mc_rtc::Configuration & nominalCentroidalPoseConfig)
+{
+  double time = nominalCentroidalPoseConfig("time");
+  if(!std::isnan(baseTime_))
+  {
+    time += baseTime_;
+  }
+  ctl().centroidalManager_->appendNominalCentroidalPose(
+      time, static_cast<sva::PTransformd>(nominalCentroidalPoseConfig("pose")));
+}
+
+void ConfigMotionState::appendNominalPosture(const mc_rtc::Configuration & nominalPostureConfig)
+{
+  double time = nominalPostureConfig("time");
+  if(!std::isnan(baseTime_))
+  {
+    time += baseTime_;
+  }
+  PostureManager::PostureMap nominalPosture = nominalPostureConfig("target");
+  ctl().postureManager_->appendNominalPosture(time, nominalPosture);
+}
+
+void ConfigMotionState::appendCollisionConfig(const mc_rtc::Configuration & _collisionConfig)
+{
+  mc_rtc::Configuration collisionConfig;
+  collisionConfig.load(_collisionConfig); // deep copy
+  if(!std::isnan(baseTime_))
+  {
+    collisionConfig.add("time", static_cast<double>(collisionConfig("time")) + baseTime_);
+  }
+  collisionConfigList_.emplace(static_cast<double>(collisionConfig("time")), collisionConfig);
+}
+
+void ConfigMotionState::appendTaskConfig(const mc_rtc::Configuration & _taskConfig)
+{
+  mc_rtc::Configuration taskConfig;
+  taskConfig.load(_taskConfig); // deep copy
+  if(!std::isnan(baseTime_))
+  {
+    taskConfig.add("time", static_cast<double>(taskConfig("time")) + baseTime_);
+  }
+  taskConfigList_.emplace(static_cast<double>(taskConfig("time")), taskConfig);
+}
 
 EXPORT_SINGLE_STATE("MCC::ConfigMotion", ConfigMotionState)
@@ -50,48 +50,32 @@ void GuiStepState::teardown(mc_control::fsm::Controller &)
 
 bool GuiStepState::sendStepCommand(const mc_rtc::Configuration & config) const
 {
-  if(ctl().limbManagerSet_->contactCommandStacked())
-  {
-    mc_rtc::log::error(
-        "[GuiStepState] sendStepCommand is available only when the contact command is not stacked in LimbManagerSet.");
-    return false;
-  }
-
+  // The GUI callback may be called from a thread other than the control thread, so only the form is parsed here, and
+  // the times and the pose relative to the control state are resolved on the control thread when the step command is
+  // appended
+  std::string limbName;
+  SwingCommand::Type type = SwingCommand::Type::Add;
+  double startTimeFromNow = 0.0;
+  double duration = 0.0;
+  sva::PTransformd relPose = sva::PTransformd::Identity();
+  std::string baseFrame = "Control";
+  mc_rtc::Configuration constraintConfig;
   try
   {
-    mc_rtc::Configuration stepCommandConfig;
-    stepCommandConfig.add("limb", config(stepConfigKeys_.at("limb")));
-    stepCommandConfig.add("type", config(stepConfigKeys_.at("type")));
-    double startTime = ctl().t() + static_cast<double>(config(stepConfigKeys_.at("startTime")));
-    double endTime = startTime + static_cast<double>(config(stepConfigKeys_.at("duration")));
-    stepCommandConfig.add("startTime", startTime);
-    stepCommandConfig.add("endTime", endTime);
-    if(stepCommandConfig("type") == "Add")
+    limbName = static_cast<std::string>(config(stepConfigKeys_.at("limb")));
+    type = SwingCommand::strToType.at(static_cast<std::string>(config(stepConfigKeys_.at("type"))));
+    startTimeFromNow = config(stepConfigKeys_.at("startTime"));
+    duration = config(stepConfigKeys_.at("duration"));
+    if(type == SwingCommand::Type::Add)
     {
       Eigen::Vector3d rpy = config(stepConfigKeys_.at("rpy"));
-      sva::PTransformd pose = sva::PTransformd(mc_rbdyn::rpyToMat(rpy.unaryExpr(&mc_rtc::constants::toRad)),
-                                               config(stepConfigKeys_.at("xyz")));
-      std::string baseFrame = config(stepConfigKeys_.at("baseFrame"));
-      if(baseFrame != "Control")
-      {
-        Limb baseLimb = Limb(baseFrame);
-        if(!ctl().limbManagerSet_->at(baseLimb)->getContactCommand(ctl().t()))
-        {
-          mc_rtc::log::error(
-              "[GuiStepState] The base frame limb must be in contact, but the specified limb \"{}\" is not in contact.",
-              std::to_string(baseLimb));
-          return false;
-        }
-        pose = pose * ctl().limbTasks_.at(baseLimb)->targetPose();
-      }
-      stepCommandConfig.add("pose", pose);
-      mc_rtc::Configuration constraintConfig;
+      relPose = sva::PTransformd(mc_rbdyn::rpyToMat(rpy.unaryExpr(&mc_rtc::constants::toRad)),
+                                 config(stepConfigKeys_.at("xyz")));
+      baseFrame = static_cast<std::string>(config(stepConfigKeys_.at("baseFrame")));
       constraintConfig.add("type", config(stepConfigKeys_.at("constraintType")));
       constexpr double fricCoeff = 0.5;
       constraintConfig.add("fricCoeff", fricCoeff);
-      stepCommandConfig.add("constraint", constraintConfig);
     }
-    ctl().limbManagerSet_->at(Limb(stepCommandConfig("limb")))->appendStepCommand(StepCommand(stepCommandConfig));
   }
   catch(const std::exception & e)
   {
@@ -99,6 +83,42 @@ bool GuiStepState::sendStepCommand(const mc_rtc::Configuration & config) const
     return false;
   }
 
+  auto generator = [limbName, type, startTimeFromNow, duration, relPose, baseFrame,
+                    constraintConfig](const MultiContactController & ctl,
+                                      std::vector<std::pair<Limb, StepCommand>> & stepCommandList) -> bool {
+    if(ctl.limbManagerSet_->contactCommandStacked())
+    {
+      mc_rtc::log::error("[GuiStepState] Ignore the step command because it is available only when the contact "
+                         "command is not stacked in LimbManagerSet.");
+      return false;
+    }
+
+    sva::PTransformd pose = relPose;
+    if(baseFrame != "Control")
+    {
+      Limb baseLimb = Limb(baseFrame);
+      if(ctl.limbManagerSet_->contactSnapshot().limbIdx(baseLimb) < 0)
+      {
+        mc_rtc::log::error("[GuiStepState] The base frame limb must be in contact, but the specified limb \"{}\" is "
+                           "not in contact.",
+                           std::to_string(baseLimb));
+        return false;
+      }
+      pose = pose * ctl.limbTasks_.at(baseLimb)->targetPose();
+    }
+    double startTime = ctl.t() + startTimeFromNow;
+    StepCommandBuilder builder = (type == SwingCommand::Type::Add ? StepCommandBuilder(limbName, pose)
+                                                                  : StepCommandBuilder(limbName));
+    stepCommandList.emplace_back(Limb(limbName),
+                                 builder.simple(type, startTime, startTime + duration, constraintConfig).build());
+    return true;
+  };
+  if(!ctl().limbManagerSet_->pushStepCommands(std::move(generator)))
+  {
+    mc_rtc::log::error("[GuiStepState] Failed to push the step command because the queue is full.");
+    return false;
+  }
+
   return true;
 }
 
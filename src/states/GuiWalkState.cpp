@@ -69,13 +69,6 @@ void GuiWalkState::teardown(mc_control::fsm::Controller &)
 
 bool GuiWalkState::sendWalkCommand(const Eigen::Vector3d & targetTrans, int lastFootstepNum) const
 {
-  if(ctl().limbManagerSet_->contactCommandStacked())
-  {
-    mc_rtc::log::error(
-        "[GuiWalkState] sendWalkCommand is available only when the contact command is not stacked in LimbManagerSet.");
-    return false;
-  }
-
   auto convertTo2d = [](const sva::PTransformd & pose) -> Eigen::Vector3d {
     return Eigen::Vector3d(pose.translation().x(), pose.translation().y(), mc_rbdyn::rpyFromMat(pose.rotation()).z());
   };
@@ -83,23 +76,42 @@ bool GuiWalkState::sendWalkCommand(const Eigen::Vector3d & targetTrans, int last
     return sva::PTransformd(sva::RotZ(trans.z()), Eigen::Vector3d(trans.x(), trans.y(), 0));
   };
 
-  // The 2D variables (i.e., targetTrans, deltaTrans) represent the transformation relative to the initial pose,
-  // while the 3D variables (i.e., initialFootMidpose, goalFootMidpose, footMidpose) represent the
-  // transformation in the world frame.
-  const sva::PTransformd & initialFootMidpose = projGround(
-      sva::interpolate(ctl().limbTasks_.at(leftFoot)->targetPose(), ctl().limbTasks_.at(rightFoot)->targetPose(), 0.5));
-  const sva::PTransformd & goalFootMidpose = convertTo3d(targetTrans) * initialFootMidpose;
+  /** \brief Footstep relative to the initial foot midpose and the current time. */
+  struct Footstep
+  {
+    //! Foot
+    Limb foot;
+
+    //! Foot pose relative to the initial foot midpose
+    sva::PTransformd pose;
+
+    //! Time to start swinging the foot from the current time [sec]
+    double startTime;
+
+    //! Time to end swinging the foot from the current time [sec]
+    double endTime;
+  };
+
+  // The GUI callback may be called from a thread other than the control thread, so the footsteps are planned relative
+  // to the initial foot midpose and the current time here, and they are resolved on the control thread when the step
+  // commands are appended.
+  // The 2D variables (i.e., targetTrans, deltaTrans) and the 3D variables (i.e., goalFootMidpose, footMidpose)
+  // represent the transformation relative to the initial foot midpose.
+  const sva::PTransformd & goalFootMidpose = convertTo3d(targetTrans);
 
   Limb foot = targetTrans.y() >= 0 ? leftFoot : rightFoot;
-  sva::PTransformd footMidpose = initialFootMidpose;
-  double startTime = ctl().t() + 2.0;
+  sva::PTransformd footMidpose = sva::PTransformd::Identity();
+  double startTime = 2.0;
+  double swingDuration = (1.0 - doubleSupportRatio_) * footstepDuration_;
+
+  std::vector<Footstep> footstepList;
 
   while(convertTo2d(goalFootMidpose * footMidpose.inv()).norm() > 1e-6)
   {
     Eigen::Vector3d deltaTrans = convertTo2d(goalFootMidpose * footMidpose.inv());
     footMidpose = convertTo3d(clampDeltaTrans(deltaTrans, foot)) * footMidpose;
 
-    ctl().limbManagerSet_->at(foot)->appendStepCommand(makeStepCommand(foot, footMidpose, startTime));
+    footstepList.push_back({foot, midToFootTranss_.at(foot) * footMidpose, startTime, startTime + swingDuration});
 
     foot = (std::equal_to<MCC::Limb>()(foot, leftFoot) ? rightFoot : leftFoot);
     startTime = startTime + footstepDuration_;
@@ -107,12 +119,42 @@ bool GuiWalkState::sendWalkCommand(const Eigen::Vector3d & targetTrans, int last
 
   for(int i = 0; i < lastFootstepNum + 1; i++)
   {
-    ctl().limbManagerSet_->at(foot)->appendStepCommand(makeStepCommand(foot, footMidpose, startTime));
+    footstepList.push_back({foot, midToFootTranss_.at(foot) * footMidpose, startTime, startTime + swingDuration});
 
     foot = (std::equal_to<MCC::Limb>()(foot, leftFoot) ? rightFoot : leftFoot);
     startTime = startTime + footstepDuration_;
   }
 
+  auto generator = [footstepList = std::move(footstepList)](
+                       const MultiContactController & ctl,
+                       std::vector<std::pair<Limb, StepCommand>> & stepCommandList) -> bool {
+    if(ctl.limbManagerSet_->contactCommandStacked())
+    {
+      mc_rtc::log::error("[GuiWalkState] Ignore the walk command because it is available only when the contact "
+                         "command is not stacked in LimbManagerSet.");
+      return false;
+    }
+
+    const sva::PTransformd & initialFootMidpose = projGround(sva::interpolate(
+        ctl.limbTasks_.at(leftFoot)->targetPose(), ctl.limbTasks_.at(rightFoot)->targetPose(), 0.5));
+
+    // The step commands of the walk command are allocated from the arena, which is released when they are all
+    // finished
+    auto arena = std::make_shared<CommandArena>();
+    for(const auto & footstep : footstepList)
+    {
+      stepCommandList.emplace_back(footstep.foot,
+                                   makeStepCommand(footstep.foot, footstep.pose * initialFootMidpose,
+                                                   ctl.t() + footstep.startTime, ctl.t() + footstep.endTime, arena));
+    }
+    return true;
+  };
+  if(!ctl().limbManagerSet_->pushStepCommands(std::move(generator)))
+  {
+    mc_rtc::log::error("[GuiWalkState] Failed to push the step commands because the queue is full.");
+    return false;
+  }
+
   return true;
 }
 
@@ -132,20 +174,18 @@ Eigen::Vector3d GuiWalkState::clampDeltaTrans(const Eigen::Vector3d & deltaTrans
 }
 
 StepCommand GuiWalkState::makeStepCommand(const Limb & foot,
-                                          const sva::PTransformd & footMidpose,
-                                          double startTime) const
+                                          const sva::PTransformd & footPose,
+                                          double startTime,
+                                          double endTime,
+                                          const std::shared_ptr<CommandArena> & arena)
 {
-  mc_rtc::Configuration stepCommandConfig;
-  stepCommandConfig.add("limb", std::to_string(foot));
-  stepCommandConfig.add("type", "Add");
-  stepCommandConfig.add("startTime", startTime);
-  stepCommandConfig.add("endTime", startTime + (1.0 - doubleSupportRatio_) * footstepDuration_);
-  stepCommandConfig.add("pose", midToFootTranss_.at(foot) * footMidpose);
   mc_rtc::Configuration constraintConfig;
   constraintConfig.add("type", "Surface");
   constraintConfig.add("fricCoeff", 0.5);
-  stepCommandConfig.add("constraint", constraintConfig);
-  return StepCommand(stepCommandConfig);
+  return StepCommandBuilder(std::to_string(foot), footPose)
+      .arena(arena)
+      .simple(SwingCommand::Type::Add, startTime, endTime, constraintConfig)
+      .build();
 }
 
 EXPORT_SINGLE_STATE("MCC::GuiWalk", GuiWalkState)
@@ -7,6 +7,7 @@
 #include <MultiContactController/LimbManagerSet.h>
 #include <MultiContactController/MultiContactController.h>
 #include <MultiContactController/PostureManager.h>
+#include <MultiContactController/StageTimer.h>
 #include <MultiContactController/states/InitialState.h>
 
 using namespace MCC;
@@ -133,6 +134,8 @@ bool InitialState::run(mc_control::fsm::Controller &)
     ctl().limbManagerSet_->addToGUI(*ctl().gui());
     ctl().centroidalManager_->addToGUI(*ctl().gui());
     ctl().postureManager_->addToGUI(*ctl().gui());
+    ctl().overrunWatchdog_->addToGUI(*ctl().gui(), {ctl().name(), "OverrunWatchdog"});
+    ctl().stageTimer_->addToGUI(*ctl().gui(), {ctl().name(), "StageTimer"});
   }
   else if(phase_ == 2)
   {
@@ -144,6 +147,8 @@ bool InitialState::run(mc_control::fsm::Controller &)
     ctl().limbManagerSet_->addToLogger(ctl().logger());
     ctl().centroidalManager_->addToLogger(ctl().logger());
     ctl().postureManager_->addToLogger(ctl().logger());
+    ctl().overrunWatchdog_->addToLogger(ctl().logger(), "OverrunWatchdog");
+    ctl().stageTimer_->addToLogger(ctl().logger(), "StageTimer");
   }
 
   // Interpolate task stiffness
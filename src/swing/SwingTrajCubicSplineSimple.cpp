@@ -1,8 +1,8 @@
+#include <algorithm>
+
 #include <mc_rtc/gui/ArrayInput.h>
 #include <mc_rtc/gui/NumberInput.h>
 
-#include <TrajColl/CubicSpline.h>
-
 #include <MultiContactController/swing/SwingTrajCubicSplineSimple.h>
 
 using namespace MCC;
@@ -42,7 +42,10 @@ void SwingTrajCubicSplineSimple::addConfigToGUI(mc_rtc::gui::StateBuilder & gui,
           [](const Eigen::Vector3d & v) { defaultConfig_.approachOffset = v; }),
       mc_rtc::gui::ArrayInput(
           "swingOffset", {"x", "y", "z"}, []() -> const Eigen::Vector3d & { return defaultConfig_.swingOffset; },
-          [](const Eigen::Vector3d & v) { defaultConfig_.swingOffset = v; }));
+          [](const Eigen::Vector3d & v) { defaultConfig_.swingOffset = v; }),
+      mc_rtc::gui::NumberInput(
+          "lookupTableStep", []() { return defaultConfig_.lookupTableStep; },
+          [](double v) { defaultConfig_.lookupTableStep = v; }));
 }
 
 void SwingTrajCubicSplineSimple::removeConfigFromGUI(mc_rtc::gui::StateBuilder & gui,
@@ -51,6 +54,42 @@ void SwingTrajCubicSplineSimple::removeConfigFromGUI(mc_rtc::gui::StateBuilder &
   gui.removeCategory(category);
 }
 
+std::shared_ptr<const SwingTrajCubicSplineSimple::Preparation> SwingTrajCubicSplineSimple::prepare(
+    const SwingCommand::Type & commandType,
+    const sva::PTransformd & endPose,
+    double startTime,
+    double endTime,
+    const Configuration & baseConfig,
+    const mc_rtc::Configuration & mcRtcConfig)
+{
+  auto preparation = std::make_shared<Preparation>();
+  preparation->config = baseConfig;
+  preparation->config.load(mcRtcConfig);
+  preparation->endPose = endPose;
+  preparation->startTime = startTime;
+  preparation->endTime = endTime;
+
+  if(commandType == SwingCommand::Type::Add)
+  {
+    double approachDuration = preparation->config.approachDurationRatio * (endTime - startTime);
+
+    TrajColl::BoundaryConstraint<Eigen::Vector3d> zeroVelBC(TrajColl::BoundaryConstraintType::Velocity,
+                                                            Eigen::Vector3d::Zero());
+    TrajColl::BoundaryConstraint<Eigen::Vector3d> zeroAccelBC(TrajColl::BoundaryConstraintType::Acceleration,
+                                                              Eigen::Vector3d::Zero());
+
+    // Spline to approach limb
+    preparation->approachPosWaypoints = {
+        {endTime - approachDuration, (sva::PTransformd(preparation->config.approachOffset) * endPose).translation()},
+        {endTime, endPose.translation()}};
+    preparation->approachPosSpline = std::make_shared<TrajColl::CubicSpline<Eigen::Vector3d>>(
+        3, zeroAccelBC, zeroVelBC, preparation->approachPosWaypoints);
+    preparation->approachPosSpline->calcCoeff();
+  }
+
+  return preparation;
+}
+
 SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type & commandType,
                                                        bool isContact,
                                                        const sva::PTransformd & startPose,
@@ -59,11 +98,37 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
                                                        double endTime,
                                                        const TaskGain & taskGain,
                                                        const mc_rtc::Configuration & mcRtcConfig)
-: SwingTraj(commandType, isContact, startPose, endPose, startTime, endTime, taskGain, mcRtcConfig),
-  posFunc_(std::make_shared<TrajColl::PiecewiseFunc<Eigen::Vector3d>>()),
+: SwingTrajCubicSplineSimple(commandType,
+                             isContact,
+                             startPose,
+                             endPose,
+                             startTime,
+                             endTime,
+                             taskGain,
+                             prepare(commandType, endPose, startTime, endTime, defaultConfig_, mcRtcConfig))
+{
+}
+
+SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type & commandType,
+                                                       bool isContact,
+                                                       const sva::PTransformd & startPose,
+                                                       const sva::PTransformd & endPose,
+                                                       double startTime,
+                                                       double endTime,
+                                                       const TaskGain & taskGain,
+                                                       const std::shared_ptr<const Preparation> & preparation)
+: SwingTraj(commandType, isContact, startPose, endPose, startTime, endTime, taskGain),
   rotFunc_(std::make_shared<TrajColl::CubicInterpolator<Eigen::Matrix3d, Eigen::Vector3d>>())
 {
-  config_.load(mcRtcConfig);
+  // Prepare again if the end pose or times differ from those assumed in the preparation
+  std::shared_ptr<const Preparation> prep = preparation;
+  if(!(prep->endPose.rotation() == endPose_.rotation() && prep->endPose.translation() == endPose_.translation()
+       && prep->startTime == startTime_ && prep->endTime == endTime_)
+     || (commandType_ == SwingCommand::Type::Add && !prep->approachPosSpline))
+  {
+    prep = prepare(commandType_, endPose_, startTime_, endTime_, preparation->config);
+  }
+  config_ = prep->config;
 
   double withdrawDuration = config_.withdrawDurationRatio * (endTime_ - startTime_);
   double approachDuration = config_.approachDurationRatio * (endTime_ - startTime_);
@@ -87,7 +152,7 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
       withdrawPosSpline =
           std::make_shared<TrajColl::CubicSpline<Eigen::Vector3d>>(3, zeroVelBC, zeroAccelBC, withdrawPosWaypoints);
       withdrawPosSpline->calcCoeff();
-      posFunc_->appendFunc(startTime_ + withdrawDuration, withdrawPosSpline);
+      addPosFunc(startTime_ + withdrawDuration, withdrawPosSpline);
     }
     // Rot
     rotFunc_->appendPoint(std::make_pair(startTime_, startPose_.rotation().transpose()));
@@ -96,15 +161,11 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
       rotFunc_->appendPoint(std::make_pair(startTime_ + withdrawDuration, startPose_.rotation().transpose()));
     }
 
-    // Spline to approach limb
+    // Spline to approach limb (prepared in advance)
     // Pos
-    std::map<double, Eigen::Vector3d> approachPosWaypoints = {
-        {endTime_ - approachDuration, (sva::PTransformd(config_.approachOffset) * endPose_).translation()},
-        {endTime_, endPose_.translation()}};
-    auto approachPosSpline =
-        std::make_shared<TrajColl::CubicSpline<Eigen::Vector3d>>(3, zeroAccelBC, zeroVelBC, approachPosWaypoints);
-    approachPosSpline->calcCoeff();
-    posFunc_->appendFunc(endTime_, approachPosSpline);
+    const auto & approachPosWaypoints = prep->approachPosWaypoints;
+    const auto & approachPosSpline = prep->approachPosSpline;
+    addPosFunc(endTime_, approachPosSpline);
     // Rot
     rotFunc_->appendPoint(std::make_pair(endTime_ - approachDuration, endPose_.rotation().transpose()));
     rotFunc_->appendPoint(std::make_pair(endTime_, endPose_.rotation().transpose()));
@@ -140,7 +201,7 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
           swingPosWaypoints);
     }
     swingPosSpline->calcCoeff();
-    posFunc_->appendFunc(endTime_ - approachDuration, swingPosSpline);
+    addPosFunc(endTime_ - approachDuration, swingPosSpline);
     // Rot
     rotFunc_->calcCoeff();
   }
@@ -154,7 +215,7 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
     std::shared_ptr<TrajColl::CubicSpline<Eigen::Vector3d>> withdrawPosSpline =
         std::make_shared<TrajColl::CubicSpline<Eigen::Vector3d>>(3, zeroVelBC, zeroVelBC, withdrawPosWaypoints);
     withdrawPosSpline->calcCoeff();
-    posFunc_->appendFunc(startTime_ + withdrawDuration, withdrawPosSpline);
+    addPosFunc(startTime_ + withdrawDuration, withdrawPosSpline);
     // Rot
     rotFunc_->appendPoint(std::make_pair(startTime_, startPose_.rotation().transpose()));
     rotFunc_->appendPoint(std::make_pair(endTime_, startPose_.rotation().transpose()));
@@ -162,8 +223,7 @@ SwingTrajCubicSplineSimple::SwingTrajCubicSplineSimple(const SwingCommand::Type
 
     // Constant to stay limb
     // Pos
-    posFunc_->appendFunc(endTime_,
-                         std::make_shared<TrajColl::Constant<Eigen::Vector3d>>(withdrawPosWaypoints.rbegin()->second));
+    addPosFunc(endTime_, std::make_shared<TrajColl::Constant<Eigen::Vector3d>>(withdrawPosWaypoints.rbegin()->second));
 
     // Stiffness interpolation
     stiffnessRatioFunc_ = std::make_shared<TrajColl::CubicInterpolator<double>>(
@@ -180,7 +240,7 @@ sva::PTransformd SwingTrajCubicSplineSimple::pose(double t) const
   {
     t = touchDownTime_;
   }
-  return sva::PTransformd((*rotFunc_)(t).transpose(), (*posFunc_)(t));
+  return sva::PTransformd((*rotFunc_)(t).transpose(), posFunc(t)(t));
 }
 
 sva::MotionVecd SwingTrajCubicSplineSimple::vel(double t) const
@@ -191,7 +251,7 @@ sva::MotionVecd SwingTrajCubicSplineSimple::vel(double t) const
   }
   else
   {
-    return sva::MotionVecd(rotFunc_->derivative(t, 1), posFunc_->derivative(t, 1));
+    return sva::MotionVecd(rotFunc_->derivative(t, 1), posFunc(t).derivative(t, 1));
   }
 }
 
@@ -203,7 +263,7 @@ sva::MotionVecd SwingTrajCubicSplineSimple::accel(double t) const
   }
   else
   {
-    return sva::MotionVecd(rotFunc_->derivative(t, 2), posFunc_->derivative(t, 2));
+    return sva::MotionVecd(rotFunc_->derivative(t, 2), posFunc(t).derivative(t, 2));
   }
 }
 
@@ -218,3 +278,48 @@ TaskGain SwingTrajCubicSplineSimple::taskGain(double t) const
     return TaskGain((*stiffnessRatioFunc_)(t)*taskGain_.stiffness);
   }
 }
+
+void SwingTrajCubicSplineSimple::calcSample(double t, Sample & sample) const
+{
+  sample.t = t;
+  sample.taskGain = taskGain(t);
+  if(touchDownTime_ > 0 && t >= touchDownTime_)
+  {
+    sample.pose = pose(t);
+    sample.vel = sva::MotionVecd::Zero();
+    sample.accel = sva::MotionVecd::Zero();
+    return;
+  }
+
+  const auto & func = posFunc(t);
+  sample.pose = sva::PTransformd((*rotFunc_)(t).transpose(), func(t));
+  sample.vel = sva::MotionVecd(rotFunc_->derivative(t, 1), func.derivative(t, 1));
+  sample.accel = sva::MotionVecd(rotFunc_->derivative(t, 2), func.derivative(t, 2));
+}
+
+void SwingTrajCubicSplineSimple::addPosFunc(double endTime,
+                                            const std::shared_ptr<TrajColl::Func<Eigen::Vector3d>> & func)
+{
+  auto it = std::upper_bound(posFuncList_.begin(), posFuncList_.end(), endTime,
+                             [](double _endTime, const auto & element) { return _endTime < element.first; });
+  posFuncList_.emplace(it, endTime, func);
+  posFuncIdx_ = 0;
+}
+
+const TrajColl::Func<Eigen::Vector3d> & SwingTrajCubicSplineSimple::posFunc(double t) const
+{
+  // Search the first function whose end time is not earlier than the specified time (the last one if none)
+  if(posFuncIdx_ >= posFuncList_.size())
+  {
+    posFuncIdx_ = 0;
+  }
+  while(posFuncIdx_ > 0 && t <= posFuncList_[posFuncIdx_ - 1].first)
+  {
+    posFuncIdx_--;
+  }
+  while(posFuncIdx_ + 1 < posFuncList_.size() && posFuncList_[posFuncIdx_].first < t)
+  {
+    posFuncIdx_++;
+  }
+  return *posFuncList_[posFuncIdx_].second;
+}
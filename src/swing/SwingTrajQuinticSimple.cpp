@@ -0,0 +1,362 @@
+#include <algorithm>
+
+#include <mc_rtc/gui/ArrayInput.h>
+#include <mc_rtc/gui/NumberInput.h>
+
+#include <MultiContactController/swing/SwingTrajQuinticSimple.h>
+
+using namespace MCC;
+
+void SwingTrajQuinticSimple::Configuration::load(const mc_rtc::Configuration & mcRtcConfig)
+{
+  SwingTraj::Configuration::load(mcRtcConfig);
+
+  mcRtcConfig("withdrawDurationRatio", withdrawDurationRatio);
+  mcRtcConfig("withdrawOffset", withdrawOffset);
+  mcRtcConfig("approachDurationRatio", approachDurationRatio);
+  mcRtcConfig("approachOffset", approachOffset);
+  mcRtcConfig("swingOffset", swingOffset);
+}
+
+void SwingTrajQuinticSimple::loadDefaultConfig(const mc_rtc::Configuration & mcRtcConfig)
+{
+  defaultConfig_.load(mcRtcConfig);
+}
+
+void SwingTrajQuinticSimple::addConfigToGUI(mc_rtc::gui::StateBuilder & gui, const std::vector<std::string> & category)
+{
+  gui.addElement(
+      category,
+      mc_rtc::gui::NumberInput(
+          "withdrawDurationRatio", []() { return defaultConfig_.withdrawDurationRatio; },
+          [](double v) { defaultConfig_.withdrawDurationRatio = v; }),
+      mc_rtc::gui::ArrayInput(
+          "withdrawOffset", {"x", "y", "z"}, []() -> const Eigen::Vector3d & { return defaultConfig_.withdrawOffset; },
+          [](const Eigen::Vector3d & v) { defaultConfig_.withdrawOffset = v; }),
+      mc_rtc::gui::NumberInput(
+          "approachDurationRatio", []() { return defaultConfig_.approachDurationRatio; },
+          [](double v) { defaultConfig_.approachDurationRatio = v; }),
+      mc_rtc::gui::ArrayInput(
+          "approachOffset", {"x", "y", "z"}, []() -> const Eigen::Vector3d & { return defaultConfig_.approachOffset; },
+          [](const Eigen::Vector3d & v) { defaultConfig_.approachOffset = v; }),
+      mc_rtc::gui::ArrayInput(
+          "swingOffset", {"x", "y", "z"}, []() -> const Eigen::Vector3d & { return defaultConfig_.swingOffset; },
+          [](const Eigen::Vector3d & v) { defaultConfig_.swingOffset = v; }),
+      mc_rtc::gui::NumberInput(
+          "lookupTableStep", []() { return defaultConfig_.lookupTableStep; },
+          [](double v) { defaultConfig_.lookupTableStep = v; }));
+}
+
+void SwingTrajQuinticSimple::removeConfigFromGUI(mc_rtc::gui::StateBuilder & gui,
+                                                 const std::vector<std::string> & category)
+{
+  gui.removeCategory(category);
+}
+
+std::shared_ptr<const SwingTrajQuinticSimple::Preparation> SwingTrajQuinticSimple::prepare(
+    const Configuration & baseConfig,
+    const mc_rtc::Configuration & mcRtcConfig)
+{
+  auto preparation = std::make_shared<Preparation>();
+  preparation->config = baseConfig;
+  preparation->config.load(mcRtcConfig);
+  return preparation;
+}
+
+void SwingTrajQuinticSimple::QuinticSegment::set(double _startTime,
+                                                 double _endTime,
+                                                 const Eigen::Vector3d & startPos,
+                                                 const Eigen::Vector3d & startVel,
+                                                 const Eigen::Vector3d & startAccel,
+                                                 const Eigen::Vector3d & endPos,
+                                                 const Eigen::Vector3d & endVel,
+                                                 const Eigen::Vector3d & endAccel)
+{
+  startTime = _startTime;
+  endTime = _endTime;
+
+  coeff.setZero();
+  double duration = endTime - startTime;
+  if(duration <= 0)
+  {
+    coeff.col(0) = endPos;
+    return;
+  }
+
+  // Boundary conditions with respect to the normalized time in [0, 1]
+  Eigen::Vector3d posDiff = endPos - startPos;
+  Eigen::Vector3d v0 = duration * startVel;
+  Eigen::Vector3d v1 = duration * endVel;
+  Eigen::Vector3d a0 = duration * duration * startAccel;
+  Eigen::Vector3d a1 = duration * duration * endAccel;
+
+  coeff.col(0) = startPos;
+  coeff.col(1) = v0;
+  coeff.col(2) = 0.5 * a0;
+  coeff.col(3) = 10 * posDiff - 6 * v0 - 4 * v1 - 0.5 * (3 * a0 - a1);
+  coeff.col(4) = -15 * posDiff + 8 * v0 + 7 * v1 + 0.5 * (3 * a0 - 2 * a1);
+  coeff.col(5) = 6 * posDiff - 3 * v0 - 3 * v1 - 0.5 * (a0 - a1);
+}
+
+Eigen::Vector3d SwingTrajQuinticSimple::QuinticSegment::derivative(double t, int order) const
+{
+  double duration = endTime - startTime;
+  if(duration <= 0 || t < startTime || t > endTime)
+  {
+    if(order > 0)
+    {
+      return Eigen::Vector3d::Zero();
+    }
+    return t < startTime ? coeff.col(0) : Eigen::Vector3d(coeff.rowwise().sum());
+  }
+
+  // Evaluate the polynomial by Horner's method
+  double tau = (t - startTime) / duration;
+  Eigen::Vector3d ret = Eigen::Vector3d::Zero();
+  if(order == 0)
+  {
+    for(int i = 5; i >= 0; i--)
+    {
+      ret = ret * tau + coeff.col(i);
+    }
+  }
+  else if(order == 1)
+  {
+    for(int i = 5; i >= 1; i--)
+    {
+      ret = ret * tau + i * coeff.col(i);
+    }
+    ret /= duration;
+  }
+  else if(order == 2)
+  {
+    for(int i = 5; i >= 2; i--)
+    {
+      ret = ret * tau + i * (i - 1) * coeff.col(i);
+    }
+    ret /= duration * duration;
+  }
+  return ret;
+}
+
+SwingTrajQuinticSimple::SwingTrajQuinticSimple(const SwingCommand::Type & commandType,
+                                               bool isContact,
+                                               const sva::PTransformd & startPose,
+                                               const sva::PTransformd & endPose,
+                                               double startTime,
+                                               double endTime,
+                                               const TaskGain & taskGain,
+                                               const mc_rtc::Configuration & mcRtcConfig)
+: SwingTrajQuinticSimple(commandType,
+                         isContact,
+                         startPose,
+                         endPose,
+                         startTime,
+                         endTime,
+                         taskGain,
+                         prepare(defaultConfig_, mcRtcConfig))
+{
+}
+
+SwingTrajQuinticSimple::SwingTrajQuinticSimple(const SwingCommand::Type & commandType,
+                                               bool isContact,
+                                               const sva::PTransformd & startPose,
+                                               const sva::PTransformd & endPose,
+                                               double startTime,
+                                               double endTime,
+                                               const TaskGain & taskGain,
+                                               const std::shared_ptr<const Preparation> & preparation)
+: SwingTraj(commandType, isContact, startPose, endPose, startTime, endTime, taskGain), config_(preparation->config)
+{
+  double withdrawDuration = config_.withdrawDurationRatio * (endTime_ - startTime_);
+  double approachDuration = config_.approachDurationRatio * (endTime_ - startTime_);
+
+  // Set waypoints of position
+  std::array<double, 5> waypointTimes;
+  std::array<Eigen::Vector3d, 5> waypointPositions;
+  int waypointNum = 0;
+  auto appendWaypoint = [&](double t, const Eigen::Vector3d & pos) {
+    // Overwrite the last waypoint if the time is not later than it
+    if(waypointNum == 0 || t > waypointTimes[waypointNum - 1])
+    {
+      waypointNum++;
+    }
+    waypointTimes[waypointNum - 1] = t;
+    waypointPositions[waypointNum - 1] = pos;
+  };
+  appendWaypoint(startTime_, startPose_.translation());
+  if(commandType_ == SwingCommand::Type::Add)
+  {
+    if(isContact_)
+    {
+      appendWaypoint(startTime_ + withdrawDuration,
+                     (sva::PTransformd(config_.withdrawOffset) * startPose_).translation());
+      appendWaypoint(
+          0.5 * (startTime_ + endTime_),
+          (sva::PTransformd(config_.swingOffset) * sva::interpolate(startPose_, endPose_, 0.5)).translation());
+    }
+    appendWaypoint(endTime_ - approachDuration, (sva::PTransformd(config_.approachOffset) * endPose_).translation());
+    appendWaypoint(endTime_, endPose_.translation());
+  }
+  else // if(commandType_ == SwingCommand::Type::Remove)
+  {
+    // The limb stays at the withdraw position after the last segment
+    appendWaypoint(startTime_ + withdrawDuration,
+                   (sva::PTransformd(config_.withdrawOffset) * startPose_).translation());
+  }
+
+  // Set position segments
+  // The velocity at each intermediate waypoint is the central difference, and the acceleration is zero
+  auto waypointVel = [&](int i) -> Eigen::Vector3d {
+    if(i == 0 || i == waypointNum - 1)
+    {
+      return Eigen::Vector3d::Zero();
+    }
+    return (waypointPositions[i + 1] - waypointPositions[i - 1]) / (waypointTimes[i + 1] - waypointTimes[i - 1]);
+  };
+  if(waypointNum == 1)
+  {
+    posSegments_[0].set(waypointTimes[0], waypointTimes[0], waypointPositions[0], Eigen::Vector3d::Zero(),
+                        Eigen::Vector3d::Zero(), waypointPositions[0], Eigen::Vector3d::Zero(),
+                        Eigen::Vector3d::Zero());
+    posSegmentNum_ = 1;
+  }
+  else
+  {
+    Eigen::Vector3d startVel = waypointVel(0);
+    for(int i = 0; i < waypointNum - 1; i++)
+    {
+      Eigen::Vector3d endVel = waypointVel(i + 1);
+      posSegments_[i].set(waypointTimes[i], waypointTimes[i + 1], waypointPositions[i], startVel,
+                          Eigen::Vector3d::Zero(), waypointPositions[i + 1], endVel, Eigen::Vector3d::Zero());
+      startVel = endVel;
+    }
+    posSegmentNum_ = waypointNum - 1;
+  }
+
+  // Set rotation interpolation
+  rotStart_ = startPose_.rotation().transpose();
+  if(commandType_ == SwingCommand::Type::Add)
+  {
+    Eigen::AngleAxisd rotDiff(rotStart_.transpose() * endPose_.rotation().transpose());
+    rotAxis_ = rotDiff.axis();
+    rotAngle_ = rotDiff.angle();
+    rotStartTime_ = isContact_ ? startTime_ + withdrawDuration : startTime_;
+    rotEndTime_ = endTime_ - approachDuration;
+  }
+  else // if(commandType_ == SwingCommand::Type::Remove)
+  {
+    rotAngle_ = 0;
+    rotStartTime_ = startTime_;
+    rotEndTime_ = endTime_;
+
+    // Set stiffness transition
+    stiffnessStartTime_ = startTime_ + withdrawDuration;
+    stiffnessEndTime_ = 0.5 * ((startTime_ + withdrawDuration) + endTime_);
+  }
+}
+
+sva::PTransformd SwingTrajQuinticSimple::pose(double t) const
+{
+  if(touchDownTime_ > 0 && t >= touchDownTime_)
+  {
+    t = touchDownTime_;
+  }
+  return sva::PTransformd(calcRot(calcTimeScale(t, rotStartTime_, rotEndTime_)).transpose(),
+                          posSegment(t).derivative(t, 0));
+}
+
+sva::MotionVecd SwingTrajQuinticSimple::vel(double t) const
+{
+  if(touchDownTime_ > 0 && t >= touchDownTime_)
+  {
+    return sva::MotionVecd::Zero();
+  }
+  else
+  {
+    TimeScale rotScale = calcTimeScale(t, rotStartTime_, rotEndTime_);
+    return sva::MotionVecd(rotScale.vel * rotAngle_ * rotStart_ * rotAxis_, posSegment(t).derivative(t, 1));
+  }
+}
+
+sva::MotionVecd SwingTrajQuinticSimple::accel(double t) const
+{
+  if(touchDownTime_ > 0 && t >= touchDownTime_)
+  {
+    return sva::MotionVecd::Zero();
+  }
+  else
+  {
+    TimeScale rotScale = calcTimeScale(t, rotStartTime_, rotEndTime_);
+    return sva::MotionVecd(rotScale.accel * rotAngle_ * rotStart_ * rotAxis_, posSegment(t).derivative(t, 2));
+  }
+}
+
+TaskGain SwingTrajQuinticSimple::taskGain(double t) const
+{
+  if(commandType_ == SwingCommand::Type::Add)
+  {
+    return taskGain_;
+  }
+  else // if(commandType_ == SwingCommand::Type::Remove)
+  {
+    return TaskGain((1.0 - calcTimeScale(t, stiffnessStartTime_, stiffnessEndTime_).value) * taskGain_.stiffness);
+  }
+}
+
+void SwingTrajQuinticSimple::calcSample(double t, Sample & sample) const
+{
+  sample.t = t;
+  sample.taskGain = taskGain(t);
+  if(touchDownTime_ > 0 && t >= touchDownTime_)
+  {
+    sample.pose = pose(t);
+    sample.vel = sva::MotionVecd::Zero();
+    sample.accel = sva::MotionVecd::Zero();
+    return;
+  }
+
+  const auto & segment = posSegment(t);
+  TimeScale rotScale = calcTimeScale(t, rotStartTime_, rotEndTime_);
+  Eigen::Vector3d rotDir = rotAngle_ * rotStart_ * rotAxis_;
+  sample.pose = sva::PTransformd(calcRot(rotScale).transpose(), segment.derivative(t, 0));
+  sample.vel = sva::MotionVecd(rotScale.vel * rotDir, segment.derivative(t, 1));
+  sample.accel = sva::MotionVecd(rotScale.accel * rotDir, segment.derivative(t, 2));
+}
+
+SwingTrajQuinticSimple::TimeScale SwingTrajQuinticSimple::calcTimeScale(double t, double startTime, double endTime)
+{
+  double duration = endTime - startTime;
+  if(t <= startTime || duration <= 0)
+  {
+    return TimeScale{t < endTime ? 0.0 : 1.0, 0.0, 0.0};
+  }
+  if(t >= endTime)
+  {
+    return TimeScale{1.0, 0.0, 0.0};
+  }
+
+  double tau = (t - startTime) / duration;
+  double tau2 = tau * tau;
+  double tau3 = tau2 * tau;
+  return TimeScale{tau3 * (10 - 15 * tau + 6 * tau2), 30 * tau2 * (1 - 2 * tau + tau2) / duration,
+                   60 * tau * (1 - 3 * tau + 2 * tau2) / (duration * duration)};
+}
+
+const SwingTrajQuinticSimple::QuinticSegment & SwingTrajQuinticSimple::posSegment(double t) const
+{
+  // Search the first segment whose end time is not earlier than the specified time (the last one if none)
+  for(int i = 0; i < posSegmentNum_ - 1; i++)
+  {
+    if(t <= posSegments_[i].endTime)
+    {
+      return posSegments_[i];
+    }
+  }
+  return posSegments_[posSegmentNum_ - 1];
+}
+
+Eigen::Matrix3d SwingTrajQuinticSimple::calcRot(const TimeScale & scale) const
+{
+  return rotStart_ * Eigen::AngleAxisd(scale.value * rotAngle_, rotAxis_).toRotationMatrix();
+}
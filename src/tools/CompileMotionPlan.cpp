@@ -0,0 +1,45 @@
+#include <iostream>
+
+#include <mc_rtc/Configuration.h>
+
+#include <MultiContactController/MotionPlan.h>
+
+/** \brief Compile the configuration of ConfigMotionState into a motion plan file.
+
+    Usage: CompileMotionPlan <input.yaml> <output.mccplan> [stateName]
+
+    If stateName is specified, the "configs" entry of the state in the "states" entry of the input file (e.g., an FSM
+    configuration such as MotionSampleField.yaml) is compiled. Otherwise, the "configs" entry in the root of the input
+    file is compiled if exists, and the root itself is compiled if not.
+ */
+int main(int argc, char ** argv)
+{
+  if(argc < 3 || argc > 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " <input.yaml> <output.mccplan> [stateName]" << std::endl;
+    return 1;
+  }
+
+  try
+  {
+    mc_rtc::Configuration config(argv[1]);
+    if(argc == 4)
+    {
+      config = config("states")(argv[3]);
+    }
+    if(config.has("configs"))
+    {
+      config = config("configs");
+    }
+
+    size_t recordNum = MCC::MotionPlan::compile(config, argv[2]);
+    std::cout << "Compiled " << recordNum << " records into " << argv[2] << std::endl;
+  }
+  catch(const std::exception & e)
+  {
+    std::cerr << "Failed to compile motion plan: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <MultiContactController/CentroidalManager.h>
+
+/** \brief Centroidal manager whose MPC takes long time and accesses the member of the derived class. */
+class CentroidalManagerSlowMpc : public MCC::CentroidalManager
+{
+public:
+  /** \brief Member that records its destruction. */
+  struct DestructionRecorder
+  {
+    ~DestructionRecorder()
+    {
+      destroyed = true;
+    }
+
+    std::atomic<bool> destroyed = false;
+  };
+
+public:
+  CentroidalManagerSlowMpc(std::atomic<bool> & mpcStarted, std::atomic<bool> & mpcFinishedBeforeDestruction)
+  : MCC::CentroidalManager(nullptr), mpcStarted_(mpcStarted),
+    mpcFinishedBeforeDestruction_(mpcFinishedBeforeDestruction)
+  {
+    config_.enableAsyncMpc = true;
+  }
+
+  ~CentroidalManagerSlowMpc()
+  {
+    stopMpcWorkers();
+  }
+
+  inline virtual const Configuration & config() const override
+  {
+    return config_;
+  }
+
+  void requestMpc()
+  {
+    startMpcWorkers();
+    requestMpcToWorker(mpcWorker_, [](MpcData &) { return true; });
+  }
+
+protected:
+  inline virtual Configuration & config() override
+  {
+    return config_;
+  }
+
+  virtual void runMpc(MpcData & // mpcData
+                      ) override
+  {
+    mpcStarted_ = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    mpcFinishedBeforeDestruction_ = !destructionRecorder_.destroyed;
+  }
+
+  inline virtual double mpcHorizonDt() const override
+  {
+    return 0.1;
+  }
+
+  inline virtual int mpcHorizonSteps() const override
+  {
+    return 10;
+  }
+
+protected:
+  Configuration config_;
+
+  DestructionRecorder destructionRecorder_;
+
+  std::atomic<bool> & mpcStarted_;
+
+  std::atomic<bool> & mpcFinishedBeforeDestruction_;
+};
+
+TEST(TestCentroidalManager, DestroyDuringAsyncMpc)
+{
+  std::atomic<bool> mpcStarted = false;
+  std::atomic<bool> mpcFinishedBeforeDestruction = false;
+
+  auto centroidalManager = std::make_unique<CentroidalManagerSlowMpc>(mpcStarted, mpcFinishedBeforeDestruction);
+  centroidalManager->requestMpc();
+  while(!mpcStarted)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // Destroy the manager while MPC is being solved in the worker thread
+  centroidalManager.reset();
+  EXPECT_TRUE(mpcFinishedBeforeDestruction);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <MultiContactController/CommandQueue.h>
+
+TEST(TestCommandQueue, pushAndPop)
+{
+  MCC::CommandQueue<std::vector<int>> queue(3);
+  EXPECT_EQ(queue.capacity(), 4);
+
+  // Pop from empty queue
+  std::vector<int> command;
+  EXPECT_FALSE(queue.pop(command));
+
+  // Push until full
+  for(int i = 0; i < 4; i++)
+  {
+    EXPECT_TRUE(queue.push(std::vector<int>{i, i + 1}));
+  }
+  EXPECT_FALSE(queue.push(std::vector<int>{100}));
+
+  // Pop in the order of pushing
+  for(int i = 0; i < 4; i++)
+  {
+    ASSERT_TRUE(queue.pop(command));
+    EXPECT_EQ(command, (std::vector<int>{i, i + 1}));
+  }
+  EXPECT_FALSE(queue.pop(command));
+
+  // Push and pop again after wrapping around
+  EXPECT_TRUE(queue.push(std::vector<int>{10}));
+  ASSERT_TRUE(queue.pop(command));
+  EXPECT_EQ(command, std::vector<int>{10});
+}
+
+TEST(TestCommandQueue, multipleProducers)
+{
+  constexpr int producerNum = 4;
+  constexpr int commandNum = 10000;
+  MCC::CommandQueue<std::vector<int>> queue(64);
+
+  std::vector<std::thread> producers;
+  for(int producerIdx = 0; producerIdx < producerNum; producerIdx++)
+  {
+    producers.emplace_back([&queue, producerIdx]() {
+      for(int i = 0; i < commandNum; i++)
+      {
+        while(!queue.push(std::vector<int>{producerIdx, i}))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Check that all the commands are popped exactly once and in order for each producer
+  std::vector<int> nextIdxList(producerNum, 0);
+  int poppedNum = 0;
+  std::vector<int> command;
+  while(poppedNum < producerNum * commandNum)
+  {
+    if(!queue.pop(command))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(command.size(), 2);
+    EXPECT_EQ(command[1], nextIdxList[command[0]]);
+    nextIdxList[command[0]]++;
+    poppedNum++;
+  }
+
+  for(auto & producer : producers)
+  {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.pop(command));
+  for(int producerIdx = 0; producerIdx < producerNum; producerIdx++)
+  {
+    EXPECT_EQ(nextIdxList[producerIdx], commandNum);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include <MultiContactController/CommandTimeline.h>
+
+TEST(TestCommandTimeline, Query)
+{
+  double dt = 0.005;
+  MCC::CommandTimeline<int> timeline(dt);
+  EXPECT_TRUE(timeline.empty());
+  EXPECT_TRUE(timeline.upper_bound(0.0) == timeline.end());
+
+  // Accumulate time by floating-point addition as in the controller
+  double t = 0;
+  std::map<double, std::shared_ptr<int>> commandList;
+  for(int i = 0; i < 600; i++)
+  {
+    if(i % 100 == 0)
+    {
+      commandList.emplace(t, std::make_shared<int>(i));
+    }
+    t += dt;
+  }
+  timeline.insert(commandList.begin(), commandList.end());
+  ASSERT_EQ(timeline.size(), 6);
+
+  // Command at the same tick is rejected
+  EXPECT_TRUE(timeline.hasCommandAtTick(1.0 + 1e-6));
+  EXPECT_TRUE(timeline.hasCommandAtTick(1.0 + 0.4 * dt));
+  EXPECT_FALSE(timeline.hasCommandAtTick(1.0 + 0.6 * dt));
+  EXPECT_THROW(timeline.emplace(1.0 + 1e-6, std::make_shared<int>(-1)), std::runtime_error);
+  ASSERT_EQ(timeline.size(), 6);
+  EXPECT_FALSE(timeline.hasCommandAtTick(3.0));
+  timeline.emplace(3.0, std::make_shared<int>(600));
+  EXPECT_EQ(*timeline.rbegin()->second, 600);
+
+  // Check query at monotonically increasing times and at arbitrary times
+  MCC::CommandTimeline<int>::Cursor cursor;
+  auto checkQuery = [&](double queryTime) {
+    auto it = timeline.upper_bound(queryTime);
+    long long queryTick = std::llround(queryTime / dt);
+    int expectedIdx = std::min(static_cast<int>(queryTick / 100) + 1, static_cast<int>(timeline.size()));
+    EXPECT_EQ(std::distance(timeline.begin(), it), expectedIdx) << "queryTime: " << queryTime;
+    EXPECT_TRUE(timeline.upper_bound(queryTime, cursor) == it) << "queryTime: " << queryTime;
+  };
+  t = 0;
+  for(int i = 0; i < 700; i++)
+  {
+    checkQuery(t);
+    t += dt;
+  }
+  for(double queryTime : {2.7, 0.0, 1.495, 1.5, 0.5, 3.5})
+  {
+    checkQuery(queryTime);
+  }
+
+  // Check query of equally spaced times in one sweep
+  {
+    std::vector<MCC::CommandTimeline<int>::const_iterator> itList;
+    timeline.upperBoundSeq(0.3, 0.1, 30, itList, cursor);
+    ASSERT_EQ(itList.size(), 30);
+    for(int i = 0; i < 30; i++)
+    {
+      EXPECT_TRUE(itList[i] == timeline.upper_bound(0.3 + i * 0.1)) << "i: " << i;
+    }
+  }
+
+  // Check erase
+  timeline.erase(timeline.begin(), timeline.upper_bound(0.7));
+  ASSERT_EQ(timeline.size(), 5);
+  EXPECT_EQ(*timeline.begin()->second, 200);
+  EXPECT_TRUE(timeline.upper_bound(0.5) == timeline.begin());
+  timeline.erase(timeline.begin());
+  EXPECT_EQ(*timeline.begin()->second, 300);
+  timeline.clear();
+  EXPECT_TRUE(timeline.empty());
+}
+
+TEST(TestCommandTimeline, Insert)
+{
+  double dt = 0.005;
+  MCC::CommandTimeline<int> timeline(dt);
+  std::map<double, std::shared_ptr<int>> commandList;
+  for(int i : {1, 3, 5})
+  {
+    commandList.emplace(static_cast<double>(i), std::make_shared<int>(i));
+  }
+  timeline.insert(commandList.begin(), commandList.end());
+
+  // Commands are merged into the middle and the end
+  std::vector<std::pair<double, std::shared_ptr<int>>> additionalCommandList = {
+      {4.0, std::make_shared<int>(4)}, {0.0, std::make_shared<int>(0)}, {2.0, std::make_shared<int>(2)},
+      {6.0, std::make_shared<int>(6)}};
+  timeline.insert(additionalCommandList.begin(), additionalCommandList.end());
+  ASSERT_EQ(timeline.size(), 7);
+  int expectedValue = 0;
+  for(const auto & element : timeline)
+  {
+    EXPECT_DOUBLE_EQ(element.first, static_cast<double>(expectedValue));
+    EXPECT_EQ(*element.second, expectedValue);
+    expectedValue++;
+  }
+
+  // None of the commands is added if any of them collides
+  std::vector<std::pair<double, std::shared_ptr<int>>> collidedCommandList = {{7.0, std::make_shared<int>(7)},
+                                                                               {3.0 + 1e-6, std::make_shared<int>(-1)}};
+  EXPECT_THROW(timeline.insert(collidedCommandList.begin(), collidedCommandList.end()), std::runtime_error);
+  collidedCommandList = {{7.0, std::make_shared<int>(7)}, {7.0 + 1e-6, std::make_shared<int>(-1)}};
+  EXPECT_THROW(timeline.insert(collidedCommandList.begin(), collidedCommandList.end()), std::runtime_error);
+  EXPECT_EQ(timeline.size(), 7);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,6 +5,7 @@
 #include <ForceColl/Contact.h>
 
 #include <MultiContactController/CommandTypes.h>
+#include <MultiContactController/ContactConstraintPool.h>
 
 TEST(TestCommandTypes, StepCommandSimpleDescriptionFormat)
 {
@@ -53,6 +54,95 @@ swingConfig: # swingConfig entry is optional
   }
 }
 
+TEST(TestCommandTypes, StepCommandBuilder)
+{
+  // Create command from configuration
+  const std::string stepCommandYamlStr = R"(
+limb: LeftHand
+pose:
+  translation: [0.0, 0.5, 0.8]
+swingCommand:
+  type: Add
+  startTime: 2.0
+  endTime: 3.0
+  config:
+    approachOffset: [0.0, 0.0, 0.1]
+contactCommandList:
+  - time: 2.0
+    constraint: null
+  - time: 4.0
+    constraint:
+      type: Empty
+gripperCommandList:
+  - time: 3.0
+    name: l_gripper
+    config:
+      opening: 0.0
+)";
+  auto stepCommandFromConfig = MCC::StepCommand(mc_rtc::Configuration::fromYAMLData(stepCommandYamlStr));
+
+  // Create command by builder
+  mc_rtc::Configuration swingConfig;
+  swingConfig.add("approachOffset", Eigen::Vector3d(0.0, 0.0, 0.1));
+  mc_rtc::Configuration constraintConfig;
+  constraintConfig.add("type", "Empty");
+  mc_rtc::Configuration gripperConfig;
+  gripperConfig.add("opening", 0.0);
+  auto stepCommand = MCC::StepCommandBuilder("LeftHand", sva::PTransformd(Eigen::Vector3d(0.0, 0.5, 0.8)))
+                         .swing(MCC::SwingCommand::Type::Add, 2.0, 3.0, swingConfig)
+                         .contact(2.0, nullptr)
+                         .contactFromConfig(4.0, constraintConfig)
+                         .gripper(3.0, "l_gripper", gripperConfig)
+                         .build();
+
+  // Check swing command
+  {
+    EXPECT_EQ(stepCommand.swingCommand->type, stepCommandFromConfig.swingCommand->type);
+    EXPECT_DOUBLE_EQ(stepCommand.swingCommand->startTime, stepCommandFromConfig.swingCommand->startTime);
+    EXPECT_DOUBLE_EQ(stepCommand.swingCommand->endTime, stepCommandFromConfig.swingCommand->endTime);
+    EXPECT_LT((stepCommand.swingCommand->pose.translation() - Eigen::Vector3d(0.0, 0.5, 0.8)).norm(), 1e-10);
+    EXPECT_LT(
+        (stepCommand.swingCommand->pose.translation() - stepCommandFromConfig.swingCommand->pose.translation()).norm(),
+        1e-10);
+    Eigen::Vector3d approachOffset = stepCommand.swingCommand->config("approachOffset");
+    Eigen::Vector3d approachOffsetFromConfig = stepCommandFromConfig.swingCommand->config("approachOffset");
+    EXPECT_LT((approachOffset - approachOffsetFromConfig).norm(), 1e-10);
+  }
+
+  // Check contact command
+  {
+    ASSERT_EQ(stepCommand.contactCommandList.size(), 2);
+    ASSERT_EQ(stepCommandFromConfig.contactCommandList.size(), 2);
+    EXPECT_EQ(stepCommand.contactCommandList.at(2.0), nullptr);
+    EXPECT_EQ(stepCommandFromConfig.contactCommandList.at(2.0), nullptr);
+    const auto & contactCommand = stepCommand.contactCommandList.at(4.0);
+    const auto & contactCommandFromConfig = stepCommandFromConfig.contactCommandList.at(4.0);
+    EXPECT_DOUBLE_EQ(contactCommand->time, contactCommandFromConfig->time);
+    EXPECT_EQ(contactCommand->constraint->name_, "LeftHand");
+    EXPECT_EQ(contactCommand->constraint->name_, contactCommandFromConfig->constraint->name_);
+    EXPECT_EQ(contactCommand->constraint->type(), contactCommandFromConfig->constraint->type());
+  }
+
+  // Check gripper command
+  {
+    ASSERT_EQ(stepCommand.gripperCommandList.size(), 1);
+    ASSERT_EQ(stepCommandFromConfig.gripperCommandList.size(), 1);
+    EXPECT_EQ(stepCommand.gripperCommandList.at(3.0)->name, stepCommandFromConfig.gripperCommandList.at(3.0)->name);
+    EXPECT_DOUBLE_EQ(static_cast<double>(stepCommand.gripperCommandList.at(3.0)->config("opening")),
+                     static_cast<double>(stepCommandFromConfig.gripperCommandList.at(3.0)->config("opening")));
+  }
+
+  // Check remove type command in simple description format
+  {
+    auto removeStepCommand =
+        MCC::StepCommandBuilder("LeftHand").simple(MCC::SwingCommand::Type::Remove, 5.0, 6.0).build();
+    EXPECT_EQ(removeStepCommand.swingCommand->type, MCC::SwingCommand::Type::Remove);
+    ASSERT_EQ(removeStepCommand.contactCommandList.size(), 1);
+    EXPECT_EQ(removeStepCommand.contactCommandList.at(5.0), nullptr);
+    EXPECT_EQ(removeStepCommand.gripperCommandList.size(), 0);
+  }
+}
+
 TEST(TestCommandTypes, setBaseTime)
 {
   // Create command
@@ -135,6 +225,79 @@ TEST(TestCommandTypes, setBaseTime)
   }
 }
 
+TEST(TestCommandTypes, ContactConstraintPool)
+{
+  ForceColl::SurfaceContact::loadVerticesMap(mc_rtc::Configuration::fromYAMLData(R"(
+- name: TestFoot
+  vertices: [[-0.1, -0.04, 0.0], [-0.1, 0.04, 0.0], [0.1, 0.04, 0.0], [0.1, -0.04, 0.0]]
+)"));
+  MCC::ContactConstraintPool::clear();
+
+  auto makeConstraintConfig = [](const sva::PTransformd & pose) {
+    mc_rtc::Configuration constraintConfig;
+    constraintConfig.add("type", "Surface");
+    constraintConfig.add("name", "TestFoot");
+    constraintConfig.add("verticesName", "TestFoot");
+    constraintConfig.add("fricCoeff", 0.5);
+    constraintConfig.add("pose", pose);
+    return constraintConfig;
+  };
+
+  // Make constraints from the same template with different poses
+  auto arena = std::make_shared<MCC::CommandArena>();
+  std::vector<sva::PTransformd> poseList = {sva::PTransformd(Eigen::Vector3d(0.2, 0.1, 0.0)),
+                                            sva::PTransformd(sva::RotZ(0.5), Eigen::Vector3d(0.4, -0.1, 0.1))};
+  std::vector<std::shared_ptr<MCC::ContactConstraint>> constraintList;
+  for(const auto & pose : poseList)
+  {
+    constraintList.push_back(MCC::ContactConstraintPool::make(makeConstraintConfig(pose), arena));
+  }
+  EXPECT_EQ(MCC::ContactConstraintPool::size(), 1);
+  EXPECT_NE(constraintList[0], constraintList[1]);
+
+  // Check that the constraints are the same as those constructed from the configuration
+  for(size_t i = 0; i < poseList.size(); i++)
+  {
+    auto expectedConstraint = MCC::ContactConstraint::makeSharedFromConfig(makeConstraintConfig(poseList[i]));
+    EXPECT_EQ(constraintList[i]->name_, expectedConstraint->name_);
+    EXPECT_EQ(constraintList[i]->type(), expectedConstraint->type());
+    ASSERT_EQ(constraintList[i]->vertexWithRidgeList_.size(), expectedConstraint->vertexWithRidgeList_.size());
+    for(size_t j = 0; j < expectedConstraint->vertexWithRidgeList_.size(); j++)
+    {
+      EXPECT_LT((constraintList[i]->vertexWithRidgeList_[j].vertex - expectedConstraint->vertexWithRidgeList_[j].vertex)
+                    .norm(),
+                1e-10);
+    }
+  }
+
+  // Check that the copy is transformed to the pose without modifying the original constraint
+  {
+    auto copiedConstraint = MCC::ContactConstraintPool::copy(*constraintList[0], poseList[1]);
+    EXPECT_NE(copiedConstraint, constraintList[0]);
+    ASSERT_EQ(copiedConstraint->vertexWithRidgeList_.size(), constraintList[1]->vertexWithRidgeList_.size());
+    for(size_t j = 0; j < copiedConstraint->vertexWithRidgeList_.size(); j++)
+    {
+      EXPECT_LT((copiedConstraint->vertexWithRidgeList_[j].vertex - constraintList[1]->vertexWithRidgeList_[j].vertex)
+                    .norm(),
+                1e-10);
+      EXPECT_GT((copiedConstraint->vertexWithRidgeList_[j].vertex - constraintList[0]->vertexWithRidgeList_[j].vertex)
+                    .norm(),
+                1e-3);
+    }
+  }
+
+  // Check that the empty constraint is shared
+  mc_rtc::Configuration emptyConstraintConfig;
+  emptyConstraintConfig.add("type", "Empty");
+  emptyConstraintConfig.add("name", "TestFoot");
+  EXPECT_EQ(MCC::ContactConstraintPool::make(emptyConstraintConfig),
+            MCC::ContactConstraintPool::make(emptyConstraintConfig));
+
+  // Check that the constraints are valid after the arena is released by the owner
+  arena.reset();
+  EXPECT_EQ(constraintList[1]->name_, "TestFoot");
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,97 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <ForceColl/Contact.h>
+
+#include <MultiContactController/ContactSchedule.h>
+
+std::shared_ptr<MCC::ContactConstraint> makeEmptyConstraint(const std::string & name)
+{
+  mc_rtc::Configuration constraintConfig;
+  constraintConfig.add("type", "Empty");
+  constraintConfig.add("name", name);
+  return MCC::ContactConstraint::makeSharedFromConfig(constraintConfig);
+}
+
+TEST(TestContactSchedule, AppendSegment)
+{
+  MCC::Limb leftFoot("LeftFoot");
+  MCC::Limb rightFoot("RightFoot");
+  auto leftFootConstraint = makeEmptyConstraint("LeftFoot");
+  auto rightFootConstraint = makeEmptyConstraint("RightFoot");
+
+  MCC::ContactSchedule contactSchedule;
+  EXPECT_TRUE(contactSchedule.empty());
+  EXPECT_THROW(contactSchedule.segmentIdx(0.0), std::exception);
+
+  contactSchedule.appendSegment(1.0, {{leftFoot, leftFootConstraint}, {rightFoot, rightFootConstraint}});
+  // Same contact list extends the last segment
+  contactSchedule.appendSegment(1.5, {{leftFoot, leftFootConstraint}, {rightFoot, rightFootConstraint}});
+  contactSchedule.appendSegment(2.0, {{leftFoot, leftFootConstraint}});
+  contactSchedule.appendSegment(3.0, {{leftFoot, leftFootConstraint}, {rightFoot, rightFootConstraint}});
+  EXPECT_THROW(contactSchedule.appendSegment(3.0, {}), std::exception);
+
+  ASSERT_EQ(contactSchedule.segments().size(), 3);
+  EXPECT_DOUBLE_EQ(contactSchedule.segments()[1]->startTime, 2.0);
+
+  // Check query
+  EXPECT_THROW(contactSchedule.segmentIdx(0.9), std::exception);
+  EXPECT_EQ(contactSchedule.segmentIdx(1.0), 0);
+  EXPECT_EQ(contactSchedule.segmentIdx(1.9), 0);
+  EXPECT_EQ(contactSchedule.segmentIdx(2.0), 1);
+  EXPECT_EQ(contactSchedule.segmentIdx(2.5), 1);
+  EXPECT_EQ(contactSchedule.segmentIdx(3.0), 2);
+  EXPECT_EQ(contactSchedule.segmentIdx(100.0), 2);
+
+  // Check precomputed vectors
+  for(const auto & segmentPtr : contactSchedule.segments())
+  {
+    const auto & segment = *segmentPtr;
+    ASSERT_EQ(segment.contactVec.size(), segment.contactList.size());
+    ASSERT_EQ(segment.limbVec.size(), segment.contactList.size());
+    for(size_t i = 0; i < segment.contactVec.size(); i++)
+    {
+      EXPECT_EQ(segment.contactList.at(segment.limbVec[i]), segment.contactVec[i]);
+    }
+  }
+  EXPECT_EQ(contactSchedule.segment(2.5).contactVec.size(), 1);
+  EXPECT_EQ(contactSchedule.segment(2.5).contactVec[0], leftFootConstraint);
+
+  // Check that the copied schedule shares the segments
+  MCC::ContactSchedule copiedContactSchedule = contactSchedule;
+  EXPECT_EQ(copiedContactSchedule.segmentPtr(2.5), contactSchedule.segmentPtr(2.5));
+  contactSchedule.clear();
+  EXPECT_EQ(copiedContactSchedule.segment(2.5).contactVec[0], leftFootConstraint);
+}
+
+TEST(TestContactSchedule, IsSameContactList)
+{
+  MCC::Limb leftFoot("LeftFoot");
+  MCC::Limb rightFoot("RightFoot");
+  auto leftFootConstraint = makeEmptyConstraint("LeftFoot");
+  auto rightFootConstraint = makeEmptyConstraint("RightFoot");
+  auto anotherConstraint = makeEmptyConstraint("RightFoot");
+
+  std::unordered_map<MCC::Limb, std::shared_ptr<MCC::ContactConstraint>> bothContactList = {
+      {leftFoot, leftFootConstraint}, {rightFoot, rightFootConstraint}};
+  std::unordered_map<MCC::Limb, std::shared_ptr<MCC::ContactConstraint>> leftContactList = {
+      {leftFoot, leftFootConstraint}};
+  std::unordered_map<MCC::Limb, std::shared_ptr<MCC::ContactConstraint>> rightContactList = {
+      {rightFoot, rightFootConstraint}};
+  // Different constraint objects are not the same even if they have the same parameters
+  std::unordered_map<MCC::Limb, std::shared_ptr<MCC::ContactConstraint>> anotherRightContactList = {
+      {rightFoot, anotherConstraint}};
+
+  EXPECT_TRUE(MCC::ContactSchedule::isSameContactList({}, {}));
+  EXPECT_TRUE(MCC::ContactSchedule::isSameContactList(bothContactList, bothContactList));
+  EXPECT_FALSE(MCC::ContactSchedule::isSameContactList(leftContactList, bothContactList));
+  EXPECT_FALSE(MCC::ContactSchedule::isSameContactList(leftContactList, rightContactList));
+  EXPECT_FALSE(MCC::ContactSchedule::isSameContactList(rightContactList, anotherRightContactList));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,201 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <mc_rbdyn/RobotLoader.h>
+#include <mc_tasks/FirstOrderImpedanceTask.h>
+
+#include <MultiContactController/LimbManagerSet.h>
+#include <MultiContactController/MultiContactController.h>
+
+/** \brief Controller to update only the limbs without running the FSM and QP. */
+class LimbUpdateController : public MCC::MultiContactController
+{
+public:
+  /** \brief Constructor.
+      \param limbThreadNum number of worker threads to update limbs concurrently (0 for serial update)
+   */
+  LimbUpdateController(int limbThreadNum)
+  : MCC::MultiContactController(mc_rbdyn::RobotLoader::get_robot_module("JVRC1"), 0.005, makeConfig(limbThreadNum))
+  {
+  }
+
+  /** \brief Advance the time and update the limbs. */
+  void updateLimbs()
+  {
+    t_ += dt();
+    limbManagerSet_->update();
+  }
+
+protected:
+  /** \brief Make the controller configuration.
+      \param limbThreadNum number of worker threads to update limbs concurrently
+   */
+  static mc_rtc::Configuration makeConfig(int limbThreadNum)
+  {
+    mc_rtc::Configuration config(MCC_CONFIG_PATH);
+
+    // The FSM is not run in this test
+    config.add("StatesLibraries", std::vector<std::string>{});
+    config.add("states");
+    config.remove("transitions");
+    config.remove("init");
+
+    config("LimbManagerSet")("ThreadPool").add("threadNum", limbThreadNum);
+    return config;
+  }
+};
+
+/** \brief Make a sequence of step commands of walking. */
+std::vector<std::pair<MCC::Limb, MCC::StepCommand>> makeStepCommandList()
+{
+  auto constraintConfig = mc_rtc::Configuration::fromYAMLData(R"(
+type: Surface
+fricCoeff: 0.5
+)");
+
+  std::vector<std::pair<MCC::Limb, MCC::StepCommand>> stepCommandList;
+  double startTime = 1.0;
+  constexpr double stepDuration = 0.8;
+  constexpr double doubleSupportDuration = 0.2;
+  for(int i = 0; i < 4; i++)
+  {
+    bool isLeft = (i % 2 == 0);
+    std::string limbName = isLeft ? "LeftFoot" : "RightFoot";
+    sva::PTransformd pose(Eigen::Vector3d(0.1 * (i + 1), isLeft ? 0.1 : -0.1, 0.0));
+    stepCommandList.emplace_back(MCC::Limb(limbName),
+                                 MCC::StepCommandBuilder(limbName, pose)
+                                     .simple(MCC::SwingCommand::Type::Add, startTime, startTime + stepDuration,
+                                             constraintConfig)
+                                     .build());
+    startTime += stepDuration + doubleSupportDuration;
+  }
+  return stepCommandList;
+}
+
+TEST(TestLimbManagerSet, ParallelUpdate)
+{
+  auto initialContactsConfig = mc_rtc::Configuration::fromYAMLData(R"(
+- limb: LeftFoot
+  type: Surface
+  fricCoeff: 0.5
+- limb: RightFoot
+  type: Surface
+  fricCoeff: 0.5
+)");
+
+  // Update the limbs of the same commands serially and concurrently
+  LimbUpdateController serialCtl(0);
+  LimbUpdateController parallelCtl(1);
+  ASSERT_EQ(serialCtl.limbManagerSet_->threadPool().threadNum(), 0);
+  ASSERT_EQ(parallelCtl.limbManagerSet_->threadPool().threadNum(), 1);
+  for(auto * ctl : {&serialCtl, &parallelCtl})
+  {
+    ctl->limbManagerSet_->reset(initialContactsConfig);
+    ASSERT_TRUE(ctl->limbManagerSet_->appendStepCommands(makeStepCommandList()));
+  }
+
+  // Check that the results are bit-identical in every control cycle
+  constexpr int cycleNum = 1200;
+  for(int i = 0; i < cycleNum; i++)
+  {
+    serialCtl.updateLimbs();
+    parallelCtl.updateLimbs();
+
+    for(const auto & limbManagerKV : *serialCtl.limbManagerSet_)
+    {
+      const auto & serialTask = limbManagerKV.second->limbTask();
+      const auto & parallelTask = parallelCtl.limbManagerSet_->at(limbManagerKV.first)->limbTask();
+      std::string limbStr = std::to_string(limbManagerKV.first);
+
+      EXPECT_TRUE(serialTask->targetPose().rotation() == parallelTask->targetPose().rotation())
+          << "cycle: " << i << ", limb: " << limbStr;
+      EXPECT_TRUE(serialTask->targetPose().translation() == parallelTask->targetPose().translation())
+          << "cycle: " << i << ", limb: " << limbStr;
+      EXPECT_TRUE(serialTask->targetVel().vector() == parallelTask->targetVel().vector())
+          << "cycle: " << i << ", limb: " << limbStr;
+      EXPECT_TRUE(serialTask->targetAccel().vector() == parallelTask->targetAccel().vector())
+          << "cycle: " << i << ", limb: " << limbStr;
+      EXPECT_TRUE(serialTask->dimStiffness() == parallelTask->dimStiffness())
+          << "cycle: " << i << ", limb: " << limbStr;
+      EXPECT_TRUE(serialTask->dimDamping() == parallelTask->dimDamping()) << "cycle: " << i << ", limb: " << limbStr;
+    }
+
+    const auto & serialSnapshot = serialCtl.limbManagerSet_->contactSnapshot();
+    const auto & parallelSnapshot = parallelCtl.limbManagerSet_->contactSnapshot();
+    ASSERT_EQ(serialSnapshot.limbVec.size(), parallelSnapshot.limbVec.size()) << "cycle: " << i;
+    for(size_t j = 0; j < serialSnapshot.limbVec.size(); j++)
+    {
+      EXPECT_EQ(serialSnapshot.limbVec[j].name, parallelSnapshot.limbVec[j].name) << "cycle: " << i;
+    }
+    EXPECT_EQ(serialSnapshot.weightVec, parallelSnapshot.weightVec) << "cycle: " << i;
+    EXPECT_EQ(serialSnapshot.contactVec.size(), parallelSnapshot.contactVec.size()) << "cycle: " << i;
+    EXPECT_EQ(serialCtl.limbManagerSet_->commandChangedTime(), parallelCtl.limbManagerSet_->commandChangedTime())
+        << "cycle: " << i;
+  }
+
+  // Check that all the commands have been processed
+  for(auto * ctl : {&serialCtl, &parallelCtl})
+  {
+    for(const auto & limbManagerKV : *ctl->limbManagerSet_)
+    {
+      EXPECT_TRUE(limbManagerKV.second->swingCommandList().empty());
+    }
+  }
+}
+
+TEST(TestLimbManagerSet, PushStepCommandGenerator)
+{
+  auto initialContactsConfig = mc_rtc::Configuration::fromYAMLData(R"(
+- limb: LeftFoot
+  type: Surface
+  fricCoeff: 0.5
+- limb: RightFoot
+  type: Surface
+  fricCoeff: 0.5
+)");
+
+  LimbUpdateController ctl(0);
+  ctl.limbManagerSet_->reset(initialContactsConfig);
+  ctl.updateLimbs();
+
+  // The generator is called on the next update, so the time is resolved to that of the update
+  const MCC::Limb leftFoot("LeftFoot");
+  double callTime = -1;
+  MCC::LimbManagerSet::StepCommandGenerator generator =
+      [&](const MCC::MultiContactController & controller,
+          std::vector<std::pair<MCC::Limb, MCC::StepCommand>> & stepCommandList) {
+        callTime = controller.t();
+        mc_rtc::Configuration constraintConfig;
+        constraintConfig.add("type", "Surface");
+        constraintConfig.add("fricCoeff", 0.5);
+        sva::PTransformd pose = controller.limbTasks_.at(leftFoot)->targetPose();
+        stepCommandList.emplace_back(
+            leftFoot, MCC::StepCommandBuilder("LeftFoot", pose)
+                          .simple(MCC::SwingCommand::Type::Add, callTime + 1.0, callTime + 2.0, constraintConfig)
+                          .build());
+        return true;
+      };
+  ASSERT_TRUE(ctl.limbManagerSet_->pushStepCommands(std::move(generator)));
+  EXPECT_TRUE(ctl.limbManagerSet_->at(leftFoot)->swingCommandList().empty());
+
+  ctl.updateLimbs();
+  EXPECT_EQ(callTime, ctl.t());
+  const auto & swingCommandList = ctl.limbManagerSet_->at(leftFoot)->swingCommandList();
+  ASSERT_EQ(swingCommandList.size(), 1u);
+  EXPECT_EQ(swingCommandList.begin()->second->startTime, callTime + 1.0);
+
+  // The step commands are discarded if the generator returns false
+  generator = [](const MCC::MultiContactController &, std::vector<std::pair<MCC::Limb, MCC::StepCommand>> &) {
+    return false;
+  };
+  ASSERT_TRUE(ctl.limbManagerSet_->pushStepCommands(std::move(generator)));
+  ctl.updateLimbs();
+  EXPECT_EQ(swingCommandList.size(), 1u);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
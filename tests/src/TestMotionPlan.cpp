@@ -0,0 +1,108 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include <MultiContactController/MotionPlan.h>
+
+TEST(TestMotionPlan, compileAndLoad)
+{
+  // Compile motion plan
+  const std::string configYamlStr = R"(
+stepCommandList:
+  - limb: LeftFoot
+    type: Add
+    startTime: 3.0
+    endTime: 4.0
+    pose:
+      translation: [0.2, 0.1, 0]
+  - limb: LeftHand
+    pose:
+      translation: [0.0, 0.5, 0.8]
+    swingCommand:
+      type: Add
+      startTime: 2.0
+      endTime: 3.0
+    contactCommandList:
+      - time: 1.5
+        constraint: null
+nominalCentroidalPoseList:
+  - time: 3.0
+    pose:
+      translation: [0.1, 0.0, 0.8]
+collisionConfigList:
+  - time: 0.5
+    type: Add
+    r1: RightHand
+    r2: ground
+)";
+  const std::string path = std::string(::testing::TempDir()) + "TestMotionPlan.mccplan";
+  size_t recordNum = MCC::MotionPlan::compile(mc_rtc::Configuration::fromYAMLData(configYamlStr), path);
+  EXPECT_EQ(recordNum, 4);
+
+  // Load motion plan
+  {
+    MCC::MotionPlan motionPlan(path);
+    ASSERT_EQ(motionPlan.size(), 4);
+
+    // Check that records are sorted by time while keeping the order of entries at the same time
+    EXPECT_DOUBLE_EQ(motionPlan.record(0).time, 0.5);
+    EXPECT_EQ(motionPlan.record(0).type, MCC::MotionPlan::RecordType::CollisionConfig);
+    EXPECT_DOUBLE_EQ(motionPlan.record(1).time, 1.5);
+    EXPECT_EQ(motionPlan.record(1).type, MCC::MotionPlan::RecordType::StepCommand);
+    EXPECT_DOUBLE_EQ(motionPlan.record(2).time, 3.0);
+    EXPECT_EQ(motionPlan.record(2).type, MCC::MotionPlan::RecordType::StepCommand);
+    EXPECT_DOUBLE_EQ(motionPlan.record(3).time, 3.0);
+    EXPECT_EQ(motionPlan.record(3).type, MCC::MotionPlan::RecordType::NominalCentroidalPose);
+
+    // Check payloads
+    EXPECT_EQ(motionPlan.payload(0)("r1"), std::string("RightHand"));
+    EXPECT_EQ(motionPlan.payload(1)("limb"), std::string("LeftHand"));
+    EXPECT_DOUBLE_EQ(static_cast<double>(motionPlan.payload(1)("swingCommand")("endTime")), 3.0);
+    EXPECT_EQ(motionPlan.payload(2)("limb"), std::string("LeftFoot"));
+    Eigen::Vector3d translation = motionPlan.payload(3)("pose")("translation");
+    EXPECT_LT((translation - Eigen::Vector3d(0.1, 0.0, 0.8)).norm(), 1e-10);
+  }
+
+  // Check that an invalid file is rejected
+  {
+    std::FILE * file = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fputc('X', file);
+    std::fclose(file);
+    EXPECT_THROW(MCC::MotionPlan motionPlan(path), std::exception);
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(TestMotionPlan, calcStepCommandTime)
+{
+  const std::string simpleYamlStr = R"(
+limb: LeftFoot
+type: Remove
+startTime: 2.0
+endTime: 3.0
+)";
+  EXPECT_DOUBLE_EQ(MCC::MotionPlan::calcStepCommandTime(mc_rtc::Configuration::fromYAMLData(simpleYamlStr)), 2.0);
+
+  const std::string fullYamlStr = R"(
+limb: LeftHand
+contactCommandList:
+  - time: 4.0
+    constraint: null
+gripperCommandList:
+  - time: 3.5
+    name: l_gripper
+    config:
+      opening: 0.0
+)";
+  EXPECT_DOUBLE_EQ(MCC::MotionPlan::calcStepCommandTime(mc_rtc::Configuration::fromYAMLData(fullYamlStr)), 3.5);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
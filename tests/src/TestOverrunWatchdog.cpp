@@ -0,0 +1,120 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <MultiContactController/OverrunWatchdog.h>
+
+namespace
+{
+mc_rtc::Configuration makeWatchdogConfig()
+{
+  mc_rtc::Configuration watchdogConfig;
+  watchdogConfig.add("enabled", true);
+  watchdogConfig.add("windowSize", 10);
+  watchdogConfig.add("overrunNumToDegrade", 3);
+  watchdogConfig.add("headroomRatio", 0.5);
+  watchdogConfig.add("headroomCycleNumToRecover", 20);
+  auto ladderConfig = watchdogConfig.array("degradationLadder");
+  {
+    mc_rtc::Configuration degradationConfig;
+    degradationConfig.add("ddpMaxIter", 1);
+    ladderConfig.push(degradationConfig);
+  }
+  {
+    mc_rtc::Configuration degradationConfig;
+    degradationConfig.add("horizonDt", 0.1);
+    ladderConfig.push(degradationConfig);
+  }
+  {
+    mc_rtc::Configuration degradationConfig;
+    degradationConfig.add("reusePreviousPlan", true);
+    ladderConfig.push(degradationConfig);
+  }
+  return watchdogConfig;
+}
+} // namespace
+
+TEST(TestOverrunWatchdog, MpcDegradation)
+{
+  MCC::CentroidalManager::MpcDegradation degradation;
+  EXPECT_EQ(degradation.degradeDdpMaxIter(5), 5);
+  EXPECT_EQ(degradation.degradeHorizonDt(0.05), 0.05);
+  EXPECT_EQ(degradation.degradeHorizonDuration(2.0), 2.0);
+  EXPECT_EQ(degradation.description(), "None");
+
+  // The degradation never increases the computation time
+  degradation.ddpMaxIter = 10;
+  degradation.horizonDt = 0.01;
+  degradation.horizonDuration = 3.0;
+  EXPECT_EQ(degradation.degradeDdpMaxIter(5), 5);
+  EXPECT_EQ(degradation.degradeHorizonDt(0.05), 0.05);
+  EXPECT_EQ(degradation.degradeHorizonDuration(2.0), 2.0);
+
+  // The stronger degradation is taken by merging
+  MCC::CentroidalManager::MpcDegradation otherDegradation;
+  otherDegradation.ddpMaxIter = 2;
+  otherDegradation.horizonDt = 0.1;
+  otherDegradation.reusePreviousPlan = true;
+  degradation.merge(otherDegradation);
+  EXPECT_EQ(degradation.ddpMaxIter, 2);
+  EXPECT_EQ(degradation.horizonDt, 0.1);
+  EXPECT_EQ(degradation.horizonDuration, 3.0);
+  EXPECT_TRUE(degradation.reusePreviousPlan);
+  EXPECT_FALSE(degradation.hasSameHorizon(otherDegradation));
+}
+
+TEST(TestOverrunWatchdog, update)
+{
+  constexpr double dt = 0.005;
+  MCC::OverrunWatchdog watchdog(makeWatchdogConfig());
+  EXPECT_EQ(watchdog.level(), 0);
+
+  // Sporadic overruns do not degrade MPC
+  for(int i = 0; i < 100; i++)
+  {
+    EXPECT_FALSE(watchdog.update(i % 5 == 0 ? 1.5 * dt : 0.8 * dt, dt));
+  }
+  EXPECT_EQ(watchdog.level(), 0);
+
+  // Sustained overruns degrade MPC step by step, and the degradation is accumulated
+  int changedNum = 0;
+  for(int i = 0; i < 100; i++)
+  {
+    changedNum += watchdog.update(1.5 * dt, dt);
+  }
+  EXPECT_EQ(changedNum, 3);
+  EXPECT_EQ(watchdog.level(), 3);
+  EXPECT_EQ(watchdog.mpcDegradation().ddpMaxIter, 1);
+  EXPECT_EQ(watchdog.mpcDegradation().horizonDt, 0.1);
+  EXPECT_TRUE(watchdog.mpcDegradation().reusePreviousPlan);
+
+  // Cycles without enough headroom do not recover MPC
+  for(int i = 0; i < 100; i++)
+  {
+    EXPECT_FALSE(watchdog.update(0.8 * dt, dt));
+  }
+  EXPECT_EQ(watchdog.level(), 3);
+
+  // Cycles with headroom recover MPC step by step
+  for(int level = 2; level >= 0; level--)
+  {
+    for(int i = 0; i < 19; i++)
+    {
+      EXPECT_FALSE(watchdog.update(0.3 * dt, dt));
+    }
+    EXPECT_TRUE(watchdog.update(0.3 * dt, dt));
+    EXPECT_EQ(watchdog.level(), level);
+  }
+  EXPECT_FALSE(watchdog.mpcDegradation().reusePreviousPlan);
+  EXPECT_EQ(watchdog.mpcDegradation().description(), "None");
+
+  watchdog.update(1.5 * dt, dt);
+  watchdog.reset();
+  EXPECT_EQ(watchdog.level(), 0);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,66 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <sched.h>
+
+#include <MultiContactController/RealTimeProfile.h>
+#include <MultiContactController/TaskQueue.h>
+#include <MultiContactController/ThreadPool.h>
+
+TEST(TestRealTimeProfile, apply)
+{
+  // Only the settings that do not require privileges are applied
+  int cpu = sched_getcpu();
+  ASSERT_GE(cpu, 0);
+  mc_rtc::Configuration realTimeProfileConfig;
+  realTimeProfileConfig.add("enabled", true);
+  realTimeProfileConfig.add("cpuList", std::vector<int>{cpu});
+  realTimeProfileConfig.add("workerCpuList", std::vector<int>{cpu});
+  realTimeProfileConfig.add("schedPolicy", std::string("Other"));
+  realTimeProfileConfig.add("lockMemory", false);
+  realTimeProfileConfig.add("prefaultHeapSize", 1024 * 1024);
+  MCC::RealTimeProfile realTimeProfile(realTimeProfileConfig);
+
+  mc_rtc::Configuration threadPoolConfig;
+  threadPoolConfig.add("threadNum", 2);
+  MCC::ThreadPool threadPool(threadPoolConfig);
+
+  MCC::TaskQueue taskQueue;
+
+  EXPECT_TRUE(realTimeProfile.apply({&threadPool, nullptr}, {taskQueue.nativeHandle()}));
+  EXPECT_EQ(sched_getcpu(), cpu);
+  EXPECT_EQ(taskQueue.submit([]() { return sched_getcpu(); }).get(), cpu);
+
+  // Check that the thread pool still works
+  int count = 0;
+  std::vector<std::function<void()>> tasks = {[&count]() { count++; }, [&count]() { count++; }};
+  threadPool.run(tasks);
+  EXPECT_EQ(count, 2);
+
+  // Check that the threads started after applying the profile can be configured
+  MCC::TaskQueue laterTaskQueue;
+  EXPECT_TRUE(realTimeProfile.applyToWorkerThreads({laterTaskQueue.nativeHandle()}, "later worker thread"));
+  EXPECT_EQ(laterTaskQueue.submit([]() { return sched_getcpu(); }).get(), cpu);
+}
+
+TEST(TestRealTimeProfile, invalidConfig)
+{
+  {
+    mc_rtc::Configuration realTimeProfileConfig;
+    realTimeProfileConfig.add("schedPolicy", std::string("Batch"));
+    EXPECT_THROW(MCC::RealTimeProfile realTimeProfile(realTimeProfileConfig), std::exception);
+  }
+  {
+    mc_rtc::Configuration realTimeProfileConfig;
+    realTimeProfileConfig.add("schedPolicy", std::string("FIFO"));
+    realTimeProfileConfig.add("priority", 1000);
+    EXPECT_THROW(MCC::RealTimeProfile realTimeProfile(realTimeProfileConfig), std::exception);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
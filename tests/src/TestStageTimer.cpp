@@ -0,0 +1,74 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <MultiContactController/StageTimer.h>
+
+TEST(TestStageTimer, LatencyHistogram)
+{
+  MCC::LatencyHistogram histogram(1000);
+  EXPECT_EQ(histogram.percentile(0.5), 0.0);
+
+  // Add 1 ms to 1000 ms
+  for(int i = 1; i <= 1000; i++)
+  {
+    histogram.add(static_cast<double>(i));
+  }
+  EXPECT_EQ(histogram.sampleNum(), 1000);
+  for(double ratio : {0.5, 0.99, 0.999, 1.0})
+  {
+    double expected = ratio * 1000.0;
+    double actual = histogram.percentile(ratio);
+    // The upper bound of the bucket is returned, so the relative error is within the width of the sub-bucket
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected * (1.0 + 1.0 / MCC::LatencyHistogram::subBucketNum) + 1e-10);
+  }
+  EXPECT_EQ(histogram.max(), histogram.percentile(1.0));
+
+  // The oldest samples are removed from the window
+  for(int i = 0; i < 1000; i++)
+  {
+    histogram.add(0.1);
+  }
+  EXPECT_EQ(histogram.sampleNum(), 1000);
+  EXPECT_LE(histogram.max(), 0.1 * (1.0 + 1.0 / MCC::LatencyHistogram::subBucketNum));
+
+  // Out-of-range values are clamped to the first and last buckets
+  histogram.clear();
+  histogram.add(0.0);
+  EXPECT_LE(histogram.max(), 1e-3);
+  histogram.add(1e6);
+  EXPECT_GT(histogram.max(), 1e4);
+}
+
+#ifdef MCC_ENABLE_STAGE_TIMER
+TEST(TestStageTimer, scope)
+{
+  MCC::StageTimer stageTimer;
+  for(int i = 0; i < 3; i++)
+  {
+    {
+      MCC_STAGE_TIMER_SCOPE(stageTimer, Mpc);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    {
+      // The duration of the same stage is accumulated in a cycle
+      MCC_STAGE_TIMER_SCOPE(stageTimer, Mpc);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stageTimer.finishCycle();
+  }
+  EXPECT_GE(stageTimer.lastDuration(MCC::StageTimer::Stage::Mpc), 4.0);
+  EXPECT_EQ(stageTimer.lastDuration(MCC::StageTimer::Stage::WrenchDist), 0.0);
+  EXPECT_EQ(stageTimer.histogram(MCC::StageTimer::Stage::Mpc).sampleNum(), 3);
+  EXPECT_GE(stageTimer.histogram(MCC::StageTimer::Stage::Mpc).percentile(0.5), 4.0);
+}
+#endif
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
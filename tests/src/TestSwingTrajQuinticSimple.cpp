@@ -0,0 +1,152 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+#include <MultiContactController/swing/SwingTrajQuinticSimple.h>
+
+namespace
+{
+constexpr double startTime = 1.0;
+constexpr double endTime = 2.0;
+
+sva::PTransformd startPose()
+{
+  return sva::PTransformd(Eigen::AngleAxisd(0.2, Eigen::Vector3d::UnitZ()).toRotationMatrix(),
+                          Eigen::Vector3d(0.1, -0.2, 0.0));
+}
+
+sva::PTransformd endPose()
+{
+  return sva::PTransformd(Eigen::AngleAxisd(0.8, Eigen::Vector3d::UnitZ()).toRotationMatrix()
+                              * Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitY()).toRotationMatrix(),
+                          Eigen::Vector3d(0.4, 0.1, 0.05));
+}
+
+std::shared_ptr<MCC::SwingTrajQuinticSimple> makeSwingTraj()
+{
+  return std::make_shared<MCC::SwingTrajQuinticSimple>(MCC::SwingCommand::Type::Add, true, startPose(), endPose(),
+                                                       startTime, endTime,
+                                                       MCC::TaskGain(sva::MotionVecd(Eigen::Vector6d::Constant(1000))));
+}
+
+/** \brief Calculate the rotation (represented in world frame) of the pose. */
+Eigen::Matrix3d worldRot(const sva::PTransformd & pose)
+{
+  return pose.rotation().transpose();
+}
+
+/** \brief Calculate the rotation vector (represented in world frame) from rot0 to rot1. */
+Eigen::Vector3d rotDiff(const Eigen::Matrix3d & rot0, const Eigen::Matrix3d & rot1)
+{
+  Eigen::AngleAxisd aa(rot1 * rot0.transpose());
+  return aa.angle() * aa.axis();
+}
+} // namespace
+
+TEST(TestSwingTrajQuinticSimple, BoundaryConditions)
+{
+  auto swingTraj = makeSwingTraj();
+
+  EXPECT_TRUE(swingTraj->pose(startTime).translation().isApprox(startPose().translation(), 1e-10));
+  EXPECT_LT(rotDiff(worldRot(swingTraj->pose(startTime)), worldRot(startPose())).norm(), 1e-10);
+  EXPECT_TRUE(swingTraj->pose(endTime).translation().isApprox(endPose().translation(), 1e-10));
+  EXPECT_LT(rotDiff(worldRot(swingTraj->pose(endTime)), worldRot(endPose())).norm(), 1e-10);
+
+  for(double t : {startTime, endTime})
+  {
+    EXPECT_LT(swingTraj->vel(t).vector().norm(), 1e-10) << "t: " << t;
+    EXPECT_LT(swingTraj->accel(t).vector().norm(), 1e-10) << "t: " << t;
+  }
+
+  // The limb stays at the end pose after the swing
+  EXPECT_TRUE(swingTraj->pose(endTime + 0.5).translation().isApprox(endPose().translation(), 1e-10));
+  EXPECT_LT(swingTraj->vel(endTime + 0.5).vector().norm(), 1e-10);
+}
+
+TEST(TestSwingTrajQuinticSimple, ContinuityAtWaypoints)
+{
+  auto swingTraj = makeSwingTraj();
+
+  // Times of the withdraw, swing, and approach waypoints
+  const auto & config = std::as_const(*swingTraj).config();
+  double duration = endTime - startTime;
+  std::vector<double> waypointTimes = {startTime + config.withdrawDurationRatio * duration,
+                                       0.5 * (startTime + endTime),
+                                       endTime - config.approachDurationRatio * duration};
+
+  constexpr double eps = 1e-9;
+  for(double t : waypointTimes)
+  {
+    EXPECT_LT((swingTraj->pose(t + eps).translation() - swingTraj->pose(t - eps).translation()).norm(), 1e-6)
+        << "t: " << t;
+    EXPECT_LT(rotDiff(worldRot(swingTraj->pose(t - eps)), worldRot(swingTraj->pose(t + eps))).norm(), 1e-6)
+        << "t: " << t;
+    EXPECT_LT((swingTraj->vel(t + eps).vector() - swingTraj->vel(t - eps).vector()).norm(), 1e-6) << "t: " << t;
+    EXPECT_LT((swingTraj->accel(t + eps).vector() - swingTraj->accel(t - eps).vector()).norm(), 1e-6)
+        << "t: " << t;
+  }
+}
+
+TEST(TestSwingTrajQuinticSimple, FiniteDifference)
+{
+  auto swingTraj = makeSwingTraj();
+
+  constexpr double h = 1e-5;
+  for(double t = startTime + 0.01; t < endTime - 0.01; t += 0.0137)
+  {
+    // Linear velocity and acceleration
+    Eigen::Vector3d velFd =
+        (swingTraj->pose(t + h).translation() - swingTraj->pose(t - h).translation()) / (2 * h);
+    EXPECT_LT((velFd - swingTraj->vel(t).linear()).norm(), 1e-6)
+        << "t: " << t << "\nvelFd: " << velFd.transpose() << "\nvel: " << swingTraj->vel(t).linear().transpose();
+    Eigen::Vector3d accelFd = (swingTraj->vel(t + h).linear() - swingTraj->vel(t - h).linear()) / (2 * h);
+    EXPECT_LT((accelFd - swingTraj->accel(t).linear()).norm(), 1e-4)
+        << "t: " << t << "\naccelFd: " << accelFd.transpose()
+        << "\naccel: " << swingTraj->accel(t).linear().transpose();
+
+    // Angular velocity and acceleration (represented in world frame)
+    Eigen::Vector3d angularVelFd =
+        rotDiff(worldRot(swingTraj->pose(t - h)), worldRot(swingTraj->pose(t + h))) / (2 * h);
+    EXPECT_LT((angularVelFd - swingTraj->vel(t).angular()).norm(), 1e-6)
+        << "t: " << t << "\nangularVelFd: " << angularVelFd.transpose()
+        << "\nangularVel: " << swingTraj->vel(t).angular().transpose();
+    Eigen::Vector3d angularAccelFd = (swingTraj->vel(t + h).angular() - swingTraj->vel(t - h).angular()) / (2 * h);
+    EXPECT_LT((angularAccelFd - swingTraj->accel(t).angular()).norm(), 1e-4)
+        << "t: " << t << "\nangularAccelFd: " << angularAccelFd.transpose()
+        << "\nangularAccel: " << swingTraj->accel(t).angular().transpose();
+  }
+}
+
+TEST(TestSwingTrajQuinticSimple, TouchDown)
+{
+  auto swingTraj = makeSwingTraj();
+
+  double touchDownTime = 1.9;
+  sva::PTransformd touchDownPose = swingTraj->pose(touchDownTime);
+  EXPECT_GT(swingTraj->vel(touchDownTime).vector().norm(), 1e-3);
+
+  swingTraj->touchDown(touchDownTime);
+  for(double t : {touchDownTime, touchDownTime + 0.05, endTime, endTime + 0.5})
+  {
+    EXPECT_TRUE(swingTraj->pose(t).translation().isApprox(touchDownPose.translation(), 1e-10)) << "t: " << t;
+    EXPECT_LT(rotDiff(worldRot(swingTraj->pose(t)), worldRot(touchDownPose)).norm(), 1e-10) << "t: " << t;
+    EXPECT_LT(swingTraj->vel(t).vector().norm(), 1e-10) << "t: " << t;
+    EXPECT_LT(swingTraj->accel(t).vector().norm(), 1e-10) << "t: " << t;
+
+    const auto & sample = swingTraj->evaluate(t);
+    EXPECT_TRUE(sample.pose.translation().isApprox(touchDownPose.translation(), 1e-10)) << "t: " << t;
+    EXPECT_LT(sample.vel.vector().norm(), 1e-10) << "t: " << t;
+    EXPECT_LT(sample.accel.vector().norm(), 1e-10) << "t: " << t;
+  }
+
+  // The trajectory before touch down is not changed
+  EXPECT_GT(swingTraj->vel(touchDownTime - 0.05).vector().norm(), 1e-3);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
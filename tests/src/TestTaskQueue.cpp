@@ -0,0 +1,78 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include <MultiContactController/TaskQueue.h>
+
+TEST(TestTaskQueue, submit)
+{
+  MCC::TaskQueue taskQueue;
+
+  // Check that the tasks are run in the order of submission
+  constexpr int taskNum = 100;
+  std::vector<int> orderList;
+  std::vector<std::future<int>> futureList;
+  for(int i = 0; i < taskNum; i++)
+  {
+    futureList.push_back(taskQueue.submit([&orderList, i]() {
+      orderList.push_back(i);
+      return 2 * i;
+    }));
+  }
+  for(int i = 0; i < taskNum; i++)
+  {
+    EXPECT_EQ(futureList[i].get(), 2 * i);
+  }
+  ASSERT_EQ(orderList.size(), taskNum);
+  for(int i = 0; i < taskNum; i++)
+  {
+    EXPECT_EQ(orderList[i], i);
+  }
+
+  // Check that the future can be polled without blocking and becomes ready
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::future<int> future = taskQueue.submit([released]() {
+    released.wait();
+    return 1;
+  });
+  EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+  release.set_value();
+  EXPECT_EQ(future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+  EXPECT_EQ(future.get(), 1);
+
+  // Check that the exception thrown by the task is passed through the future
+  std::future<void> throwingFuture = taskQueue.submit([]() { throw std::runtime_error("error in task"); });
+  EXPECT_THROW(throwingFuture.get(), std::runtime_error);
+
+  // Check that the queue still works after the exception
+  EXPECT_EQ(taskQueue.submit([]() { return 3; }).get(), 3);
+}
+
+TEST(TestTaskQueue, destroyWithPendingTasks)
+{
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::future<void> runningFuture;
+  std::future<void> pendingFuture;
+  {
+    MCC::TaskQueue taskQueue;
+    runningFuture = taskQueue.submit([released]() { released.wait(); });
+    pendingFuture = taskQueue.submit([]() {});
+    release.set_value();
+  }
+
+  // The task being run is waited for, and the tasks not yet started may be discarded
+  EXPECT_EQ(runningFuture.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  EXPECT_EQ(pendingFuture.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
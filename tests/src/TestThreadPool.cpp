@@ -0,0 +1,52 @@
+/* Author: Masaki Murooka */
+
+#include <gtest/gtest.h>
+
+#include <MultiContactController/ThreadPool.h>
+
+TEST(TestThreadPool, run)
+{
+  for(int threadNum : {0, 1, 3})
+  {
+    mc_rtc::Configuration threadPoolConfig;
+    threadPoolConfig.add("threadNum", threadNum);
+    MCC::ThreadPool threadPool(threadPoolConfig);
+    EXPECT_EQ(threadPool.threadNum(), threadNum);
+
+    // Check that each task is run exactly once in each call
+    constexpr int taskNum = 7;
+    constexpr int runNum = 1000;
+    std::vector<int> countList(taskNum, 0);
+    std::vector<std::function<void()>> tasks;
+    for(int i = 0; i < taskNum; i++)
+    {
+      tasks.push_back([&countList, i]() { countList[i]++; });
+    }
+    for(int i = 0; i < runNum; i++)
+    {
+      threadPool.run(tasks);
+    }
+    for(int i = 0; i < taskNum; i++)
+    {
+      EXPECT_EQ(countList[i], runNum);
+    }
+
+    // Check that the stages are run in order
+    int value = 1;
+    int valueInFirstStage = 0;
+    std::vector<std::vector<std::function<void()>>> stages = {
+        {[&]() { valueInFirstStage = value; }, [&]() {}}, {[&]() { value *= 10; }}, {[&]() { value += 2; }, []() {}}};
+    for(const auto & stage : stages)
+    {
+      threadPool.run(stage);
+    }
+    EXPECT_EQ(valueInFirstStage, 1);
+    EXPECT_EQ(value, 12);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}